@@ -0,0 +1,217 @@
+#include "BatchRenderer.h"
+#include "SceneRenderer.h"
+#include "ModelCatalogue.h"
+#include "MaterialPresets.h"
+#include "TriangleMesh.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+
+BatchRenderer::BatchRenderer() :
+    _outputDir("."),
+    _samples(4),
+    _images(0)
+{
+}
+
+BatchRenderer::~BatchRenderer()
+{
+}
+
+void BatchRenderer::printUsage()
+{
+    cout << "Usage: MatlEditor --batch [options]\n"
+         << "  --models <list>     Model names or numbers, default all\n"
+         << "  --materials <list>  Material presets, default all\n"
+         << "  --views <list>      top, bottom, front, back, left, right, iso, dimetric, trimetric; default iso\n"
+         << "  --sizes <list>      Image sizes as WxH, default 512x512\n"
+         << "  --samples <n>       Multisampling, default 4\n"
+         << "  --output <dir>      Directory for the PNG files, default the current one\n"
+         << "Lists are comma separated. Without a display start with -platform offscreen.\n";
+    cout << "Models:";
+    for (int i = 0; i < ModelCatalogue::count(); i++)
+        cout << (i ? ", " : " ") << ModelCatalogue::name(i).toStdString();
+    cout << "\nMaterials:";
+    for (const MaterialPreset& preset : materialPresets())
+        cout << " " << preset.name;
+    cout << endl;
+}
+
+bool BatchRenderer::parseArguments(const QStringList& arguments)
+{
+    for (int i = arguments.indexOf("--batch") + 1; i < arguments.size(); i++)
+    {
+        const QString& option = arguments.at(i);
+        if (option == "--help")
+        {
+            printUsage();
+            return false;
+        }
+        if (i + 1 >= arguments.size())
+        {
+            cout << "Missing value for " << option.toStdString() << endl;
+            return false;
+        }
+        QStringList values = arguments.at(++i).split(',', Qt::SkipEmptyParts);
+
+        if (option == "--models")
+        {
+            for (const QString& value : values)
+            {
+                int model = ModelCatalogue::find(value.trimmed());
+                if (model < 0)
+                {
+                    cout << "Unknown model " << value.toStdString() << endl;
+                    return false;
+                }
+                _models.push_back(model);
+            }
+        }
+        else if (option == "--materials")
+        {
+            for (const QString& value : values)
+            {
+                const MaterialPreset* preset = findMaterialPreset(value.trimmed());
+                if (!preset)
+                {
+                    cout << "Unknown material " << value.toStdString() << endl;
+                    return false;
+                }
+                _presets.push_back(preset);
+            }
+        }
+        else if (option == "--views")
+        {
+            for (const QString& value : values)
+            {
+                View view;
+                view.name = value.trimmed().toLower();
+                if (!OffscreenRenderer::findView(view.name, view.projection))
+                {
+                    cout << "Unknown view " << value.toStdString() << endl;
+                    return false;
+                }
+                _views.push_back(view);
+            }
+        }
+        else if (option == "--sizes")
+        {
+            for (const QString& value : values)
+            {
+                QStringList size = value.trimmed().split('x');
+                int w = size.size() == 2 ? size.at(0).toInt() : 0;
+                int h = size.size() == 2 ? size.at(1).toInt() : 0;
+                if (w <= 0 || h <= 0)
+                {
+                    cout << "Invalid size " << value.toStdString() << endl;
+                    return false;
+                }
+                _sizes.push_back(QSize(w, h));
+            }
+        }
+        else if (option == "--samples")
+        {
+            _samples = qMax(0, values.value(0).toInt());
+        }
+        else if (option == "--output")
+        {
+            _outputDir = arguments.at(i);
+        }
+        else
+        {
+            cout << "Unknown option " << option.toStdString() << endl;
+            printUsage();
+            return false;
+        }
+    }
+
+    if (_models.empty())
+    {
+        for (int i = 0; i < ModelCatalogue::count(); i++)
+            _models.push_back(i);
+    }
+    if (_presets.empty())
+    {
+        for (const MaterialPreset& preset : materialPresets())
+            _presets.push_back(&preset);
+    }
+    if (_views.empty())
+    {
+        View view;
+        view.name = "iso";
+        view.projection = GLCamera::SE_ISOMETRIC_VIEW;
+        _views.push_back(view);
+    }
+    if (_sizes.empty())
+        _sizes.push_back(QSize(512, 512));
+
+    if (!QDir().mkpath(_outputDir))
+    {
+        cout << "Could not create " << _outputDir.toStdString() << endl;
+        return false;
+    }
+    return true;
+}
+
+int BatchRenderer::run()
+{
+    if (!_renderer.create(_samples))
+        return 1;
+
+    QElapsedTimer clock;
+    clock.start();
+
+    for (int model : _models)
+        renderModel(model);
+
+    _renderer.finish();
+
+    double seconds = clock.elapsed() / 1000.0;
+    cout << _images << " images in " << seconds << " s ("
+         << (seconds > 0.0 ? _images / seconds : 0.0) << " per second)";
+    if (_renderer.failedCount())
+        cout << ", " << _renderer.failedCount() << " failed";
+    cout << endl;
+    return _renderer.failedCount() ? 1 : 0;
+}
+
+void BatchRenderer::renderModel(int model)
+{
+    QElapsedTimer clock;
+    clock.start();
+
+    // Built once, then drawn in every combination
+    TriangleMesh* mesh = ModelCatalogue::create(model, _renderer.sceneRenderer()->modelShader());
+    qint64 buildTime = clock.elapsed();
+
+    for (const QSize& size : _sizes)
+    {
+        for (const View& view : _views)
+        {
+            for (const MaterialPreset* preset : _presets)
+            {
+                _renderer.render(OffscreenRenderer::fittedState(mesh, *preset, view.projection, size),
+                                 mesh, fileName(model, *preset, view, size));
+                _images++;
+            }
+        }
+    }
+
+    // Pending reads use the resolve target only, the mesh can go
+    _renderer.sceneRenderer()->releaseMesh(mesh);
+    delete mesh;
+
+    cout << ModelCatalogue::name(model).toStdString() << ": built in " << buildTime
+         << " ms, rendered in " << clock.elapsed() - buildTime << " ms" << endl;
+}
+
+QString BatchRenderer::fileName(int model, const MaterialPreset& preset, const View& view, const QSize& size) const
+{
+    // "Boy's Surface" becomes "boys-surface"
+    QString name = ModelCatalogue::name(model).toLower();
+    name.remove('\'');
+    name.replace(' ', '-');
+    return QDir(_outputDir).filePath(QString("%1_%2_%3_%4x%5.png")
+                                     .arg(name, preset.name, view.name)
+                                     .arg(size.width()).arg(size.height()));
+}
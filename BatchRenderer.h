@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+
+#include <QString>
+#include <QStringList>
+
+#include "OffscreenRenderer.h"
+
+class TriangleMesh;
+struct MaterialPreset;
+
+
+// Renders catalogue images without a window, started with --batch:
+//
+//   MatlEditor --batch --models "Cube,Klein Bottle" --materials brass,ruby
+//              --views iso,top --sizes 512x512,1024x768 --output images
+//
+// Every model is built once and drawn in all materials, views and sizes.
+class BatchRenderer
+{
+public:
+    BatchRenderer();
+    ~BatchRenderer();
+
+    // Reads the options following --batch, false after printing the problem
+    bool parseArguments(const QStringList& arguments);
+    // Renders all combinations, returns the exit code of the process
+    int run();
+
+    static void printUsage();
+
+private:
+    struct View
+    {
+        QString name;
+        GLCamera::ViewProjection projection;
+    };
+
+    void renderModel(int model);
+    QString fileName(int model, const MaterialPreset& preset, const View& view, const QSize& size) const;
+
+    // Options
+    std::vector<int> _models;
+    std::vector<const MaterialPreset*> _presets;
+    std::vector<View> _views;
+    std::vector<QSize> _sizes;
+    QString _outputDir;
+    int _samples;
+
+    OffscreenRenderer _renderer;
+    int _images;
+};
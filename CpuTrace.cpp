@@ -0,0 +1,261 @@
+#include "CpuTrace.h"
+
+#include <QFile>
+#include <QMutex>
+#include <QStringList>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct Event
+    {
+        const char* name;
+        long long begin;
+        long long end;
+    };
+
+    // Written by its thread only. Readers copy the events and drop the ones the
+    // writer may have overwritten meanwhile, nobody ever waits.
+    struct ThreadBuffer
+    {
+        static const unsigned long long CAPACITY = 1 << 15;
+        // Events are allocated in chunks as the thread records, a thread that
+        // opens a few scopes costs one chunk, not the whole ring
+        static const unsigned long long CHUNK_SIZE = 1 << 10;
+
+        std::atomic<Event*> chunks[CAPACITY / CHUNK_SIZE];
+        std::atomic<unsigned long long> written;
+        // Events before it were recorded by an earlier thread that used the buffer
+        unsigned long long first;
+        int id;
+
+        // Scopes open right now, deeper ones are counted but not named
+        static const int MAX_DEPTH = 32;
+        std::atomic<const char*> open[MAX_DEPTH];
+        std::atomic<int> depth;
+        std::string name;
+    };
+
+    const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    // Buffers of all threads that recorded. The buffer of a thread that ended
+    // keeps its events for the trace until a new thread takes it over, the
+    // longest ended first, so short lived threads do not add up.
+    QMutex buffersMutex;
+    std::vector<ThreadBuffer*> buffers;
+    std::deque<ThreadBuffer*> endedBuffers;
+
+    thread_local ThreadBuffer* threadBuffer = nullptr;
+
+    // Hands the buffer of the thread back when the thread ends
+    struct BufferOwner
+    {
+        ThreadBuffer* buffer = nullptr;
+
+        ~BufferOwner()
+        {
+            if (!buffer)
+                return;
+            QMutexLocker locker(&buffersMutex);
+            endedBuffers.push_back(buffer);
+        }
+    };
+    thread_local BufferOwner bufferOwner;
+
+    ThreadBuffer* currentBuffer()
+    {
+        if (!threadBuffer)
+        {
+            QMutexLocker locker(&buffersMutex);
+            if (!endedBuffers.empty())
+            {
+                threadBuffer = endedBuffers.front();
+                endedBuffers.pop_front();
+                threadBuffer->first = threadBuffer->written.load(std::memory_order_relaxed);
+            }
+            else
+            {
+                threadBuffer = new ThreadBuffer();
+                for (std::atomic<Event*>& chunk : threadBuffer->chunks)
+                    chunk.store(nullptr, std::memory_order_relaxed);
+                threadBuffer->written.store(0, std::memory_order_relaxed);
+                threadBuffer->first = 0;
+                threadBuffer->id = static_cast<int>(buffers.size()) + 1;
+                buffers.push_back(threadBuffer);
+            }
+            threadBuffer->depth.store(0, std::memory_order_relaxed);
+            threadBuffer->name = "Thread " + std::to_string(threadBuffer->id);
+            bufferOwner.buffer = threadBuffer;
+        }
+        return threadBuffer;
+    }
+
+    // Slot of the index, allocated by the writer before it records into it
+    Event* eventSlot(ThreadBuffer* buffer, unsigned long long index)
+    {
+        unsigned long long slot = index % ThreadBuffer::CAPACITY;
+        std::atomic<Event*>& chunk = buffer->chunks[slot / ThreadBuffer::CHUNK_SIZE];
+        Event* events = chunk.load(std::memory_order_acquire);
+        if (!events)
+        {
+            events = new Event[ThreadBuffer::CHUNK_SIZE];
+            chunk.store(events, std::memory_order_release);
+        }
+        return &events[slot % ThreadBuffer::CHUNK_SIZE];
+    }
+
+    std::string escaped(const std::string& text)
+    {
+        std::string result;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                result += '\\';
+            result += c;
+        }
+        return result;
+    }
+}
+
+long long CpuTrace::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void CpuTrace::record(const char* name, long long begin, long long end)
+{
+    ThreadBuffer* buffer = currentBuffer();
+    unsigned long long index = buffer->written.load(std::memory_order_relaxed);
+    Event& event = *eventSlot(buffer, index);
+    event.name = name;
+    event.begin = begin;
+    event.end = end;
+    buffer->written.store(index + 1, std::memory_order_release);
+}
+
+void CpuTrace::enter(const char* name)
+{
+    ThreadBuffer* buffer = currentBuffer();
+    int depth = buffer->depth.load(std::memory_order_relaxed);
+    if (depth < ThreadBuffer::MAX_DEPTH)
+        buffer->open[depth].store(name, std::memory_order_relaxed);
+    buffer->depth.store(depth + 1, std::memory_order_release);
+}
+
+void CpuTrace::leave()
+{
+    ThreadBuffer* buffer = currentBuffer();
+    buffer->depth.store(buffer->depth.load(std::memory_order_relaxed) - 1, std::memory_order_release);
+}
+
+int CpuTrace::threadId()
+{
+    return currentBuffer()->id;
+}
+
+QString CpuTrace::openScopes(int threadId)
+{
+    ThreadBuffer* buffer = nullptr;
+    {
+        QMutexLocker locker(&buffersMutex);
+        if (threadId >= 1 && threadId <= static_cast<int>(buffers.size()))
+            buffer = buffers[threadId - 1];
+    }
+    if (!buffer)
+        return QString();
+
+    // Names are string literals, a scope closing meanwhile leaves a stale but valid one
+    int depth = qMin(buffer->depth.load(std::memory_order_acquire), static_cast<int>(ThreadBuffer::MAX_DEPTH));
+    QStringList names;
+    for (int i = 0; i < depth; i++)
+        names << QString::fromLatin1(buffer->open[i].load(std::memory_order_relaxed));
+    return names.join(" > ");
+}
+
+void CpuTrace::setThreadName(const char* name)
+{
+    ThreadBuffer* buffer = currentBuffer();
+    QMutexLocker locker(&buffersMutex);
+    buffer->name = name;
+}
+
+bool CpuTrace::isAvailable()
+{
+#ifdef MATLEDITOR_TRACE
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool CpuTrace::write(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        std::cout << "Could not write " << fileName.toStdString() << ": " << file.errorString().toStdString() << std::endl;
+        return false;
+    }
+
+    std::vector<ThreadBuffer*> threads;
+    {
+        QMutexLocker locker(&buffersMutex);
+        threads = buffers;
+    }
+
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    char line[512];
+    for (ThreadBuffer* buffer : threads)
+    {
+        unsigned long long end = buffer->written.load(std::memory_order_acquire);
+        unsigned long long begin = end > ThreadBuffer::CAPACITY ? end - ThreadBuffer::CAPACITY : 0;
+        std::vector<Event> events;
+        events.reserve(end - begin);
+        for (unsigned long long i = begin; i < end; i++)
+        {
+            unsigned long long slot = i % ThreadBuffer::CAPACITY;
+            const Event* chunk = buffer->chunks[slot / ThreadBuffer::CHUNK_SIZE].load(std::memory_order_acquire);
+            events.push_back(chunk[slot % ThreadBuffer::CHUNK_SIZE]);
+        }
+
+        // Events the thread recorded while copying replaced the oldest copied ones,
+        // and the slot of event "after" may be being overwritten right now. A thread
+        // that took the buffer over meanwhile owns the events from its first one.
+        unsigned long long after = buffer->written.load(std::memory_order_acquire);
+        unsigned long long valid = after >= ThreadBuffer::CAPACITY ? after - ThreadBuffer::CAPACITY + 1 : 0;
+        std::string name;
+        {
+            QMutexLocker locker(&buffersMutex);
+            name = buffer->name;
+            valid = qMax(valid, buffer->first);
+        }
+        snprintf(line, sizeof(line), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                 first ? "" : ",\n", buffer->id, escaped(name).c_str());
+        json += line;
+        first = false;
+
+        for (unsigned long long i = qMax(begin, valid); i < end; i++)
+        {
+            const Event& event = events[i - begin];
+            snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                     escaped(event.name).c_str(), buffer->id, event.begin / 1000.0, (event.end - event.begin) / 1000.0);
+            json += line;
+        }
+    }
+    json += "\n]}\n";
+
+    if (file.write(json.data(), static_cast<qint64>(json.size())) != static_cast<qint64>(json.size()))
+    {
+        std::cout << "Could not write " << fileName.toStdString() << ": " << file.errorString().toStdString() << std::endl;
+        return false;
+    }
+    return true;
+}
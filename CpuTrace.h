@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QString>
+
+// Scoped CPU timers for finding where interactive latency goes. Every thread
+// records into its own ring buffer without locks, the newest events of all
+// threads are written as Chrome trace JSON on demand, to be opened in
+// chrome://tracing or ui.perfetto.dev.
+//
+// TRACE_SCOPE compiles to nothing unless MATLEDITOR_TRACE is defined, the
+// project defines it unless built with CONFIG+=notrace.
+#ifdef MATLEDITOR_TRACE
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+// The name must outlive the trace, a string literal
+#define TRACE_SCOPE(name) CpuTrace::Scope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define TRACE_THREAD_NAME(name) CpuTrace::setThreadName(name)
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_THREAD_NAME(name)
+#endif
+
+class CpuTrace
+{
+public:
+    class Scope
+    {
+    public:
+        explicit Scope(const char* name) : _name(name) { enter(name); _begin = now(); }
+        ~Scope() { long long end = now(); leave(); record(_name, _begin, end); }
+
+    private:
+        const char* _name;
+        long long _begin;
+    };
+
+    // Nanoseconds since the first use
+    static long long now();
+    static void record(const char* name, long long begin, long long end);
+    // Shown for the calling thread in the trace
+    static void setThreadName(const char* name);
+
+    // The scopes open on a thread, kept so another thread can see what it is busy with
+    static void enter(const char* name);
+    static void leave();
+    // Identifies the calling thread for openScopes
+    static int threadId();
+    // Open scopes of the thread, outermost first, joined with " > ". Safe from any thread.
+    static QString openScopes(int threadId);
+
+    // Writes the events still held by the ring buffers, false after printing the problem
+    static bool write(const QString& fileName);
+    // Whether scopes are compiled in
+    static bool isAvailable();
+};
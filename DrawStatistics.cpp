@@ -0,0 +1,50 @@
+#include "DrawStatistics.h"
+
+#include <atomic>
+
+namespace
+{
+    std::atomic<long long> drawCallCount(0);
+    std::atomic<long long> triangleCount(0);
+}
+
+void DrawStatistics::count(GLenum mode, GLsizei vertices, GLsizei instances)
+{
+    long long triangles = 0;
+    switch (mode)
+    {
+    case GL_TRIANGLES:
+        triangles = vertices / 3;
+        break;
+    case GL_TRIANGLES_ADJACENCY:
+        triangles = vertices / 6;
+        break;
+    case GL_QUADS:
+        triangles = vertices / 4 * 2;
+        break;
+    case GL_TRIANGLE_STRIP:
+    case GL_TRIANGLE_FAN:
+        triangles = qMax(0, vertices - 2);
+        break;
+    default:
+        break;
+    }
+    drawCallCount.fetch_add(1, std::memory_order_relaxed);
+    triangleCount.fetch_add(triangles * instances, std::memory_order_relaxed);
+}
+
+void DrawStatistics::reset()
+{
+    drawCallCount.store(0, std::memory_order_relaxed);
+    triangleCount.store(0, std::memory_order_relaxed);
+}
+
+long long DrawStatistics::drawCalls()
+{
+    return drawCallCount.load(std::memory_order_relaxed);
+}
+
+long long DrawStatistics::triangles()
+{
+    return triangleCount.load(std::memory_order_relaxed);
+}
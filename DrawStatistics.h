@@ -0,0 +1,16 @@
+#pragma once
+
+#include <QtOpenGL>
+
+// Draw calls and triangles submitted since the last reset, counted at every
+// draw of the viewer on any thread. Read by the view benchmark.
+class DrawStatistics
+{
+public:
+    // Counts one draw of the vertices, quads and strips are counted as the triangles they make
+    static void count(GLenum mode, GLsizei vertices, GLsizei instances = 1);
+    static void reset();
+
+    static long long drawCalls();
+    static long long triangles();
+};
@@ -0,0 +1,463 @@
+#include "FrameRecorder.h"
+#include "SceneRenderer.h"
+#include "ModelCatalogue.h"
+#include "TriangleMesh.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QRegularExpression>
+
+#include <algorithm>
+
+FrameWriter::FrameWriter(QObject* parent) : QThread(parent),
+    _format(IMAGE_SEQUENCE),
+    _queueSize(4),
+    _finished(false)
+{
+}
+
+FrameWriter::~FrameWriter()
+{
+    if (isRunning())
+        finish();
+}
+
+bool FrameWriter::open(const QString& output, const QSize& size, int fps, int queueSize)
+{
+    _output = output;
+    _size = size;
+    _queueSize = static_cast<size_t>(qMax(1, queueSize));
+    _finished = false;
+    _failedFrames.clear();
+
+    QString suffix = QFileInfo(output).suffix().toLower();
+    if (output.contains('%'))
+    {
+        // The pattern becomes a format string, it may only hold the frame number
+        QString conversions = QString(output).remove("%%");
+        if (conversions.count('%') != 1 || conversions.count(QRegularExpression("%\\d{0,2}d")) != 1)
+        {
+            cout << "The output pattern needs exactly one frame number like %04d, write %% for a percent sign" << endl;
+            return false;
+        }
+        _format = IMAGE_SEQUENCE;
+    }
+    else if (suffix == "y4m")
+        _format = Y4M;
+    else if (suffix == "rgba" || suffix == "raw")
+        _format = RAW;
+    else
+    {
+        cout << "The output needs a frame number like %04d, or a .y4m or .rgba suffix" << endl;
+        return false;
+    }
+
+    QDir().mkpath(QFileInfo(output).path());
+    if (_format != IMAGE_SEQUENCE)
+    {
+        _file.setFileName(output);
+        if (!_file.open(QIODevice::WriteOnly))
+        {
+            cout << "Could not write " << output.toStdString() << ": " << _file.errorString().toStdString() << endl;
+            return false;
+        }
+        // Full resolution chroma, nothing is lost to subsampling
+        if (_format == Y4M)
+            _file.write(QString("YUV4MPEG2 W%1 H%2 F%3:1 Ip A1:1 C444\n")
+                        .arg(size.width()).arg(size.height()).arg(fps).toLatin1());
+    }
+
+    start();
+    return true;
+}
+
+qint64 FrameWriter::addFrame(int number, const QImage& frame)
+{
+    QElapsedTimer clock;
+    clock.start();
+
+    QMutexLocker locker(&_mutex);
+    while (_frames.size() >= _queueSize)
+        _frameTaken.wait(&_mutex);
+    Frame entry;
+    entry.number = number;
+    entry.image = frame;
+    _frames.push_back(entry);
+    _frameAdded.wakeOne();
+    return clock.elapsed();
+}
+
+void FrameWriter::finish()
+{
+    {
+        QMutexLocker locker(&_mutex);
+        _finished = true;
+        _frameAdded.wakeOne();
+    }
+    wait();
+    if (_file.isOpen())
+        _file.close();
+}
+
+std::vector<int> FrameWriter::failedFrames() const
+{
+    QMutexLocker locker(&_mutex);
+    return _failedFrames;
+}
+
+void FrameWriter::run()
+{
+    forever
+    {
+        Frame frame;
+        {
+            QMutexLocker locker(&_mutex);
+            while (_frames.empty() && !_finished)
+                _frameAdded.wait(&_mutex);
+            if (_frames.empty())
+                return;
+            frame = _frames.front();
+            _frames.pop_front();
+            _frameTaken.wakeOne();
+        }
+
+        if (!writeFrame(frame))
+        {
+            QMutexLocker locker(&_mutex);
+            _failedFrames.push_back(frame.number);
+        }
+    }
+}
+
+bool FrameWriter::writeFrame(const Frame& frame)
+{
+    const QImage& image = frame.image;
+    int w = _size.width();
+    int h = _size.height();
+
+    if (_format == IMAGE_SEQUENCE)
+    {
+        // Rows arrive bottom up from OpenGL
+        QString fileName = QString::asprintf(_output.toUtf8().constData(), frame.number);
+        return image.mirrored().save(fileName);
+    }
+
+    if (_format == RAW)
+    {
+        bool written = true;
+        for (int y = h - 1; y >= 0; y--)
+            written = _file.write(reinterpret_cast<const char*>(image.constScanLine(y)), w * 4) == w * 4 && written;
+        return written;
+    }
+
+    // BT.601 studio range in three full planes, top row first
+    _buffer.resize(w * h * 3);
+    uchar* yPlane = reinterpret_cast<uchar*>(_buffer.data());
+    uchar* uPlane = yPlane + w * h;
+    uchar* vPlane = uPlane + w * h;
+    for (int y = 0; y < h; y++)
+    {
+        const uchar* source = image.constScanLine(h - 1 - y);
+        int row = y * w;
+        for (int x = 0; x < w; x++)
+        {
+            int r = source[x * 4 + 0];
+            int g = source[x * 4 + 1];
+            int b = source[x * 4 + 2];
+            yPlane[row + x] = static_cast<uchar>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+            uPlane[row + x] = static_cast<uchar>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            vPlane[row + x] = static_cast<uchar>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+    return _file.write("FRAME\n", 6) == 6 && _file.write(_buffer) == _buffer.size();
+}
+
+FrameRecorder::FrameRecorder() :
+    _model(-1),
+    _preset(nullptr),
+    _duration(0.0),
+    _loop(false),
+    _fps(30),
+    _size(1280, 720),
+    _perspective(false),
+    _samples(4),
+    _readbacks(4),
+    _queueSize(8)
+{
+}
+
+FrameRecorder::~FrameRecorder()
+{
+}
+
+void FrameRecorder::printUsage()
+{
+    cout << "Usage: MatlEditor --record [options]\n"
+         << "  --model <name>       Model name or number\n"
+         << "  --material <name>    Material preset, default chrome\n"
+         << "  --turntable <s>      One turn about the vertical axis in this many seconds\n"
+         << "  --path <file>        Keyframes as JSON: [{\"time\": 0, \"view\": \"iso\", \"zoom\": 1, \"turn\": 0}, ...]\n"
+         << "  --view <name>        View of the turntable, default iso\n"
+         << "  --zoom <factor>      Zoom of the turntable, default 1\n"
+         << "  --projection <name>  orthographic or perspective, default orthographic\n"
+         << "  --fps <n>            Frames per second of the animation, default 30\n"
+         << "  --size <WxH>         Frame size, default 1280x720\n"
+         << "  --output <name>      frames/spin_%04d.png, spin.y4m or spin.rgba\n"
+         << "  --samples <n>        Multisampling, default 4\n"
+         << "  --readbacks <n>      Pixel buffers in the read ring, default 4\n"
+         << "  --queue <n>          Frames waiting for the encoder, default 8\n"
+         << "Without a display start with -platform offscreen.\n";
+}
+
+bool FrameRecorder::parseArguments(const QStringList& arguments)
+{
+    QString path;
+    double turntable = 0.0;
+    GLCamera::ViewProjection view = GLCamera::SE_ISOMETRIC_VIEW;
+    GLfloat zoom = 1.0f;
+
+    for (int i = arguments.indexOf("--record") + 1; i < arguments.size(); i++)
+    {
+        const QString& option = arguments.at(i);
+        if (option == "--help")
+        {
+            printUsage();
+            return false;
+        }
+        if (i + 1 >= arguments.size())
+        {
+            cout << "Missing value for " << option.toStdString() << endl;
+            return false;
+        }
+        const QString& value = arguments.at(++i);
+
+        if (option == "--model")
+        {
+            _model = ModelCatalogue::find(value);
+            if (_model < 0)
+            {
+                cout << "Unknown model " << value.toStdString() << endl;
+                return false;
+            }
+        }
+        else if (option == "--material")
+        {
+            _preset = findMaterialPreset(value);
+            if (!_preset)
+            {
+                cout << "Unknown material " << value.toStdString() << endl;
+                return false;
+            }
+        }
+        else if (option == "--view")
+        {
+            if (!OffscreenRenderer::findView(value, view))
+            {
+                cout << "Unknown view " << value.toStdString() << endl;
+                return false;
+            }
+        }
+        else if (option == "--size")
+        {
+            QStringList size = value.split('x');
+            _size = size.size() == 2 ? QSize(size.at(0).toInt(), size.at(1).toInt()) : QSize();
+            if (_size.width() <= 0 || _size.height() <= 0)
+            {
+                cout << "Invalid size " << value.toStdString() << endl;
+                return false;
+            }
+        }
+        else if (option == "--turntable")
+            turntable = value.toDouble();
+        else if (option == "--path")
+            path = value;
+        else if (option == "--zoom")
+            zoom = value.toFloat();
+        else if (option == "--projection")
+            _perspective = value == "perspective";
+        else if (option == "--fps")
+            _fps = qMax(1, value.toInt());
+        else if (option == "--output")
+            _output = value;
+        else if (option == "--samples")
+            _samples = qMax(0, value.toInt());
+        else if (option == "--readbacks")
+            _readbacks = qMax(1, value.toInt());
+        else if (option == "--queue")
+            _queueSize = qMax(1, value.toInt());
+        else
+        {
+            cout << "Unknown option " << option.toStdString() << endl;
+            printUsage();
+            return false;
+        }
+    }
+
+    if (_model < 0 || _output.isEmpty())
+    {
+        cout << "A model and an output are needed" << endl;
+        printUsage();
+        return false;
+    }
+    if (!_preset)
+        _preset = findMaterialPreset("chrome");
+
+    if (!path.isEmpty())
+        return loadPath(path);
+
+    if (turntable <= 0.0)
+    {
+        cout << "Either --turntable or --path is needed" << endl;
+        return false;
+    }
+    Keyframe start = { 0.0, view, zoom, 0.0f };
+    Keyframe end = { turntable, view, zoom, 360.0f };
+    _keyframes.push_back(start);
+    _keyframes.push_back(end);
+    _duration = turntable;
+    _loop = true;
+    return true;
+}
+
+bool FrameRecorder::loadPath(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        cout << "Could not read " << fileName.toStdString() << endl;
+        return false;
+    }
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll());
+    QJsonArray keyframes = document.isArray() ? document.array() : document.object().value("keyframes").toArray();
+
+    for (const QJsonValue& value : keyframes)
+    {
+        QJsonObject object = value.toObject();
+        Keyframe keyframe;
+        keyframe.time = object.value("time").toDouble();
+        keyframe.zoom = object.value("zoom").toDouble(1.0);
+        keyframe.turn = object.value("turn").toDouble(0.0);
+        if (!OffscreenRenderer::findView(object.value("view").toString("iso"), keyframe.view))
+        {
+            cout << "Unknown view in " << fileName.toStdString() << endl;
+            return false;
+        }
+        _keyframes.push_back(keyframe);
+    }
+    if (_keyframes.empty())
+    {
+        cout << "No keyframes in " << fileName.toStdString() << endl;
+        return false;
+    }
+
+    std::stable_sort(_keyframes.begin(), _keyframes.end(), [](const Keyframe& a, const Keyframe& b) {
+        return a.time < b.time;
+    });
+    _duration = _keyframes.back().time;
+    _loop = false;
+    return true;
+}
+
+QQuaternion FrameRecorder::viewRotation(GLCamera::ViewProjection view)
+{
+    GLCamera camera;
+    camera.setView(view);
+    return QQuaternion::fromRotationMatrix(camera.getViewMatrix().toGenericMatrix<3, 3>());
+}
+
+RenderState FrameRecorder::frameState(TriangleMesh* mesh, double time) const
+{
+    // Keyframes around the time, the last one holds after the path
+    size_t next = 0;
+    while (next < _keyframes.size() && _keyframes[next].time <= time)
+        next++;
+    const Keyframe& a = _keyframes[next > 0 ? next - 1 : 0];
+    const Keyframe& b = _keyframes[qMin(next, _keyframes.size() - 1)];
+    GLfloat t = b.time > a.time ? static_cast<GLfloat>((time - a.time) / (b.time - a.time)) : 0.0f;
+
+    GLfloat zoom = a.zoom + (b.zoom - a.zoom) * t;
+    GLfloat turn = a.turn + (b.turn - a.turn) * t;
+    QQuaternion rotation = QQuaternion::slerp(viewRotation(a.view), viewRotation(b.view), t);
+
+    // Projection of the fitted view, the camera looks at the model centre
+    RenderState state = OffscreenRenderer::fittedState(mesh, *_preset, a.view, _size, zoom, _perspective);
+    QVector3D center = mesh->getBoundingSphere().getCenter();
+    state.modelViewMatrix.setToIdentity();
+    state.modelViewMatrix.rotate(rotation);
+    state.modelViewMatrix.rotate(turn, 0.0f, 0.0f, 1.0f);
+    state.modelViewMatrix.translate(-center);
+    return state;
+}
+
+int FrameRecorder::run()
+{
+    if (!_renderer.create(_samples, _readbacks))
+        return 1;
+
+    // A loop leaves out the frame equal to the first one
+    int frameCount = _loop ? qMax(1, qRound(_duration * _fps)) : static_cast<int>(_duration * _fps) + 1;
+    if (!_writer.open(_output, _size, _fps, _queueSize))
+        return 1;
+
+    TriangleMesh* mesh = ModelCatalogue::create(_model, _renderer.sceneRenderer()->modelShader());
+
+    QElapsedTimer clock;
+    clock.start();
+
+    // Frames arrive here in order from the read ring, on this thread
+    double period = 1000.0 / _fps;
+    std::vector<int> failed;
+    std::vector<int> late;
+    qint64 stallTime = 0;
+    qint64 lastFrame = -1;
+    for (int i = 0; i < frameCount; i++)
+    {
+        _renderer.render(frameState(mesh, static_cast<double>(i) / _fps), mesh, [&, i](const QImage& image) {
+            if (image.isNull())
+            {
+                failed.push_back(i);
+                return;
+            }
+            stallTime += _writer.addFrame(i, image);
+
+            // Slower than the animation plays back, the capture fell behind real time
+            qint64 now = clock.elapsed();
+            if (lastFrame >= 0 && now - lastFrame > period)
+                late.push_back(i);
+            lastFrame = now;
+        });
+    }
+    _renderer.flush();
+    qint64 renderTime = clock.elapsed();
+    _writer.finish();
+    delete mesh;
+
+    std::vector<int> writeFailed = _writer.failedFrames();
+    failed.insert(failed.end(), writeFailed.begin(), writeFailed.end());
+    std::sort(failed.begin(), failed.end());
+
+    double seconds = clock.elapsed() / 1000.0;
+    double length = static_cast<double>(frameCount) / _fps;
+    cout << frameCount << " frames (" << length << " s) in " << seconds << " s, "
+         << (seconds > 0.0 ? length / seconds : 0.0) << "x real time\n"
+         << "Drawn and read in " << renderTime << " ms, " << stallTime << " ms waiting for the encoder\n";
+
+    auto printFrames = [](const char* what, const std::vector<int>& frames) {
+        cout << frames.size() << " " << what;
+        for (size_t i = 0; i < frames.size() && i < 20; i++)
+            cout << (i ? ", " : ": ") << frames[i];
+        if (frames.size() > 20)
+            cout << ", ...";
+        cout << endl;
+    };
+    printFrames("dropped", failed);
+    printFrames("late", late);
+
+    if (_writer.format() == FrameWriter::RAW)
+        cout << "Encode with: ffmpeg -f rawvideo -pixel_format rgba -video_size " << _size.width() << "x" << _size.height()
+             << " -framerate " << _fps << " -i " << _output.toStdString() << " out.mp4" << endl;
+    return failed.empty() ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include <QFile>
+#include <QImage>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+
+#include "OffscreenRenderer.h"
+#include "MaterialPresets.h"
+
+
+// Encodes the recorded frames in order on its own thread, as numbered image
+// files, a Y4M stream or raw RGBA. The queue is bounded: a full queue blocks
+// the renderer instead of dropping frames.
+class FrameWriter : public QThread
+{
+public:
+    enum Format { IMAGE_SEQUENCE, Y4M, RAW };
+
+    FrameWriter(QObject* parent = nullptr);
+    ~FrameWriter();
+
+    // A pattern with one printf style number, e.g. frames/spin_%04d.png, writes
+    // one file per frame, %% is a literal percent sign; .y4m and .rgba files are streams
+    bool open(const QString& output, const QSize& size, int fps, int queueSize);
+    // Queues the next frame, returns the time in ms spent waiting for room
+    qint64 addFrame(int number, const QImage& frame);
+    // Writes the queued frames and closes the output
+    void finish();
+
+    Format format() const { return _format; }
+    // Frames that could not be written, by number
+    std::vector<int> failedFrames() const;
+
+protected:
+    void run() override;
+
+private:
+    struct Frame
+    {
+        int number;
+        QImage image;
+    };
+
+    bool writeFrame(const Frame& frame);
+
+    QString _output;
+    Format _format;
+    QSize _size;
+    QFile _file;
+    QByteArray _buffer;
+
+    mutable QMutex _mutex;
+    QWaitCondition _frameAdded;
+    QWaitCondition _frameTaken;
+    std::deque<Frame> _frames;
+    size_t _queueSize;
+    bool _finished;
+    std::vector<int> _failedFrames;
+};
+
+
+// Records a turntable or a keyframed camera path at a fixed time step without
+// a window, started with --record:
+//
+//   MatlEditor --record --model Spring --material brass --turntable 4
+//              --fps 60 --size 1280x720 --output spin.y4m
+//
+// Frames are timed by their number, never by the clock, so a capture is
+// deterministic and runs as fast as the GPU and the encoder allow. Drawing,
+// the reads through the pixel buffer ring and the encoding overlap; frames
+// that fail are reported, as are frames slower than real time.
+class FrameRecorder
+{
+public:
+    FrameRecorder();
+    ~FrameRecorder();
+
+    // Reads the options following --record, false after printing the problem
+    bool parseArguments(const QStringList& arguments);
+    // Records all frames, returns the exit code of the process
+    int run();
+
+    static void printUsage();
+
+private:
+    // Camera at a point in time, interpolated between keyframes
+    struct Keyframe
+    {
+        double time;              // Seconds
+        GLCamera::ViewProjection view;
+        GLfloat zoom;
+        GLfloat turn;             // Degrees about the vertical axis through the model centre
+    };
+
+    bool loadPath(const QString& fileName);
+    // Rotation of the camera in one of the standard views
+    static QQuaternion viewRotation(GLCamera::ViewProjection view);
+    // The camera interpolated between the keyframes around the time
+    RenderState frameState(TriangleMesh* mesh, double time) const;
+
+    // Options
+    int _model;
+    const MaterialPreset* _preset;
+    std::vector<Keyframe> _keyframes;
+    double _duration;
+    bool _loop;                   // The last frame leads back to the first, as in a turntable
+    int _fps;
+    QSize _size;
+    bool _perspective;
+    QString _output;
+    int _samples;
+    int _readbacks;
+    int _queueSize;
+
+    OffscreenRenderer _renderer;
+    FrameWriter _writer;
+};
@@ -0,0 +1,225 @@
+#include "GLDebugLog.h"
+
+#include <QCoreApplication>
+#include <QMutex>
+#include <QOpenGLContext>
+#include <QOpenGLDebugLogger>
+#include <QRegularExpression>
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+
+namespace
+{
+    std::atomic<int> activeLogs(0);
+
+    // Names by kind and object number, buffers, textures and programs are
+    // numbered separately and all start at 1
+    QMutex labelsMutex;
+    QHash<quint64, QString> labels;
+
+    quint64 labelKey(GLenum identifier, GLuint name)
+    {
+        return (static_cast<quint64>(identifier) << 32) | name;
+    }
+
+    // The identifier of the kind a message names an object by, 0 if unknown
+    GLenum identifierOf(const QString& kind)
+    {
+        QString lower = kind.toLower();
+        if (lower == "buffer")
+            return GL_BUFFER;
+        if (lower == "texture")
+            return GL_TEXTURE;
+        if (lower == "program")
+            return GL_PROGRAM;
+        if (lower == "shader")
+            return GL_SHADER;
+        if (lower.startsWith("vertex array"))
+            return GL_VERTEX_ARRAY;
+        return 0;
+    }
+
+    const char* typeName(QOpenGLDebugMessage::Type type)
+    {
+        switch (type)
+        {
+        case QOpenGLDebugMessage::ErrorType:
+            return "error";
+        case QOpenGLDebugMessage::UndefinedBehaviorType:
+            return "undefined behavior";
+        case QOpenGLDebugMessage::PerformanceType:
+            return "performance";
+        default:
+            return "other";
+        }
+    }
+}
+
+GLDebugLog::GLDebugLog(QObject* parent) :
+    QObject(parent),
+    _logger(nullptr),
+    _rateWindowMs(0),
+    _rateLines(0),
+    _suppressed(0)
+{
+    _clock.start();
+}
+
+GLDebugLog::~GLDebugLog()
+{
+    if (_logger && _logger->isLogging())
+    {
+        _logger->stopLogging();
+        // Objects deleted from now on are not unlabeled, the names would go stale
+        if (--activeLogs == 0)
+        {
+            QMutexLocker locker(&labelsMutex);
+            labels.clear();
+        }
+    }
+    if (_suppressed)
+        std::cout << "GL debug: " << _suppressed << " messages suppressed" << std::endl;
+}
+
+bool GLDebugLog::isRequested()
+{
+    return QCoreApplication::arguments().contains("--gl-debug");
+}
+
+bool GLDebugLog::initialize()
+{
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    if (!context || !context->format().testOption(QSurfaceFormat::DebugContext))
+    {
+        std::cout << "GL debug: the context is no debug context" << std::endl;
+        return false;
+    }
+
+    _logger = new QOpenGLDebugLogger(this);
+    if (!_logger->initialize())
+    {
+        std::cout << "GL debug: GL_KHR_debug is not supported" << std::endl;
+        return false;
+    }
+    connect(_logger, SIGNAL(messageLogged(QOpenGLDebugMessage)), this, SLOT(handleMessage(QOpenGLDebugMessage)));
+
+    // Notifications and markers are left out, they arrive for every draw on some drivers
+    _logger->disableMessages();
+    _logger->enableMessages(QOpenGLDebugMessage::AnySource,
+                            QOpenGLDebugMessage::ErrorType | QOpenGLDebugMessage::UndefinedBehaviorType | QOpenGLDebugMessage::PerformanceType);
+    // Synchronous, so a message arrives within the call that caused it, e.g. in a trace scope
+    _logger->startLogging(QOpenGLDebugLogger::SynchronousLogging);
+    activeLogs++;
+    std::cout << "GL debug: listening" << std::endl;
+    return true;
+}
+
+void GLDebugLog::label(QOpenGLFunctions_4_5_Core* f, GLenum identifier, GLuint name, const QString& label)
+{
+    if (activeLogs.load() == 0 || name == 0)
+        return;
+    QByteArray text = label.toUtf8();
+    f->glObjectLabel(identifier, name, text.size(), text.constData());
+
+    QMutexLocker locker(&labelsMutex);
+    labels[labelKey(identifier, name)] = label;
+}
+
+void GLDebugLog::unlabel(GLenum identifier, GLuint name)
+{
+    if (activeLogs.load() == 0 || name == 0)
+        return;
+    QMutexLocker locker(&labelsMutex);
+    labels.remove(labelKey(identifier, name));
+}
+
+QString GLDebugLog::describe(const QOpenGLDebugMessage& message) const
+{
+    QString text = message.message().trimmed();
+
+    // Drivers name objects by kind and number, e.g. "Buffer object 12 (bound to ...".
+    // A bare "object 12" could be of any kind and is left alone.
+    static const QRegularExpression objectNumber("\\b(buffer|texture|program|shader|vertex array)(?:\\s+object)?\\s+(\\d+)",
+                                                 QRegularExpression::CaseInsensitiveOption);
+    QStringList named;
+    QMutexLocker locker(&labelsMutex);
+    QRegularExpressionMatchIterator it = objectNumber.globalMatch(text);
+    while (it.hasNext())
+    {
+        QRegularExpressionMatch match = it.next();
+        quint64 key = labelKey(identifierOf(match.captured(1)), match.captured(2).toUInt());
+        if (labels.contains(key) && !named.contains(labels[key]))
+            named << labels[key];
+    }
+    locker.unlock();
+
+    if (!named.isEmpty())
+        text += " [" + named.join(", ") + "]";
+    return QString("%1 %2: %3").arg(typeName(message.type())).arg(message.id()).arg(text);
+}
+
+void GLDebugLog::print(const QString& line)
+{
+    qint64 now = _clock.elapsed();
+    if (now - _rateWindowMs >= 1000)
+    {
+        _rateWindowMs = now;
+        _rateLines = 0;
+    }
+    if (_rateLines >= LINES_PER_SECOND)
+    {
+        _suppressed++;
+        return;
+    }
+    _rateLines++;
+
+    if (_suppressed)
+    {
+        std::cout << "GL debug: " << _suppressed << " messages suppressed" << std::endl;
+        _suppressed = 0;
+    }
+    std::cout << "GL debug: " << line.toStdString() << std::endl;
+}
+
+void GLDebugLog::handleMessage(const QOpenGLDebugMessage& message)
+{
+    quint64 key = (static_cast<quint64>(message.source()) << 48) ^ (static_cast<quint64>(message.type()) << 32) ^ message.id();
+    qint64 now = _clock.elapsed();
+
+    auto it = _seen.find(key);
+    if (it == _seen.end())
+    {
+        _messages.push_back({ describe(message), 1 });
+        it = _seen.insert(key, { static_cast<int>(_messages.size()) - 1, 1, now });
+        print(_messages.back().text);
+    }
+    else
+    {
+        Message& known = _messages[it->index];
+        known.count++;
+        if (now - it->reportedMs >= REPEAT_INTERVAL_MS)
+        {
+            print(QString("%1 (%2 times since)").arg(known.text).arg(known.count - it->reported));
+            it->reported = known.count;
+            it->reportedMs = now;
+        }
+    }
+
+    // The newest distinct messages for the overlay
+    auto recent = std::find(_recent.begin(), _recent.end(), it->index);
+    if (recent != _recent.end())
+        _recent.erase(recent);
+    _recent.push_back(it->index);
+    if (static_cast<int>(_recent.size()) > RECENT_SIZE)
+        _recent.erase(_recent.begin());
+}
+
+std::vector<GLDebugLog::Message> GLDebugLog::recent(int count) const
+{
+    std::vector<Message> result;
+    for (auto it = _recent.rbegin(); it != _recent.rend() && static_cast<int>(result.size()) < count; ++it)
+        result.push_back(_messages[*it]);
+    return result;
+}
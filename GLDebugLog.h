@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QOpenGLFunctions_4_5_Core>
+
+class QOpenGLDebugLogger;
+class QOpenGLDebugMessage;
+
+
+// Listens to the KHR_debug output of a debug context, started with --gl-debug.
+// Errors, undefined behavior and performance warnings, e.g. implicit syncs and
+// shader recompiles, are logged once each and counted when they repeat, at
+// most a few lines a second. The newest are shown by the GPU profiler overlay.
+//
+// Objects named with label() appear with their name in the driver messages
+// and in GL debuggers, until unlabel() when they are deleted.
+class GLDebugLog : public QObject
+{
+    Q_OBJECT
+public:
+    struct Message
+    {
+        QString text;
+        int count;                // Times the driver sent it
+    };
+
+    GLDebugLog(QObject* parent = nullptr);
+    ~GLDebugLog();
+
+    // Starts listening in the current context, false if it is no debug context
+    bool initialize();
+    // The distinct messages seen last, newest first
+    std::vector<Message> recent(int count) const;
+
+    // Whether the debug output was asked for on the command line
+    static bool isRequested();
+    // Names a GL object, does nothing unless a log is listening
+    static void label(QOpenGLFunctions_4_5_Core* f, GLenum identifier, GLuint name, const QString& label);
+    // Forgets the name of an object about to be deleted, its number is reused
+    static void unlabel(GLenum identifier, GLuint name);
+
+private slots:
+    void handleMessage(const QOpenGLDebugMessage& message);
+
+private:
+    // The message with the labels of the objects it refers to by number
+    QString describe(const QOpenGLDebugMessage& message) const;
+    void print(const QString& line);
+
+    static const int LINES_PER_SECOND = 10;
+    static const int REPEAT_INTERVAL_MS = 5000; // Between reports of a repeating message
+    static const int RECENT_SIZE = 16;
+
+    struct Seen
+    {
+        int index;                // In _messages
+        int reported;             // Count when it was last printed
+        qint64 reportedMs;
+    };
+
+    QOpenGLDebugLogger* _logger;
+    QElapsedTimer _clock;
+    std::vector<Message> _messages;
+    QHash<quint64, Seen> _seen;   // By source, type and id
+    std::vector<int> _recent;     // Indices into _messages, newest last
+
+    qint64 _rateWindowMs;         // Start of the second the lines are counted in
+    int _rateLines;
+    int _suppressed;
+};
@@ -2,57 +2,46 @@
 #include "GLView.h"
 
 #include "TextRenderer.h"
+#include "GlyphCache.h"
+#include "GpuProfiler.h"
+#include "GLDebugLog.h"
+#include "DrawStatistics.h"
+#include "CpuTrace.h"
+#include "MemoryStatistics.h"
+#include "SceneRenderer.h"
+#include "RenderThread.h"
+#include "ModelCatalogue.h"
+#include "SnapshotWriter.h"
 
-#include "Cylinder.h"
-#include "Cone.h"
-#include "Torus.h"
-#include "Sphere.h"
-#include "Cube.h"
-#include "Teapot.h"
-#include "KleinBottle.h"
-#include "Figure8KleinBottle.h"
-#include "BoySurface.h"
-#include "TwistedTriaxial.h"
-#include "SteinerSurface.h"
 #include "SuperToroid.h"
 #include "SuperToroidEditor.h"
 #include "SuperEllipsoid.h"
 #include "SuperEllipsoidEditor.h"
 #include "Spring.h"
 #include "SpringEditor.h"
-#include "AppleSurface.h"
-#include "DoubleCone.h"
-#include "BentHorns.h"
-#include "Folium.h"
-#include "LimpetTorus.h"
-#include "SaddleTorus.h"
 #include "GraysKlein.h"
 #include "GraysKleinEditor.h"
-#include "BowTie.h"
-#include "TriaxialTritorus.h"
-#include "TriaxialHexatorus.h"
-#include "VerrillMinimal.h"
-#include "Horn.h"
-#include "Crescent.h"
-#include "ConeShell.h"
-#include "Periwinkle.h"
-#include "TopShell.h"
-#include "WrinkledPeriwinkle.h"
-#include "SpindleShell.h"
-#include "TurretShell.h"
-#include "TwistedPseudoSphere.h"
-#include "BreatherSurface.h"
 #include "SphericalHarmonic.h"
 #include "SphericalHarmonicsEditor.h"
 #include "ClippingPlanesEditor.h"
 
 #include <glm/gtc/matrix_transform.hpp>
+#include <cstring>
+
+#include <QFileInfo>
 
 using glm::vec3;
 using glm::mat4;
 
 GLView::GLView(QWidget *parent, const char * /*name*/) : QOpenGLWidget(parent),
     _textRenderer(nullptr),
+    _glyphCache(nullptr),
+    _gpuProfiler(nullptr),
+    _glDebugLog(nullptr),
+    _scaledFrame(nullptr),
+    _multiViewCache(nullptr),
+    _multiViewResolved(nullptr),
+    _renderThread(nullptr),
     _sphericalHarmonicsEditor(nullptr),
     _superToroidEditor(nullptr),
     _superEllipsoidEditor(nullptr),
@@ -61,6 +50,16 @@ GLView::GLView(QWidget *parent, const char * /*name*/) : QOpenGLWidget(parent),
     _clippingPlanesEditor(nullptr)
 {
     _fgShader = new QOpenGLShaderProgram(this);
+    _viewsUBO = 0;
+    _bViewportArrays = false;
+    _sceneVersion = 0;
+    _postedModel = -1;
+    _postedGeneration = 0;
+    for (ViewQuadrant& quadrant : _quadrants)
+    {
+        quadrant.cachedScene = 0;
+        quadrant.cached = false;
+    }
     _viewBoundingSphereDia = 200.0f;
     _viewRange = _viewBoundingSphereDia;
     _rubberBandZoomRatio = 1.0f;
@@ -76,9 +75,6 @@ GLView::GLView(QWidget *parent, const char * /*name*/) : QOpenGLWidget(parent),
     _currentTranslation = _camera->getPosition();
     _currentViewRange = _viewRange;
 
-    _slerpStep = 0.0f;
-    _slerpFrac = 0.02f;
-
     _modelNum = 6;
     _opacity = 1.0f;
     _ambiLight = { 0.623529434f, 0.396078438f, 0.490196079f, 1.0f };
@@ -108,6 +104,23 @@ GLView::GLView(QWidget *parent, const char * /*name*/) : QOpenGLWidget(parent),
     _bRightButtonDown = false;
     _bMiddleButtonDown = false;
 
+    // Start interaction at three quarter resolution and adapt to hold 12 ms of GPU
+    // time per frame, leaving headroom under a 60 Hz refresh
+    _renderScale = 0.75f;
+    _frameScale = 1.0f;
+    _targetFrameTime = 12.0f;
+    _scaleQuery = 0;
+    _scaleQueryPending = false;
+    _lastFrameScaled = false;
+
+    _pendingEvents = 0;
+    _pendingInputTime = -1;
+    _frameInputTime = -1;
+    _frameInputEvents = 0;
+    _inputClock.start();
+    resetInputLatency();
+    connect(this, SIGNAL(frameSwapped()), this, SLOT(recordInputLatency()));
+
     _modelName = "Model";
 
     _clipXEnabled = false;
@@ -122,23 +135,54 @@ GLView::GLView(QWidget *parent, const char * /*name*/) : QOpenGLWidget(parent),
     _clipYCoeff = 0.0f;
     _clipZCoeff = 0.0f;
 
-    _animateViewTimer = new QTimer(this);
-    _animateViewTimer->setTimerType(Qt::PreciseTimer);
-    connect(_animateViewTimer, SIGNAL(timeout()), this, SLOT(animateViewChange()));
+    // Animations advance once per presented frame, paced by the buffer swap
+    _animation = Animation::NONE;
+    _animationCurve = QEasingCurve(QEasingCurve::OutCubic);
+    _animationDuration = 250;
+    connect(this, SIGNAL(frameSwapped()), this, SLOT(advanceAnimation()));
+
+    connect(this, SIGNAL(modelChanged(int)), this, SLOT(updateEditorVisibility()));
 
-    _animateFitAllTimer = new QTimer(this);
-    _animateFitAllTimer->setTimerType(Qt::PreciseTimer);
-    connect(_animateFitAllTimer, SIGNAL(timeout()), this, SLOT(animateFitAll()));
+    // Results arrive some frames late, a still view is redrawn to show them
+    _gpuProfilerTimer = new QTimer(this);
+    _gpuProfilerTimer->setInterval(250);
+    connect(_gpuProfilerTimer, SIGNAL(timeout()), this, SLOT(refreshGpuProfiler()));
 
-    _animateWindowZoomTimer = new QTimer(this);
-    _animateWindowZoomTimer->setTimerType(Qt::PreciseTimer);
-    connect(_animateWindowZoomTimer, SIGNAL(timeout()), this, SLOT(animateWindowZoom()));
+    // Keep the last frame when paintGL has nothing to redraw
+    setUpdateBehavior(QOpenGLWidget::PartialUpdate);
+    _dirty = DirtyAll;
 }
 
 GLView::~GLView()
 {
+    // The thread still draws with the meshes deleted below
+    if (_renderThread)
+        delete _renderThread;
+
+    makeCurrent();
+    for (PendingSnapshot& snapshot : _pendingSnapshots)
+        finishSnapshot(snapshot);
+    _snapshotWriters.waitForDone();
+    if (_scaledFrame)
+        delete _scaledFrame;
+    if (_multiViewCache)
+        delete _multiViewCache;
+    if (_multiViewResolved)
+        delete _multiViewResolved;
+    if (_scaleQuery)
+        glDeleteQueries(1, &_scaleQuery);
+    if (_viewsUBO)
+        glDeleteBuffers(1, &_viewsUBO);
+    MemoryStatistics::release(&_viewsUBO);
+    MemoryStatistics::release(&_texture);
     if (_textRenderer)
         delete _textRenderer;
+    if (_glyphCache)
+        delete _glyphCache;
+    if (_gpuProfiler)
+        delete _gpuProfiler;
+    if (_glDebugLog)
+        delete _glDebugLog;
     for (auto a : _meshStore)
     {
         delete a;
@@ -151,6 +195,24 @@ GLView::~GLView()
 
     _bgSplitVBO.destroy();
     _bgSplitVAO.destroy();
+    doneCurrent();
+}
+
+void GLView::markDirty(unsigned int flags)
+{
+    // Anything but the camera changes what every multi view quadrant shows
+    if (flags & ~(DirtyCamera | DirtyFrame))
+        _sceneVersion++;
+    _dirty |= flags;
+    update();
+}
+
+void GLView::resetInputLatency()
+{
+    _inputLatency.lastMs = 0.0;
+    _inputLatency.averageMs = 0.0;
+    _inputLatency.maxMs = 0.0;
+    _inputLatency.eventsPerFrame = 0;
 }
 
 void GLView::changeModel(bool forward)
@@ -160,7 +222,7 @@ void GLView::changeModel(bool forward)
         _modelNum = 1;
     if (_modelNum < 1)
         _modelNum = static_cast<int>(_meshStore.size());
-    update();
+    markDirty(DirtyGeometry | DirtyOverlay);
 }
 
 void GLView::updateView()
@@ -168,36 +230,43 @@ void GLView::updateView()
     if (_fgShader->isLinked())
     {
         makeCurrent();
-        _fgShader->bind();
-        _fgShader->setUniformValue("lightSource.ambient", _ambiLight.toVector3D());
-        _fgShader->setUniformValue("lightSource.diffuse", _diffLight.toVector3D());
-        _fgShader->setUniformValue("lightSource.specular", _specLight.toVector3D());
-        _fgShader->setUniformValue("lightSource.position", _lightPosition);
-        _fgShader->setUniformValue("lightModel.ambient", QVector3D(0.2f, 0.2f, 0.2f));
-        _fgShader->setUniformValue("material.emission", _emmiMat.toVector3D());
-        _fgShader->setUniformValue("material.ambient", _ambiMat.toVector3D());
-        _fgShader->setUniformValue("material.diffuse", _diffMat.toVector3D());
-        _fgShader->setUniformValue("material.specular", _specMat.toVector3D());
-        _fgShader->setUniformValue("material.shininess", _shine);
-        _fgShader->setUniformValue("b_texEnabled", _bHasTexture);
-        _fgShader->setUniformValue("f_alpha", _opacity);
-        _fgShader->release();
-        update();
+        setLightingUniforms(_fgShader);
+        if (_bViewportArrays)
+            setLightingUniforms(&_multiViewShader);
+        markDirty(DirtyMaterial);
     }
 }
 
+void GLView::setLightingUniforms(QOpenGLShaderProgram* prog)
+{
+    prog->bind();
+    prog->setUniformValue("lightSource.ambient", _ambiLight.toVector3D());
+    prog->setUniformValue("lightSource.diffuse", _diffLight.toVector3D());
+    prog->setUniformValue("lightSource.specular", _specLight.toVector3D());
+    prog->setUniformValue("lightSource.position", _lightPosition);
+    prog->setUniformValue("lightModel.ambient", QVector3D(0.2f, 0.2f, 0.2f));
+    prog->setUniformValue("material.emission", _emmiMat.toVector3D());
+    prog->setUniformValue("material.ambient", _ambiMat.toVector3D());
+    prog->setUniformValue("material.diffuse", _diffMat.toVector3D());
+    prog->setUniformValue("material.specular", _specMat.toVector3D());
+    prog->setUniformValue("material.shininess", _shine);
+    prog->setUniformValue("b_texEnabled", _bHasTexture);
+    prog->setUniformValue("f_alpha", _opacity);
+    prog->release();
+}
+
 void GLView::setTexture(QImage img)
 {
+    TRACE_SCOPE("GLView::setTexture");
     _texImage = QGLWidget::convertToGLFormat(img);  // flipped 32bit RGBA
 }
 
 void GLView::setViewMode(ViewMode mode)
 {
-    if (!_animateViewTimer->isActive())
+    if (_animation != Animation::VIEW_CHANGE)
     {
-        _animateViewTimer->start(5);
         _viewMode = mode;
-        _slerpStep = 0.0f;
+        startAnimation(Animation::VIEW_CHANGE);
     }
 }
 
@@ -205,10 +274,11 @@ void GLView::fitAll()
 {
     _viewBoundingSphereDia = _boundingSphere.getRadius() * 2;
 
-    if (!_animateFitAllTimer->isActive())
+    // A view change already ends fitted to the bounding sphere, a running
+    // fit all or window zoom restarts as a fit all from where it got to
+    if (_animation != Animation::VIEW_CHANGE)
     {
-        _animateFitAllTimer->start(5);
-        _slerpStep = 0.0f;
+        startAnimation(Animation::FIT_ALL);
     }
 }
 
@@ -241,10 +311,9 @@ void GLView::endWindowZoom()
         _rubberBandZoomRatio = (heightRatio < widthRatio) ? heightRatio : widthRatio;
         _rubberBandPan = P - O;
     }
-    if (!_animateWindowZoomTimer->isActive())
+    if (_animation != Animation::WINDOW_ZOOM)
     {
-        _animateWindowZoomTimer->start(5);
-        _slerpStep = 0.0f;
+        startAnimation(Animation::WINDOW_ZOOM);
     }
     emit windowZoomEnded();
 }
@@ -252,14 +321,15 @@ void GLView::endWindowZoom()
 void GLView::setProjection(ViewProjection proj)
 {
     _projection = proj;
-    resizeGL(width(), height());
+    updateProjection(width(), height());
+    markDirty(DirtyCamera);
 }
 
 void GLView::updateViewBoundingSphere()
 {
     _boundingSphere = _meshStore.at(_modelNum - 1)->getBoundingSphere();
     _viewBoundingSphereDia = _boundingSphere.getRadius() * 2;
-    update();
+    markDirty(DirtyGeometry);
 }
 
 void GLView::setModelNum(const int& num)
@@ -268,10 +338,27 @@ void GLView::setModelNum(const int& num)
     updateViewBoundingSphere();
     fitAll();
     //qDebug() << "Bounding Sphere Dia " << _viewBoundingSphereDia;
-    update();
+    markDirty(DirtyGeometry | DirtyOverlay);
     emit modelChanged(_modelNum - 1);
 }
 
+void GLView::addLabel(const QVector3D& position, const QString& text, float pixelHeight, QColor color)
+{
+    if (!_textRenderer)
+        return;
+    _textRenderer->AddLabel(position, text.toStdString(), pixelHeight,
+                            glm::vec3(color.redF(), color.greenF(), color.blueF()));
+    markDirty(DirtyOverlay);
+}
+
+void GLView::clearLabels()
+{
+    if (!_textRenderer)
+        return;
+    _textRenderer->ClearLabels();
+    markDirty(DirtyOverlay);
+}
+
 void GLView::showClippingPlaneEditor(bool show)
 {
     if (!_clippingPlanesEditor)
@@ -288,6 +375,24 @@ void GLView::showClippingPlaneEditor(bool show)
     show ? _clippingPlanesEditor->show() : _clippingPlanesEditor->hide();
 }
 
+void GLView::updateEditorVisibility()
+{
+    if (_meshStore.empty() || !_springEditor)
+        return;
+    TriangleMesh* mesh = _meshStore.at(_modelNum - 1);
+
+    // Display Harmonics Editor
+    _sphericalHarmonicsEditor->setVisible(dynamic_cast<SphericalHarmonic*>(mesh) != nullptr);
+    // Display Gray's Klein Editor
+    _graysKleinEditor->setVisible(dynamic_cast<GraysKlein*>(mesh) != nullptr);
+    // Display Super Toroid Editor
+    _superToroidEditor->setVisible(dynamic_cast<SuperToroid*>(mesh) != nullptr);
+    // Display Super Ellipsoid Editor
+    _superEllipsoidEditor->setVisible(dynamic_cast<SuperEllipsoid*>(mesh) != nullptr);
+    // Display Spring Editor
+    _springEditor->setVisible(dynamic_cast<Spring*>(mesh) != nullptr);
+}
+
 
 void GLView::createShaderPrograms()
 {
@@ -311,6 +416,25 @@ void GLView::createShaderPrograms()
     }
 
 
+    // single pass multi view shader program, needs the viewport index from the vertex shader
+    QOpenGLContext* ctx = context();
+    _bViewportArrays = ctx->hasExtension(QByteArrayLiteral("GL_ARB_shader_viewport_layer_array")) ||
+                       ctx->hasExtension(QByteArrayLiteral("GL_NV_viewport_array2")) ||
+                       ctx->hasExtension(QByteArrayLiteral("GL_AMD_vertex_shader_viewport_index"));
+    if (_bViewportArrays)
+    {
+        if (!_multiViewShader.addShaderFromSourceFile(QOpenGLShader::Vertex, "shaders/twoside_multiview.vert")) {
+            qDebug() << "Error in vertex shader:" << _multiViewShader.log();
+        }
+        if (!_multiViewShader.addShaderFromSourceFile(QOpenGLShader::Fragment, "shaders/twoside_per_fragment.frag")) {
+            qDebug() << "Error in fragment shader:" << _multiViewShader.log();
+        }
+        if (!_multiViewShader.link()) {
+            qDebug() << "Error linking shader program:" << _multiViewShader.log();
+            _bViewportArrays = false;
+        }
+    }
+
     // text shader program
     if (!_textShader.addShaderFromSourceFile(QOpenGLShader::Vertex, "shaders/text.vert")) {
         qDebug() << "Error in vertex shader:" << _textShader.log();
@@ -325,6 +449,20 @@ void GLView::createShaderPrograms()
         //exit(1);
     }
 
+    // world space label shader program
+    if (!_labelShader.addShaderFromSourceFile(QOpenGLShader::Vertex, "shaders/label.vert")) {
+        qDebug() << "Error in vertex shader:" << _labelShader.log();
+        //exit(1);
+    }
+    if (!_labelShader.addShaderFromSourceFile(QOpenGLShader::Fragment, "shaders/label.frag")) {
+        qDebug() << "Error in fragment shader:" << _labelShader.log();
+        //exit(1);
+    }
+    if (!_labelShader.link()) {
+        qDebug() << "Error linking shader program:" << _labelShader.log();
+        //exit(1);
+    }
+
     // background gradient shader program
     if (!_bgShader.addShaderFromSourceFile(QOpenGLShader::Vertex, "shaders/background.vert")) {
         qDebug() << "Error in vertex shader:" << _bgShader.log();
@@ -339,6 +477,20 @@ void GLView::createShaderPrograms()
         //exit(1);
     }
 
+    // interactive frame upscaling shader program
+    if (!_upscaleShader.addShaderFromSourceFile(QOpenGLShader::Vertex, "shaders/background.vert")) {
+        qDebug() << "Error in vertex shader:" << _upscaleShader.log();
+        //exit(1);
+    }
+    if (!_upscaleShader.addShaderFromSourceFile(QOpenGLShader::Fragment, "shaders/upscale.frag")) {
+        qDebug() << "Error in fragment shader:" << _upscaleShader.log();
+        //exit(1);
+    }
+    if (!_upscaleShader.link()) {
+        qDebug() << "Error linking shader program:" << _upscaleShader.log();
+        //exit(1);
+    }
+
     // background split shader program
     if (!_bgSplitShader.addShaderFromSourceFile(QOpenGLShader::Vertex, "shaders/splitScreen.vert")) {
         qDebug() << "Error in vertex shader:" << _bgSplitShader.log();
@@ -352,45 +504,44 @@ void GLView::createShaderPrograms()
         qDebug() << "Error linking shader program:" << _bgSplitShader.log();
         //exit(1);
     }
+
+    GLDebugLog::label(this, GL_PROGRAM, _fgShader->programId(), "Model program");
+    if (_multiViewShader.isLinked())
+        GLDebugLog::label(this, GL_PROGRAM, _multiViewShader.programId(), "Multi view program");
+    GLDebugLog::label(this, GL_PROGRAM, _textShader.programId(), "Text program");
+    GLDebugLog::label(this, GL_PROGRAM, _labelShader.programId(), "Label program");
+    GLDebugLog::label(this, GL_PROGRAM, _bgShader.programId(), "Background program");
+    GLDebugLog::label(this, GL_PROGRAM, _upscaleShader.programId(), "Upscale program");
+    GLDebugLog::label(this, GL_PROGRAM, _bgSplitShader.programId(), "Split screen program");
 }
 
 
 void GLView::createGeometry()
 {
-    _meshStore.push_back(new Cube(_fgShader, 100.0f));
-    _meshStore.push_back(new Sphere(_fgShader, 75.0f, 50.0f, 50.0f));
-    _meshStore.push_back(new Cylinder(_fgShader, 60.0f, 100.0f, 100.0f, 1.0f));
-    _meshStore.push_back(new Cone(_fgShader, 60.0f, 100.0f, 100.0f, 1.0f));
-    _meshStore.push_back(new Torus(_fgShader, 50.0f, 25.0f, 100.0f, 100.0f));
-    _meshStore.push_back(new Teapot(_fgShader, 35.0f, 50, glm::translate(mat4(1.0f), vec3(0.0f, 15.0f, 25.0f))));
-    _meshStore.push_back(new KleinBottle(_fgShader, 30.0f, 150.0f, 150.0f));
-    _meshStore.push_back(new Figure8KleinBottle(_fgShader, 30.0f, 150.0f, 150.0f));
-    _meshStore.push_back(new BoySurface(_fgShader, 60.0f, 150.0f, 150.0f));
-    _meshStore.push_back(new TwistedTriaxial(_fgShader, 110.0f, 150.0f, 150.0f));
-    _meshStore.push_back(new SteinerSurface(_fgShader, 150.0f, 150.0f, 150.0f));
-    _meshStore.push_back(new AppleSurface(_fgShader, 7.5f, 150.0f, 150.0f));
-    _meshStore.push_back(new DoubleCone(_fgShader, 35.0f, 150.0f, 150.0f));
-    _meshStore.push_back(new BentHorns(_fgShader, 15.0f, 150.0f, 150.0f));
-    _meshStore.push_back(new Folium(_fgShader, 75.0f, 150.0f, 150.0f));
-    _meshStore.push_back(new LimpetTorus(_fgShader, 35.0f, 150.0f, 150.0f));
-    _meshStore.push_back(new SaddleTorus(_fgShader, 30.0f, 150.0f, 150.0f));
-    _meshStore.push_back(new BowTie(_fgShader, 40.0f, 150.0f, 150.0f));
-    _meshStore.push_back(new TriaxialTritorus(_fgShader, 45.0f, 150.0f, 150.0f));
-    _meshStore.push_back(new TriaxialHexatorus(_fgShader, 45.0f, 150.0f, 150.0f));
-    _meshStore.push_back(new VerrillMinimal(_fgShader, 25.0f, 150.0f, 150.0f));
-    _meshStore.push_back(new Horn(_fgShader, 30.0f, 150.0f, 150.0f));
-    _meshStore.push_back(new Crescent(_fgShader, 30.0f, 150.0f, 150.0f));
-    _meshStore.push_back(new ConeShell(_fgShader, 45.0f, 150.0f, 150.0f));
-    _meshStore.push_back(new Periwinkle(_fgShader, 40.0f, 150.0f, 150.0f));
-    _meshStore.push_back(new TopShell(_fgShader, Point(-50,0,0), 35.0f, 250.0f, 150.0f));
-    _meshStore.push_back(new WrinkledPeriwinkle(_fgShader, 45.0f, 150.0f, 150.0f));
-    _meshStore.push_back(new SpindleShell(_fgShader, 25.0f, 150.0f, 150.0f));
-    _meshStore.push_back(new TurretShell(_fgShader, 20.0f, 250.0f, 150.0f));
-    _meshStore.push_back(new TwistedPseudoSphere(_fgShader, 50.0f, 150.0f, 150.0f));
-    _meshStore.push_back(new BreatherSurface(_fgShader, 15.0f, 150.0f, 150.0f));
-
-    Spring* spring = new Spring(_fgShader, 10.0f, 30.0f, 10.0f, 2.0f, 50.0f, 150.0f);
-    _meshStore.push_back(spring);
+    TRACE_SCOPE("GLView::createGeometry");
+    for (int i = 0; i < ModelCatalogue::count(); i++)
+        _meshStore.push_back(ModelCatalogue::create(i, _fgShader));
+
+    // Parametric models with an editor for their parameters
+    Spring* spring = nullptr;
+    SuperToroid* storoid = nullptr;
+    SuperEllipsoid* sellipsoid = nullptr;
+    GraysKlein* gklein = nullptr;
+    SphericalHarmonic* sph = nullptr;
+    for (TriangleMesh* mesh : _meshStore)
+    {
+        if (!spring)
+            spring = dynamic_cast<Spring*>(mesh);
+        if (!storoid)
+            storoid = dynamic_cast<SuperToroid*>(mesh);
+        if (!sellipsoid)
+            sellipsoid = dynamic_cast<SuperEllipsoid*>(mesh);
+        if (!gklein)
+            gklein = dynamic_cast<GraysKlein*>(mesh);
+        if (!sph)
+            sph = dynamic_cast<SphericalHarmonic*>(mesh);
+    }
+
     _springEditor = new SpringEditor(spring, this);
     _springEditor->setWindowFlags(Qt::Tool | Qt::FramelessWindowHint);
     _springEditor->setAttribute(Qt::WA_NoSystemBackground);
@@ -399,8 +550,6 @@ void GLView::createGeometry()
     QPoint point = mapToGlobal(QPoint(frameGeometry().x(), frameGeometry().y() + 10));
     _springEditor->move(point.x(), point.y());
 
-    SuperToroid* storoid = new SuperToroid(_fgShader, 50, 25, 1, 1, 150.0f, 150.0f);
-    _meshStore.push_back(storoid);
     _superToroidEditor = new SuperToroidEditor(storoid, this);
     _superToroidEditor->setWindowFlags(Qt::Tool | Qt::FramelessWindowHint);
     _superToroidEditor->setAttribute(Qt::WA_NoSystemBackground);
@@ -409,8 +558,6 @@ void GLView::createGeometry()
     point = mapToGlobal(QPoint(frameGeometry().x(), frameGeometry().y() + 10));
     _superToroidEditor->move(point.x(), point.y());
 
-    SuperEllipsoid* sellipsoid = new SuperEllipsoid(_fgShader, 50, 1.0, 1.0, 1.0, 1.0, 1.0, 150.0f, 150.0f);
-    _meshStore.push_back(sellipsoid);
     _superEllipsoidEditor = new SuperEllipsoidEditor(sellipsoid, this);
     _superEllipsoidEditor->setWindowFlags(Qt::Tool | Qt::FramelessWindowHint);
     _superEllipsoidEditor->setAttribute(Qt::WA_NoSystemBackground);
@@ -419,8 +566,6 @@ void GLView::createGeometry()
     point = mapToGlobal(QPoint(frameGeometry().x(), frameGeometry().y() + 10));
     _superEllipsoidEditor->move(point.x(), point.y());
 
-    GraysKlein* gklein = new GraysKlein(_fgShader, 30.0f, 150.0f, 150.0f);
-    _meshStore.push_back(gklein);
     _graysKleinEditor = new GraysKleinEditor(gklein, this);
     _graysKleinEditor->setWindowFlags(Qt::Tool | Qt::FramelessWindowHint);
     _graysKleinEditor->setAttribute(Qt::WA_NoSystemBackground);
@@ -429,8 +574,6 @@ void GLView::createGeometry()
     point = mapToGlobal(QPoint(frameGeometry().x(), frameGeometry().y() + 10));
     _graysKleinEditor->move(point.x(), point.y());
 
-    SphericalHarmonic* sph = new SphericalHarmonic(_fgShader, 30.0f, 150.0f, 150.0f);
-    _meshStore.push_back(sph);
     _sphericalHarmonicsEditor = new SphericalHarmonicsEditor(sph, this);
     _sphericalHarmonicsEditor->setWindowFlags(Qt::Tool | Qt::FramelessWindowHint);
     _sphericalHarmonicsEditor->setAttribute(Qt::WA_NoSystemBackground);
@@ -442,6 +585,7 @@ void GLView::createGeometry()
 
 void GLView::createTexture(void)
 {
+    TRACE_SCOPE("GLView::createTexture");
     if (!_texBuffer.load("textures/opengllogo.png"))
     {	// Load first image from file
         qWarning("Could not read image file, using single-color instead.");
@@ -456,6 +600,9 @@ void GLView::createTexture(void)
     glTexImage2D(GL_TEXTURE_2D, 0, 3, _texImage.width(), _texImage.height(), 0,
                  GL_RGBA, GL_UNSIGNED_BYTE, _texImage.bits());
     glGenerateMipmap(GL_TEXTURE_2D);
+    GLDebugLog::label(this, GL_TEXTURE, _texture, "Model texture");
+    MemoryStatistics::setAllocation(MemoryStatistics::GPU_TEXTURE, &_texture, "Model texture",
+                                    MemoryStatistics::textureBytes(_texImage.width(), _texImage.height(), 4, true));
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR_MIPMAP_LINEAR);
@@ -465,6 +612,7 @@ void GLView::createTexture(void)
 
 void GLView::initializeGL()
 {
+    TRACE_SCOPE("GLView::initializeGL");
     initializeOpenGLFunctions();
 
     cout << "Renderer: " << glGetString(GL_RENDERER) << '\n';
@@ -483,38 +631,64 @@ void GLView::initializeGL()
 
     makeCurrent();
 
+    // Driver messages of a debug context, opt-in as listening slows every GL call
+    if (GLDebugLog::isRequested())
+    {
+        _glDebugLog = new GLDebugLog(this);
+        if (!_glDebugLog->initialize())
+        {
+            delete _glDebugLog;
+            _glDebugLog = nullptr;
+        }
+    }
+
     createShaderPrograms();
     createGeometry();
     createTexture();
+    updateEditorVisibility();
 
-    _textShader.bind();
-    _textRenderer = new TextRenderer(&_textShader, width(), height());
-    _textRenderer->Load("fonts/calibri.ttf", 24);
-    _textShader.release();
+    {
+        TRACE_SCOPE("GLView font setup");
+        _textShader.bind();
+        _glyphCache = new GlyphCache();
+        _textRenderer = new TextRenderer(&_textShader, width(), height(), &_labelShader, _glyphCache);
+        _textRenderer->Load("fonts/calibri.ttf", 24, true);
+        _textShader.release();
+    }
+
+    _gpuProfiler = new GpuProfiler();
 
     // Set lighting information
-    _fgShader->bind();
-    _fgShader->setUniformValue("lightSource.ambient", _ambiLight.toVector3D());
-    _fgShader->setUniformValue("lightSource.diffuse", _diffLight.toVector3D());
-    _fgShader->setUniformValue("lightSource.specular", _specLight.toVector3D());
-    _fgShader->setUniformValue("lightSource.position", _lightPosition);
-    _fgShader->setUniformValue("lightModel.ambient", QVector3D(0.2f, 0.2f, 0.2f));
-    _fgShader->setUniformValue("material.emission", _emmiMat.toVector3D());
-    _fgShader->setUniformValue("material.ambient", _ambiMat.toVector3D());
-    _fgShader->setUniformValue("material.diffuse", _diffMat.toVector3D());
-    _fgShader->setUniformValue("material.specular", _specMat.toVector3D());
-    _fgShader->setUniformValue("material.shininess", _shine);
-    _fgShader->setUniformValue("f_alpha", _opacity);
-    _fgShader->release();
+    setLightingUniforms(_fgShader);
+    if (_bViewportArrays)
+    {
+        setLightingUniforms(&_multiViewShader);
+        // Per view matrices and clipping planes, 240 bytes each in std140 layout
+        glCreateBuffers(1, &_viewsUBO);
+        glNamedBufferData(_viewsUBO, 4 * 240, nullptr, GL_DYNAMIC_DRAW);
+        MemoryStatistics::setAllocation(MemoryStatistics::GPU_BUFFER, &_viewsUBO, "View uniforms", 4 * 240);
+        GLDebugLog::label(this, GL_BUFFER, _viewsUBO, "View uniforms");
+    }
 
     _viewMatrix.setToIdentity();
     glEnable(GL_DEPTH_TEST);
 
+    glGenQueries(1, &_scaleQuery);
+
     glClearColor(0.0f, 0.0f, 0.0f, 1.f);
 
     // Enable blending
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // Optionally draw the single view on its own thread, the widget then only
+    // composites finished frames and stays responsive during slow ones
+    if (QCoreApplication::arguments().contains("--render-thread"))
+    {
+        _renderThread = new RenderThread(context(), _meshStore);
+        connect(_renderThread, SIGNAL(frameReady()), this, SLOT(scheduleComposite()));
+        _renderThread->start();
+    }
 }
 
 void GLView::resizeGL(int width, int height)
@@ -522,12 +696,29 @@ void GLView::resizeGL(int width, int height)
     GLfloat w = (GLfloat)width;
     GLfloat h = (GLfloat)height;
 
-    glViewport(0, 0, w, h);
+    setViewport(0, 0, width, height);
     _viewportMatrix = QMatrix4x4(w/2, 0.0f, 0.0f, 0.0f,
                                  0.0f, h/2, 0.0f, 0.0f,
                                  0.0f, 0.0f, 1.0f, 0.0f,
                                  w/2 + 0, h/2 + 0, 0.0f, 1.0f);
 
+    updateProjection(width, height);
+
+    // Resize the text frame
+    QMatrix4x4 projection;
+    projection.ortho(QRect(0.0f, 0.0f, static_cast<float>(w), static_cast<float>(h)));
+    _textShader.bind();
+    _textShader.setUniformValue("projection", projection);
+    _textShader.release();
+
+    markDirty(DirtyAll);
+}
+
+void GLView::updateProjection(int width, int height)
+{
+    GLfloat w = (GLfloat)width;
+    GLfloat h = (GLfloat)height;
+
     _projectionMatrix.setToIdentity();
     _camera->setScreenSize(w, h);
     _camera->setViewRange(_viewRange);
@@ -540,135 +731,104 @@ void GLView::resizeGL(int width, int height)
         _camera->setProjection(GLCamera::ProjectionType::PERSPECTIVE);
     }
     _projectionMatrix = _camera->getProjectionMatrix();
-
-    // Resize the text frame
-    QMatrix4x4 projection;
-    projection.ortho(QRect(0.0f, 0.0f, static_cast<float>(w), static_cast<float>(h)));
-    _textShader.bind();
-    _textShader.setUniformValue("projection", projection);
-    _textShader.release();
-
-    update();
 }
 
 void GLView::paintGL()
 {	
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    gradientBackground(0.3f, 0.3f, 0.3f, 1.0f,
-                       0.925f, 0.913f, 0.847f, 1.0f);
+    // Nothing changed since the last frame, which the partial update behaviour keeps
+    if (_dirty == DirtyNone)
+        return;
+    TRACE_SCOPE("GLView::paintGL");
+    unsigned int dirty = _dirty;
+    _dirty = DirtyNone;
 
-    glViewport(0, 0, width(), height());
-
-    QMatrix4x4 projection;
-    projection.ortho(QRect(0.0f, 0.0f, static_cast<float>(width()), static_cast<float>(height())));
-    _textShader.bind();
-    _textShader.setUniformValue("projection", projection);
-    _textShader.release();
-    // Text rendering
-    _textRenderer->RenderText(_meshStore.at(_modelNum - 1)->getName().toStdString(), 4, 4, 1, glm::vec3(1.0f, 1.0f, 0.0f));
+    applyPendingInput();
+    _gpuProfiler->beginFrame();
 
     _modelMatrix.setToIdentity();
+    _lastFrameScaled = false;
     if (_bMultiView)
     {
-        // Top View
-        _projectionMatrix.setToIdentity();
-        _viewMatrix.setToIdentity();
-        _modelMatrix.setToIdentity();
-        glViewport(0, height() / 2, width() / 2, height() / 2);
-        _camera->setScreenSize(width() / 2, height() / 2);
-        glViewport(0, 0, width() / 2, height() / 2);
-        _camera->setView(GLCamera::ViewProjection::TOP_VIEW);
-        _projectionMatrix = _camera->getProjectionMatrix();
-        _viewMatrix = _camera->getViewMatrix();
-        _textRenderer->RenderText("Top", width() - 150, 4, 1.5, glm::vec3(1.0f, 1.0f, 0.0f));
-        render();
-
-        // Front View
-        _projectionMatrix.setToIdentity();
-        _viewMatrix.setToIdentity();
-        _modelMatrix.setToIdentity();
-        glViewport(0, height() / 2, width() / 2, height() / 2);
-        _camera->setView(GLCamera::ViewProjection::FRONT_VIEW);
-        _projectionMatrix = _camera->getProjectionMatrix();
-        _viewMatrix = _camera->getViewMatrix();
-        _textRenderer->RenderText("Front", width()-150, 4, 1.5, glm::vec3(1.0f, 1.0f, 0.0f));
-        render();
-
-        // Left View
-        _projectionMatrix.setToIdentity();
-        _viewMatrix.setToIdentity();
-        _modelMatrix.setToIdentity();
-        glViewport(width() / 2, height() / 2, width() / 2, height() / 2);
-        _camera->setView(GLCamera::ViewProjection::LEFT_VIEW);
-        _projectionMatrix = _camera->getProjectionMatrix();
-        _viewMatrix = _camera->getViewMatrix();
-        _textRenderer->RenderText("Left", width() - 150, 4, 1.5, glm::vec3(1.0f, 1.0f, 0.0f));
-        render();
-
-        // Isometric View
-        _projectionMatrix.setToIdentity();
-        _viewMatrix.setToIdentity();
-        _modelMatrix.setToIdentity();
-        glViewport(width()/2, 0, width() / 2, height()/2);
-        _camera->setView(GLCamera::ViewProjection::SE_ISOMETRIC_VIEW);
-        _projectionMatrix = _camera->getProjectionMatrix();
-        _viewMatrix = _camera->getViewMatrix();
-        _textRenderer->RenderText("Isometric", width() - 150, 4, 1.5, glm::vec3(1.0f, 1.0f, 0.0f));
-        render();
-
-        // draw screen partitioning lines
-        splitScreen();
+        // Quadrants are redrawn into their cache only when their view or the scene changed
+        renderMultiView();
     }
-    else
+    else if (_renderThread)
     {
-        QMatrix4x4 projection;
-        projection.ortho(QRect(0.0f, 0.0f, static_cast<float>(width()), static_cast<float>(height())));
-        _textShader.bind();
-        _textShader.setUniformValue("projection", projection);
-        _textShader.release();
-        render();
+        // Nothing the render thread draws changed, only show its latest frame again
+        if (dirty & ~DirtyFrame)
+            postRenderState();
+        GpuProfiler::Scope scope(_gpuProfiler, "Composite");
+        compositeRenderedFrame();
     }
+    else
+    {
+        // While dragging draw at a reduced resolution and upscale, the release
+        // marks everything dirty so the next frame is drawn at full resolution
+        bool scaled = isInteracting();
+        if (scaled)
+            beginScaledFrame();
+        _lastFrameScaled = scaled;
 
+        {
+            GpuProfiler::Scope scope(_gpuProfiler, "Background");
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    // Display Harmonics Editor
-    if (dynamic_cast<SphericalHarmonic*>(_meshStore.at(_modelNum - 1)))
-        _sphericalHarmonicsEditor->show();
-    else
-        _sphericalHarmonicsEditor->hide();
+            gradientBackground(0.3f, 0.3f, 0.3f, 1.0f,
+                               0.925f, 0.913f, 0.847f, 1.0f);
+        }
 
-    // Display Gray's Klein Editor
-    if (dynamic_cast<GraysKlein*>(_meshStore.at(_modelNum - 1)))
-        _graysKleinEditor->show();
-    else
-        _graysKleinEditor->hide();
+        {
+            GpuProfiler::Scope scope(_gpuProfiler, "Model");
+            setViewport(0, 0, width(), height());
+            _viewMatrix = _camera->getViewMatrix();
+            render();
+        }
 
-    // Display Super Toroid Editor
-    if (dynamic_cast<SuperToroid*>(_meshStore.at(_modelNum - 1)))
-        _superToroidEditor->show();
-    else
-        _superToroidEditor->hide();
+        if (scaled)
+        {
+            GpuProfiler::Scope scope(_gpuProfiler, "Upscale");
+            endScaledFrame();
+        }
+    }
 
-    // Display Super Ellipsoid Editor
-    if (dynamic_cast<SuperEllipsoid*>(_meshStore.at(_modelNum - 1)))
-        _superEllipsoidEditor->show();
-    else
-        _superEllipsoidEditor->hide();
+    // Text rendering
+    {
+        GpuProfiler::Scope scope(_gpuProfiler, "Text");
+        setViewport(0, 0, width(), height());
+        _textRenderer->RenderText(_meshStore.at(_modelNum - 1)->getName().toStdString(), 4, 4, 1, glm::vec3(1.0f, 1.0f, 0.0f));
 
-    // Display Spring Editor
-    if (dynamic_cast<Spring*>(_meshStore.at(_modelNum - 1)))
-        _springEditor->show();
-    else
-        _springEditor->hide();
+        if (_bMultiView)
+        {
+            const char* titles[4] = { "Top", "Front", "Left", "Isometric" };
+            for (int i = 0; i < 4; i++)
+            {
+                const QRect& viewport = _quadrants[i].viewport;
+                setViewport(viewport.x(), viewport.y(), viewport.width(), viewport.height());
+                _textRenderer->RenderText(titles[i], width() - 150, 4, 1.5, glm::vec3(1.0f, 1.0f, 0.0f));
+            }
+        }
+    }
+
+    if (_bMultiView)
+    {
+        // draw screen partitioning lines
+        GpuProfiler::Scope scope(_gpuProfiler, "Split lines");
+        splitScreen();
+    }
+
+    if (_gpuProfiler->isEnabled())
+    {
+        GpuProfiler::Scope scope(_gpuProfiler, "Profiler");
+        renderGpuProfiler();
+    }
+    _gpuProfiler->endFrame();
 }
 
-void GLView::render()
+void GLView::render(const QSize& labelViewport)
 {
+    TRACE_SCOPE("GLView::render");
     glEnable(GL_DEPTH_TEST);    
 
-    _viewMatrix.setToIdentity();
-    _viewMatrix = _camera->getViewMatrix();
-
     /*_modelMatrix.translate(QVector3D(_xTran, _yTran, _zTran));
     _modelMatrix.rotate(_xRot, 1, 0, 0);
     _modelMatrix.rotate(_yRot, 0, 1, 0);
@@ -706,13 +866,11 @@ void GLView::render()
         _fgShader->setUniformValue("b_SectionActive", false);
     }
 
-    QVector3D pos = _camera->getPosition();
-    _fgShader->setUniformValue("clipPlaneX", QVector4D(_modelViewMatrix * (QVector3D(_clipXFlipped ? -1 : 1, 0, 0) + pos),
-                                                       (_clipXFlipped ? -1 : 1)*pos.x() + _clipXCoeff));
-    _fgShader->setUniformValue("clipPlaneY", QVector4D(_modelViewMatrix * (QVector3D(0, _clipYFlipped ? -1 : 1, 0) + pos),
-                                                       (_clipYFlipped ? -1 : 1)*pos.y() + _clipYCoeff));
-    _fgShader->setUniformValue("clipPlaneZ", QVector4D(_modelViewMatrix * (QVector3D(0, 0, _clipZFlipped ? -1 : 1) + pos),
-                                                       (_clipZFlipped ? -1 : 1)*pos.z() + _clipZCoeff));
+    QVector4D clipPlanes[3];
+    computeClipPlanes(_modelViewMatrix, clipPlanes);
+    _fgShader->setUniformValue("clipPlaneX", clipPlanes[0]);
+    _fgShader->setUniformValue("clipPlaneY", clipPlanes[1]);
+    _fgShader->setUniformValue("clipPlaneZ", clipPlanes[2]);
 
 
     // Render
@@ -726,8 +884,568 @@ void GLView::render()
     glDisable(GL_CLIP_DISTANCE2);
 
     _fgShader->release();
+
+    // World space annotations over the model
+    if (_textRenderer->HasLabels())
+    {
+        QSize viewportSize = labelViewport.isValid() ? labelViewport :
+                             _bMultiView ? QSize(width() / 2, height() / 2) : size();
+        _textRenderer->RenderLabels(_projectionMatrix * _modelViewMatrix, viewportSize.width(), viewportSize.height());
+    }
+}
+
+
+void GLView::computeClipPlanes(const QMatrix4x4& modelView, QVector4D planes[3])
+{
+    QVector3D pos = _camera->getPosition();
+    planes[0] = QVector4D(modelView * (QVector3D(_clipXFlipped ? -1 : 1, 0, 0) + pos),
+                          (_clipXFlipped ? -1 : 1)*pos.x() + _clipXCoeff);
+    planes[1] = QVector4D(modelView * (QVector3D(0, _clipYFlipped ? -1 : 1, 0) + pos),
+                          (_clipYFlipped ? -1 : 1)*pos.y() + _clipYCoeff);
+    planes[2] = QVector4D(modelView * (QVector3D(0, 0, _clipZFlipped ? -1 : 1) + pos),
+                          (_clipZFlipped ? -1 : 1)*pos.z() + _clipZCoeff);
+}
+
+void GLView::captureState(RenderState& state)
+{
+    TriangleMesh* mesh = _meshStore.at(_modelNum - 1);
+    // The render thread draws at the resolution of the widget framebuffer
+    QSize pixels = framebufferSize();
+    state.width = pixels.width();
+    state.height = pixels.height();
+    state.modelIndex = _modelNum - 1;
+    state.geometryGeneration = mesh->generation();
+    state.indexCount = mesh->indexCount();
+    state.primitiveType = mesh->primitiveType();
+
+    state.projectionMatrix = _projectionMatrix;
+    state.modelViewMatrix = _camera->getViewMatrix() * _modelMatrix;
+
+    state.ambiLight = _ambiLight;
+    state.diffLight = _diffLight;
+    state.specLight = _specLight;
+    state.lightPosition = _lightPosition;
+
+    state.ambiMat = _ambiMat;
+    state.diffMat = _diffMat;
+    state.specMat = _specMat;
+    state.emmiMat = _emmiMat;
+    state.opacity = _opacity;
+    state.shine = _shine;
+
+    state.hasTexture = _bHasTexture;
+    state.texture = _texture;
+    state.shaded = _bShaded;
+
+    state.clipEnabled[0] = _clipXEnabled;
+    state.clipEnabled[1] = _clipYEnabled;
+    state.clipEnabled[2] = _clipZEnabled;
+    computeClipPlanes(state.modelViewMatrix, state.clipPlanes);
+}
+
+void GLView::postRenderState()
+{
+    RenderState state;
+    captureState(state);
+
+    // Buffers (re)filled in this context have to be complete before the render
+    // thread context reads them
+    if (state.modelIndex != _postedModel || state.geometryGeneration != _postedGeneration)
+    {
+        glFinish();
+        _postedModel = state.modelIndex;
+        _postedGeneration = state.geometryGeneration;
+    }
+    _renderThread->postState(state);
+}
+
+void GLView::compositeRenderedFrame()
+{
+    setViewport(0, 0, width(), height());
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    RenderThread::Frame frame;
+    if (!_renderThread->acquireFrame(frame))
+    {
+        // First frame still in flight
+        gradientBackground(0.3f, 0.3f, 0.3f, 1.0f,
+                           0.925f, 0.913f, 0.847f, 1.0f);
+        return;
+    }
+
+    if (frame.ready)
+    {
+        glWaitSync(frame.ready, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(frame.ready);
+    }
+    compositeTexture(frame.texture, 1.0f, 1.0f);
+
+    // The render thread reuses the frame once these reads completed
+    _renderThread->releaseFrame(frame.index, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    glFlush();
+
+    // Labels have no depth to test against here, they are drawn over the frame
+    if (_textRenderer->HasLabels())
+        _textRenderer->RenderLabels(_projectionMatrix * _camera->getViewMatrix() * _modelMatrix, width(), height());
+}
+
+void GLView::scheduleComposite()
+{
+    markDirty(DirtyFrame);
+}
+
+// Largest snapshot drawn in one pass, 64 MB of pixels, and the tile size beyond it
+static const int SNAPSHOT_MAX_SIZE = 4096;
+static const int SNAPSHOT_TILE_SIZE = 1024;
+
+bool GLView::saveSnapshot(const QString& fileName, QSize size)
+{
+    if (!size.isValid())
+        size = this->size();
+
+    makeCurrent();
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxSize);
+
+    // Posters are streamed by PosterWriter, which only writes PNG
+    int singleSize = qMin(maxSize, SNAPSHOT_MAX_SIZE);
+    bool tiled = size.width() > singleSize || size.height() > singleSize;
+    if (tiled && QFileInfo(fileName).suffix().compare("png", Qt::CaseInsensitive) != 0)
+    {
+        cout << "Snapshots larger than " << singleSize << " pixels are saved as PNG, "
+             << fileName.toStdString() << " needs a .png suffix" << endl;
+        doneCurrent();
+        return false;
+    }
+
+    // Drawn with the widget camera in a target of the snapshot size
+    updateProjection(size.width(), size.height());
+    QMatrix4x4 viewportMatrix = _viewportMatrix;
+    _modelMatrix.setToIdentity();
+    _viewMatrix = _camera->getViewMatrix();
+
+    bool saved = true;
+    if (!tiled)
+        startSnapshot(fileName, size);
+    else if ((saved = saveTiledSnapshot(fileName, size, qMin(maxSize, SNAPSHOT_TILE_SIZE))))
+        cout << "Saved " << size.width() << "x" << size.height() << " snapshot " << fileName.toStdString() << endl;
+
+    updateProjection(width(), height());
+    _viewportMatrix = viewportMatrix;
+    glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+    doneCurrent();
+    return saved;
+}
+
+void GLView::renderSnapshotTile(const QSize& size, const QRect& tile)
+{
+    GLfloat w = static_cast<GLfloat>(tile.width());
+    GLfloat h = static_cast<GLfloat>(tile.height());
+
+    // Part of the window gradient behind the tile
+    QVector4D topColor(0.3f, 0.3f, 0.3f, 1.0f);
+    QVector4D botColor(0.925f, 0.913f, 0.847f, 1.0f);
+    QVector4D tileTop = botColor + (topColor - botColor) * ((tile.y() + h) / size.height());
+    QVector4D tileBot = botColor + (topColor - botColor) * (tile.y() / static_cast<GLfloat>(size.height()));
+
+    glViewport(0, 0, tile.width(), tile.height());
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    gradientBackground(tileTop.x(), tileTop.y(), tileTop.z(), tileTop.w(),
+                       tileBot.x(), tileBot.y(), tileBot.z(), tileBot.w());
+
+    // Scale and shift the tile part of the clip volume onto the whole target,
+    // the projection of the full image stays unchanged
+    QMatrix4x4 crop;
+    crop(0, 0) = size.width() / w;
+    crop(0, 3) = (size.width() - 2.0f * tile.x() - w) / w;
+    crop(1, 1) = size.height() / h;
+    crop(1, 3) = (size.height() - 2.0f * tile.y() - h) / h;
+
+    QMatrix4x4 projectionMatrix = _projectionMatrix;
+    _projectionMatrix = crop * projectionMatrix;
+    _viewportMatrix = QMatrix4x4(w/2, 0.0f, 0.0f, 0.0f,
+                                 0.0f, h/2, 0.0f, 0.0f,
+                                 0.0f, 0.0f, 1.0f, 0.0f,
+                                 w/2 + 0, h/2 + 0, 0.0f, 1.0f);
+    render(tile.size());
+    _projectionMatrix = projectionMatrix;
+}
+
+void GLView::startSnapshot(const QString& fileName, const QSize& size)
+{
+    QOpenGLFramebufferObjectFormat targetFormat;
+    targetFormat.setAttachment(QOpenGLFramebufferObject::Depth);
+    targetFormat.setSamples(format().samples());
+    QOpenGLFramebufferObject target(size, targetFormat);
+    QOpenGLFramebufferObject resolved(size);
+
+    target.bind();
+    renderSnapshotTile(size, QRect(QPoint(0, 0), size));
+    QOpenGLFramebufferObject::blitFramebuffer(&resolved, &target);
+
+    // Returns at once, the copy completes while the following frames are drawn
+    PendingSnapshot snapshot;
+    snapshot.size = size;
+    snapshot.fileName = fileName;
+    glGenBuffers(1, &snapshot.pbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, snapshot.pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size.width()) * size.height() * 4, nullptr, GL_STREAM_READ);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, resolved.handle());
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, size.width(), size.height(), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    snapshot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+
+    _pendingSnapshots.push_back(snapshot);
+    if (_pendingSnapshots.size() == 1)
+        QTimer::singleShot(0, this, SLOT(pollSnapshots()));
 }
 
+void GLView::pollSnapshots()
+{
+    makeCurrent();
+    for (auto it = _pendingSnapshots.begin(); it != _pendingSnapshots.end();)
+    {
+        // Only look, never wait for the GPU here
+        GLenum status = glClientWaitSync(it->fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED)
+        {
+            ++it;
+            continue;
+        }
+        finishSnapshot(*it);
+        it = _pendingSnapshots.erase(it);
+    }
+    doneCurrent();
+
+    if (!_pendingSnapshots.empty())
+        QTimer::singleShot(5, this, SLOT(pollSnapshots()));
+}
+
+void GLView::finishSnapshot(PendingSnapshot& snapshot)
+{
+    glClientWaitSync(snapshot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    glDeleteSync(snapshot.fence);
+    snapshot.fence = 0;
+
+    QImage image(snapshot.size, QImage::Format_RGBA8888);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, snapshot.pbo);
+    const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, image.sizeInBytes(), GL_MAP_READ_BIT);
+    if (pixels)
+    {
+        memcpy(image.bits(), pixels, image.sizeInBytes());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        _snapshotWriters.start(new SnapshotWriter(image, snapshot.fileName));
+    }
+    else
+    {
+        cout << "Could not read back " << snapshot.fileName.toStdString() << endl;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glDeleteBuffers(1, &snapshot.pbo);
+    snapshot.pbo = 0;
+}
+
+bool GLView::saveTiledSnapshot(const QString& fileName, const QSize& size, int tileSize)
+{
+    PosterWriter writer;
+    if (!writer.open(fileName, size))
+        return false;
+
+    QOpenGLFramebufferObjectFormat targetFormat;
+    targetFormat.setAttachment(QOpenGLFramebufferObject::Depth);
+    targetFormat.setSamples(format().samples());
+    QOpenGLFramebufferObject target(tileSize, tileSize, targetFormat);
+    QOpenGLFramebufferObject resolved(tileSize, tileSize);
+
+    // Two pixel buffers, one tile is read while the next is drawn
+    struct TileRead
+    {
+        GLuint pbo;
+        GLsync fence;
+        QRect tile;
+    };
+    TileRead reads[2];
+    for (TileRead& read : reads)
+    {
+        glGenBuffers(1, &read.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, read.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(tileSize) * tileSize * 4, nullptr, GL_STREAM_READ);
+        read.fence = 0;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // Copies a finished read into its place in the band
+    auto copyTile = [this](TileRead& read, QImage& band) {
+        glClientWaitSync(read.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        glDeleteSync(read.fence);
+        read.fence = 0;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, read.pbo);
+        int rowBytes = read.tile.width() * 4;
+        const uchar* pixels = static_cast<const uchar*>(
+            glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(rowBytes) * read.tile.height(), GL_MAP_READ_BIT));
+        if (pixels)
+        {
+            for (int y = 0; y < read.tile.height(); y++)
+                memcpy(band.scanLine(y) + read.tile.x() * 4, pixels + y * rowBytes, rowBytes);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    };
+
+    // Bands of one tile row from the top, the order PNG stores its rows in. Only
+    // the band being filled and the few the writer holds are in memory.
+    int next = 0;
+    for (int top = size.height(); top > 0; top -= tileSize)
+    {
+        int bandHeight = qMin(tileSize, top);
+        QImage band(size.width(), bandHeight, QImage::Format_RGBA8888);
+        for (int x = 0; x < size.width(); x += tileSize)
+        {
+            QRect tile(x, top - bandHeight, qMin(tileSize, size.width() - x), bandHeight);
+            target.bind();
+            renderSnapshotTile(size, tile);
+            QRect area(QPoint(0, 0), tile.size());
+            QOpenGLFramebufferObject::blitFramebuffer(&resolved, area, &target, area);
+
+            TileRead& read = reads[next];
+            next = 1 - next;
+            if (read.fence)
+                copyTile(read, band);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, read.pbo);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, resolved.handle());
+            glPixelStorei(GL_PACK_ALIGNMENT, 4);
+            glReadPixels(0, 0, tile.width(), tile.height(), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            read.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            read.tile = QRect(tile.x(), 0, tile.width(), tile.height());
+        }
+
+        // The band is complete once its last reads are
+        for (int i = 0; i < 2; i++)
+        {
+            TileRead& read = reads[(next + i) % 2];
+            if (read.fence)
+                copyTile(read, band);
+        }
+        writer.addBand(band);
+    }
+
+    for (TileRead& read : reads)
+        glDeleteBuffers(1, &read.pbo);
+    return writer.finish();
+}
+
+void GLView::updateQuadrants()
+{
+    _quadrants[0].viewport = QRect(0, 0, width() / 2, height() / 2);
+    _quadrants[1].viewport = QRect(0, height() / 2, width() / 2, height() / 2);
+    _quadrants[2].viewport = QRect(width() / 2, height() / 2, width() / 2, height() / 2);
+    _quadrants[3].viewport = QRect(width() / 2, 0, width() / 2, height() / 2);
+
+    // The orthographic quadrants look along fixed directions, the isometric one
+    // follows the interactive camera so it can be orbited. All share its zoom and pan.
+    GLCamera camera = *_camera;
+    camera.setScreenSize(width() / 2, height() / 2);
+    _quadrants[3].projectionMatrix = camera.getProjectionMatrix();
+    _quadrants[3].viewMatrix = camera.getViewMatrix();
+
+    const GLCamera::ViewProjection views[3] = {
+        GLCamera::ViewProjection::TOP_VIEW,
+        GLCamera::ViewProjection::FRONT_VIEW,
+        GLCamera::ViewProjection::LEFT_VIEW
+    };
+    for (int i = 0; i < 3; i++)
+    {
+        camera.setView(views[i]);
+        _quadrants[i].projectionMatrix = camera.getProjectionMatrix();
+        _quadrants[i].viewMatrix = camera.getViewMatrix();
+    }
+}
+
+void GLView::renderMultiView()
+{
+    updateQuadrants();
+
+    // Multisampled cache of the four quadrants and its resolved copy, drawn to the widget
+    QSize pixels = framebufferSize();
+    if (!_multiViewCache || _multiViewCache->size() != pixels)
+    {
+        if (_multiViewCache)
+            delete _multiViewCache;
+        if (_multiViewResolved)
+            delete _multiViewResolved;
+        QOpenGLFramebufferObjectFormat cacheFormat;
+        cacheFormat.setAttachment(QOpenGLFramebufferObject::Depth);
+        cacheFormat.setSamples(format().samples());
+        _multiViewCache = new QOpenGLFramebufferObject(pixels, cacheFormat);
+        _multiViewResolved = new QOpenGLFramebufferObject(pixels);
+        for (ViewQuadrant& quadrant : _quadrants)
+            quadrant.cached = false;
+    }
+
+    std::vector<int> stale;
+    for (int i = 0; i < 4; i++)
+    {
+        const ViewQuadrant& quadrant = _quadrants[i];
+        if (!quadrant.cached || quadrant.cachedScene != _sceneVersion ||
+            quadrant.cachedProjection != quadrant.projectionMatrix || quadrant.cachedView != quadrant.viewMatrix)
+            stale.push_back(i);
+    }
+
+    if (!stale.empty())
+    {
+        _multiViewCache->bind();
+
+        // Background of the stale quadrants, a part of the full window gradient each
+        _gpuProfiler->beginScope("Background");
+        glEnable(GL_SCISSOR_TEST);
+        setViewport(0, 0, width(), height());
+        for (int i : stale)
+        {
+            QRect viewport = framePixels(_quadrants[i].viewport);
+            glScissor(viewport.x(), viewport.y(), viewport.width(), viewport.height());
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            gradientBackground(0.3f, 0.3f, 0.3f, 1.0f,
+                               0.925f, 0.913f, 0.847f, 1.0f);
+        }
+        glDisable(GL_SCISSOR_TEST);
+        _gpuProfiler->endScope();
+
+        if (_bViewportArrays)
+        {
+            // All stale views in one instanced draw
+            GpuProfiler::Scope scope(_gpuProfiler, "Model");
+            renderQuadrantsInstanced(stale);
+        }
+        else
+        {
+            const char* scopes[4] = { "Model top", "Model front", "Model left", "Model isometric" };
+            for (int i : stale)
+            {
+                GpuProfiler::Scope scope(_gpuProfiler, scopes[i]);
+                const QRect& viewport = _quadrants[i].viewport;
+                setViewport(viewport.x(), viewport.y(), viewport.width(), viewport.height());
+                _projectionMatrix = _quadrants[i].projectionMatrix;
+                _viewMatrix = _quadrants[i].viewMatrix;
+                render();
+            }
+        }
+
+        // Resolve only what was redrawn
+        GpuProfiler::Scope scope(_gpuProfiler, "Resolve");
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, _multiViewCache->handle());
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _multiViewResolved->handle());
+        for (int i : stale)
+        {
+            QRect viewport = framePixels(_quadrants[i].viewport);
+            glBlitFramebuffer(viewport.x(), viewport.y(), viewport.right() + 1, viewport.bottom() + 1,
+                              viewport.x(), viewport.y(), viewport.right() + 1, viewport.bottom() + 1,
+                              GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+            ViewQuadrant& quadrant = _quadrants[i];
+            quadrant.cachedProjection = quadrant.projectionMatrix;
+            quadrant.cachedView = quadrant.viewMatrix;
+            quadrant.cachedScene = _sceneVersion;
+            quadrant.cached = true;
+        }
+    }
+
+    // Input maps through the isometric quadrant, as the last one drawn before caching
+    _projectionMatrix = _quadrants[3].projectionMatrix;
+    _viewMatrix = _quadrants[3].viewMatrix;
+    _modelViewMatrix = _viewMatrix * _modelMatrix;
+
+    GpuProfiler::Scope scope(_gpuProfiler, "Composite");
+    glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+    setViewport(0, 0, width(), height());
+    compositeTexture(_multiViewResolved->texture(), 1.0f, 1.0f);
+}
+
+void GLView::renderQuadrantsInstanced(const std::vector<int>& quadrants)
+{
+    // std140 layout of the View struct in twoside_multiview.vert
+    struct ViewUniforms
+    {
+        GLfloat modelViewMatrix[16];
+        GLfloat projectionMatrix[16];
+        GLfloat normalMatrix[16];
+        GLfloat clipPlanes[3][4];
+    };
+    ViewUniforms uniforms[4];
+
+    GLuint count = 0;
+    for (int i : quadrants)
+    {
+        const ViewQuadrant& quadrant = _quadrants[i];
+        QMatrix4x4 modelView = quadrant.viewMatrix * _modelMatrix;
+
+        QVector4D clipPlanes[3];
+        computeClipPlanes(modelView, clipPlanes);
+
+        std::memcpy(uniforms[count].modelViewMatrix, modelView.constData(), sizeof(uniforms[count].modelViewMatrix));
+        std::memcpy(uniforms[count].projectionMatrix, quadrant.projectionMatrix.constData(), sizeof(uniforms[count].projectionMatrix));
+        std::memcpy(uniforms[count].normalMatrix, QMatrix4x4(modelView.normalMatrix()).constData(), sizeof(uniforms[count].normalMatrix));
+        for (int j = 0; j < 3; j++)
+        {
+            uniforms[count].clipPlanes[j][0] = clipPlanes[j].x();
+            uniforms[count].clipPlanes[j][1] = clipPlanes[j].y();
+            uniforms[count].clipPlanes[j][2] = clipPlanes[j].z();
+            uniforms[count].clipPlanes[j][3] = clipPlanes[j].w();
+        }
+
+        // Instance n goes to viewport n
+        QRect viewport = framePixels(quadrant.viewport);
+        glViewportIndexedf(count, viewport.x(), viewport.y(), viewport.width(), viewport.height());
+        count++;
+    }
+    glNamedBufferSubData(_viewsUBO, 0, count * sizeof(ViewUniforms), uniforms);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, _viewsUBO);
+
+    glEnable(GL_DEPTH_TEST);
+
+    _multiViewShader.bind();
+    _multiViewShader.setUniformValue("b_wireframe", !_bShaded);
+    _multiViewShader.setUniformValue("b_SectionActive", _clipXEnabled || _clipYEnabled || _clipZEnabled);
+
+    glPolygonMode(GL_FRONT_AND_BACK, _bShaded ? GL_FILL : GL_LINE);
+    glLineWidth(_bShaded ? 1.0 : 1.5);
+
+    // Clipping Planes
+    if (_clipXEnabled)
+        glEnable(GL_CLIP_DISTANCE0);
+    if (_clipYEnabled)
+        glEnable(GL_CLIP_DISTANCE1);
+    if (_clipZEnabled)
+        glEnable(GL_CLIP_DISTANCE2);
+
+    // Render
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _texture);
+    _multiViewShader.setUniformValue("texUnit", 0);
+    _meshStore.at(_modelNum - 1)->renderInstanced(count);
+
+    glDisable(GL_CLIP_DISTANCE0);
+    glDisable(GL_CLIP_DISTANCE1);
+    glDisable(GL_CLIP_DISTANCE2);
+
+    _multiViewShader.release();
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, 0);
+
+    // World space annotations, per quadrant
+    if (_textRenderer->HasLabels())
+    {
+        for (int i : quadrants)
+        {
+            const ViewQuadrant& quadrant = _quadrants[i];
+            setViewport(quadrant.viewport.x(), quadrant.viewport.y(), quadrant.viewport.width(), quadrant.viewport.height());
+            _textRenderer->RenderLabels(quadrant.projectionMatrix * quadrant.viewMatrix * _modelMatrix,
+                                        quadrant.viewport.width(), quadrant.viewport.height());
+        }
+    }
+}
 
 void GLView::mousePressEvent(QMouseEvent* e)
 {
@@ -769,6 +1487,10 @@ void GLView::mousePressEvent(QMouseEvent* e)
 
 void GLView::mouseReleaseEvent(QMouseEvent* e)
 {
+    // Redraw the reduced resolution frame at full resolution
+    if (_lastFrameScaled)
+        markDirty(DirtyAll);
+
     setCursor(QCursor(Qt::ArrowCursor));
     if (e->button() & Qt::LeftButton)
     {
@@ -793,7 +1515,8 @@ void GLView::mouseReleaseEvent(QMouseEvent* e)
 
 void GLView::mouseMoveEvent(QMouseEvent* e)
 {
-    _animateViewTimer->stop();
+    if (_animation == Animation::VIEW_CHANGE)
+        stopAnimation();
 
     QPoint downPoint(e->x(), e->y());
     if (_bLeftButtonDown)
@@ -805,58 +1528,33 @@ void GLView::mouseMoveEvent(QMouseEvent* e)
         }
         else
         {
-            QPoint rotate = _leftButtonPoint - downPoint;
-
-            _camera->rotateX(rotate.y() / 2.0);
-            _camera->rotateY(rotate.x() / 2.0);
-            _currentRotation = QQuaternion::fromRotationMatrix(_camera->getViewMatrix().toGenericMatrix<3, 3>());
+            _pendingRotation += _leftButtonPoint - downPoint;
             _leftButtonPoint = downPoint;
+            queueInput();
         }
     }
 
     if (_bRightButtonDown)
     {
-        //QPoint translate = downPoint - _rightButtonPoint;
-
-        QVector3D Z(0, 0, 0); // instead of 0 for x and y we need worldPosition.x() and worldPosition.y() ....
-        Z = Z.project(_viewMatrix * _modelMatrix, _projectionMatrix, QRect(0, 0, width(), height()));
-        QVector3D p1(downPoint.x(), height() - downPoint.y(), Z.z());
-        QVector3D O = p1.unproject(_viewMatrix * _modelMatrix, _projectionMatrix, QRect(0, 0, width(), height()));
-        QVector3D p2(_rightButtonPoint.x(), height() - _rightButtonPoint.y(), Z.z());
-        QVector3D P = p2.unproject(_viewMatrix * _modelMatrix, _projectionMatrix, QRect(0, 0, width(), height()));
-        QVector3D OP = P - O;
-        _camera->move(OP.x(), OP.y(), OP.z());
-        _currentTranslation = _camera->getPosition();
-
+        _pendingPan += _rightButtonPoint - downPoint;
         _rightButtonPoint = downPoint;
+        queueInput();
     }
 
     if (_bMiddleButtonDown)
     {
         //QPoint zoom = downPoint - _middleButtonPoint;
 
-        if (downPoint.x() > _middleButtonPoint.x() || downPoint.y() < _middleButtonPoint.y())
-            _viewRange /= 1.05f;
-        else
-            _viewRange *= 1.05f;
-        if (_viewRange < 0.05) _viewRange = 0.05f;
-        if (_viewRange > 50000.0) _viewRange = 50000.0f;
-        _currentViewRange = _viewRange;
+        bool zoomIn = downPoint.x() > _middleButtonPoint.x() || downPoint.y() < _middleButtonPoint.y();
 
         // Translate to focus on mouse center
         QPoint cen = getClientRectFromPoint(downPoint).center();
-        float sign = (downPoint.x() > _middleButtonPoint.x() || downPoint.y() < _middleButtonPoint.y()) ? 1.0f : -1.0f;
-        QVector3D OP = get3dTranslationVectorFromMousePoints(cen, _middleButtonPoint);
-        OP *= sign * 0.05f;
-        _camera->move(OP.x(), OP.y(), OP.z());
-        _currentTranslation = _camera->getPosition();
-
-        resizeGL(width(), height());
+        float sign = zoomIn ? 1.0f : -1.0f;
+        _pendingZooms.push_back({ zoomIn ? 1.0f / 1.05f : 1.05f, cen, QPointF(_middleButtonPoint - cen) * (sign * 0.05f) });
 
         _middleButtonPoint = downPoint;
+        queueInput();
     }
-
-    update();
 }
 
 void GLView::wheelEvent(QWheelEvent* e)
@@ -876,27 +1574,92 @@ void GLView::wheelEvent(QWheelEvent* e)
     float zoomStep = numSteps.y();
     float zoomFactor = abs(zoomStep) + 0.05;
 
-    if (zoomStep < 0)
-        _viewRange *= zoomFactor;
-    else
-        _viewRange /= zoomFactor;
-
-    if (_viewRange < 0.05) _viewRange = 0.05f;
-    if (_viewRange > 50000.0) _viewRange = 50000.0f;
-    _currentViewRange = _viewRange;
-
     // Translate to focus on mouse center
     QPoint cen = getClientRectFromPoint(e->position().toPoint()).center();
     float sign = (e->position().x() > cen.x() || e->position().y() < cen.y() ||
         (e->position().x() < cen.x() && e->position().y() > cen.y())) && (zoomStep > 0) ? 1.0f : -1.0f;
-    QVector3D OP = get3dTranslationVectorFromMousePoints(cen, e->position().toPoint());
-    OP *= sign * 0.05f;
-    _camera->move(OP.x(), OP.y(), OP.z());
+    _pendingZooms.push_back({ zoomStep < 0 ? zoomFactor : 1.0f / zoomFactor, cen, (e->position() - QPointF(cen)) * (sign * 0.05f) });
+
+    queueInput();
+}
+
+void GLView::queueInput()
+{
+    if (_pendingInputTime < 0)
+        _pendingInputTime = _inputClock.nsecsElapsed();
+    _pendingEvents++;
+    markDirty(DirtyCamera);
+}
+
+void GLView::applyPendingInput()
+{
+    if (_pendingEvents == 0)
+        return;
+
+    // Rotate
+    if (!_pendingRotation.isNull())
+    {
+        _camera->rotateX(_pendingRotation.y() / 2.0);
+        _camera->rotateY(_pendingRotation.x() / 2.0);
+        _currentRotation = QQuaternion::fromRotationMatrix(_camera->getViewMatrix().toGenericMatrix<3, 3>());
+    }
+
+    // Pan, the unprojection at a fixed depth is affine so the summed drag maps in one step
+    if (!_pendingPan.isNull())
+    {
+        QVector3D Z(0, 0, 0); // instead of 0 for x and y we need worldPosition.x() and worldPosition.y() ....
+        Z = Z.project(_viewMatrix * _modelMatrix, _projectionMatrix, QRect(0, 0, width(), height()));
+        QPoint cen = rect().center();
+        QVector3D p1(cen.x(), height() - cen.y(), Z.z());
+        QVector3D O = p1.unproject(_viewMatrix * _modelMatrix, _projectionMatrix, QRect(0, 0, width(), height()));
+        QVector3D p2(cen.x() + _pendingPan.x(), height() - (cen.y() + _pendingPan.y()), Z.z());
+        QVector3D P = p2.unproject(_viewMatrix * _modelMatrix, _projectionMatrix, QRect(0, 0, width(), height()));
+        QVector3D OP = P - O;
+        _camera->move(OP.x(), OP.y(), OP.z());
+    }
+
+    // Zoom, in the order of the events as the shifts depend on the range before each
+    for (const ZoomStep& step : _pendingZooms)
+    {
+        _viewRange *= step.factor;
+        if (_viewRange < 0.05) _viewRange = 0.05f;
+        if (_viewRange > 50000.0) _viewRange = 50000.0f;
+        _currentViewRange = _viewRange;
+
+        QVector3D OP = get3dTranslationVectorFromMousePoints(step.anchor, step.anchor + step.shift);
+        _camera->move(OP.x(), OP.y(), OP.z());
+
+        updateProjection(width(), height());
+    }
     _currentTranslation = _camera->getPosition();
 
-    resizeGL(width(), height());
+    // The frame drawn now carries the oldest of the coalesced events
+    if (_frameInputTime < 0)
+    {
+        _frameInputTime = _pendingInputTime;
+        _frameInputEvents = 0;
+    }
+    _frameInputEvents += _pendingEvents;
 
-    update();
+    _pendingRotation = QPoint();
+    _pendingPan = QPoint();
+    _pendingZooms.clear();
+    _pendingEvents = 0;
+    _pendingInputTime = -1;
+}
+
+void GLView::recordInputLatency()
+{
+    if (_frameInputTime < 0)
+        return;
+
+    double latency = (_inputClock.nsecsElapsed() - _frameInputTime) / 1.0e6;
+    _inputLatency.lastMs = latency;
+    _inputLatency.averageMs = _inputLatency.averageMs > 0.0 ? _inputLatency.averageMs * 0.9 + latency * 0.1 : latency;
+    _inputLatency.maxMs = qMax(_inputLatency.maxMs, latency);
+    _inputLatency.eventsPerFrame = _frameInputEvents;
+
+    _frameInputTime = -1;
 }
 
 QRect GLView::getViewportFromPoint(const QPoint& pixel)
@@ -953,71 +1716,142 @@ QRect GLView::getClientRectFromPoint(const QPoint& pixel)
     return clientRect;
 }
 
-QVector3D GLView::get3dTranslationVectorFromMousePoints(const QPoint& start, const QPoint& end)
+QVector3D GLView::get3dTranslationVectorFromMousePoints(const QPointF& start, const QPointF& end)
 {
+    QRect viewport = getViewportFromPoint(start.toPoint());
     QVector3D Z(0, 0, 0); // instead of 0 for x and y we need worldPosition.x() and worldPosition.y() ....
-    Z = Z.project(_viewMatrix * _modelMatrix, _projectionMatrix, getViewportFromPoint(start));
+    Z = Z.project(_viewMatrix * _modelMatrix, _projectionMatrix, viewport);
     QVector3D p1(start.x(), height() - start.y(), Z.z());
-    QVector3D O = p1.unproject(_viewMatrix * _modelMatrix, _projectionMatrix, getViewportFromPoint(start));
+    QVector3D O = p1.unproject(_viewMatrix * _modelMatrix, _projectionMatrix, viewport);
     QVector3D p2(end.x(), height() - end.y(), Z.z());
-    QVector3D P = p2.unproject(_viewMatrix * _modelMatrix, _projectionMatrix, getViewportFromPoint(start));
+    QVector3D P = p2.unproject(_viewMatrix * _modelMatrix, _projectionMatrix, viewport);
     QVector3D OP = P - O;
     return OP;
 }
 
 
-void GLView::animateViewChange()
+void GLView::startAnimation(Animation animation)
+{
+    // Interpolate from wherever the camera is now
+    _currentRotation = QQuaternion::fromRotationMatrix(_camera->getViewMatrix().toGenericMatrix<3, 3>());
+    _currentTranslation = _camera->getPosition();
+    _currentViewRange = _viewRange;
+
+    _animation = animation;
+    _animationClock.start();
+    markDirty(DirtyCamera);
+}
+
+void GLView::stopAnimation()
+{
+    // Set all defaults
+    _currentRotation = QQuaternion::fromRotationMatrix(_camera->getViewMatrix().toGenericMatrix<3, 3>());
+    _currentTranslation = _camera->getPosition();
+    _currentViewRange = _viewRange;
+    _viewMode = ViewMode::NONE;
+
+    _animation = Animation::NONE;
+}
+
+void GLView::finishAnimation()
+{
+    switch (_animation)
+    {
+    case Animation::VIEW_CHANGE:
+        animateViewChange(1.0f);
+        break;
+    case Animation::FIT_ALL:
+        animateFitAll(1.0f);
+        break;
+    case Animation::WINDOW_ZOOM:
+        animateWindowZoom(1.0f);
+        break;
+    default:
+        return;
+    }
+    stopAnimation();
+    markDirty(DirtyCamera);
+}
+
+void GLView::advanceAnimation()
+{
+    if (_animation == Animation::NONE)
+        return;
+
+    GLfloat progress = qMin(1.0f, _animationClock.elapsed() / static_cast<GLfloat>(_animationDuration));
+    GLfloat t = static_cast<GLfloat>(_animationCurve.valueForProgress(progress));
+
+    switch (_animation)
+    {
+    case Animation::VIEW_CHANGE:
+        animateViewChange(t);
+        break;
+    case Animation::FIT_ALL:
+        animateFitAll(t);
+        break;
+    case Animation::WINDOW_ZOOM:
+        animateWindowZoom(t);
+        break;
+    default:
+        break;
+    }
+
+    // The last frame is requested here, after it no more frames are scheduled
+    if (progress >= 1.0f)
+        stopAnimation();
+
+    updateProjection(width(), height());
+    markDirty(DirtyCamera);
+}
+
+void GLView::animateViewChange(GLfloat t)
 {
     if (_viewMode == ViewMode::TOP)
     {
-        setRotations(0.0f, 0.0f, 0.0f);
+        setRotations(0.0f, 0.0f, 0.0f, t);
     }
     if (_viewMode == ViewMode::BOTTOM)
     {
-        setRotations(0.0f, -180.0f, 0.0f);
+        setRotations(0.0f, -180.0f, 0.0f, t);
     }
     if (_viewMode == ViewMode::LEFT)
     {
-        setRotations(0.0f, -90.0f, 90.0f);
+        setRotations(0.0f, -90.0f, 90.0f, t);
     }
     if (_viewMode == ViewMode::RIGHT)
     {
-        setRotations(0.0f, -90.0f, -90.0f);
+        setRotations(0.0f, -90.0f, -90.0f, t);
     }
     if (_viewMode == ViewMode::FRONT)
     {
-        setRotations(0.0f, -90.0f, 0.0f);
+        setRotations(0.0f, -90.0f, 0.0f, t);
     }
     if (_viewMode == ViewMode::BACK)
     {
-        setRotations(0.0f, -90.0f, 180.0f);
+        setRotations(0.0f, -90.0f, 180.0f, t);
     }
     if (_viewMode == ViewMode::ISOMETRIC)
     {
-        setRotations(-45.0f, -54.7356f, 0.0f);
+        setRotations(-45.0f, -54.7356f, 0.0f, t);
     }
     if (_viewMode == ViewMode::DIMETRIC)
     {
-        setRotations(-20.7048f, -70.5288f, 0.0f);
+        setRotations(-20.7048f, -70.5288f, 0.0f, t);
     }
     if (_viewMode == ViewMode::TRIMETRIC)
     {
-        setRotations(-30.0f, -55.0f, 0.0f);
+        setRotations(-30.0f, -55.0f, 0.0f, t);
     }
-
-    resizeGL(width(), height());
 }
 
-void GLView::animateFitAll()
+void GLView::animateFitAll(GLfloat t)
 {
-    setZoomAndPan(_viewBoundingSphereDia, -_currentTranslation + _boundingSphere.getCenter());
-    resizeGL(width(), height());
+    setZoomAndPan(_viewBoundingSphereDia, -_currentTranslation + _boundingSphere.getCenter(), t);
 }
 
-void GLView::animateWindowZoom()
+void GLView::animateWindowZoom(GLfloat t)
 {
-    setZoomAndPan(_currentViewRange /_rubberBandZoomRatio, _rubberBandPan);
-    resizeGL(width(), height());
+    setZoomAndPan(_currentViewRange /_rubberBandZoomRatio, _rubberBandPan, t);
 }
 
 
@@ -1027,14 +1861,14 @@ void GLView::setView(QVector3D viewPos, QVector3D viewDir, QVector3D upDir, QVec
 }
 
 
-void GLView::setRotations(GLfloat xRot, GLfloat yRot, GLfloat zRot)
+void GLView::setRotations(GLfloat xRot, GLfloat yRot, GLfloat zRot, GLfloat t)
 {
     // Rotation
     QQuaternion targetRotation = QQuaternion::fromEulerAngles(yRot, zRot, xRot);//Pitch, Yaw, Roll
-    QQuaternion curRot = QQuaternion::slerp(_currentRotation, targetRotation, _slerpStep += _slerpFrac);
+    QQuaternion curRot = QQuaternion::slerp(_currentRotation, targetRotation, t);
 
     // Translation
-    QVector3D curPos = _currentTranslation - (_slerpStep * _currentTranslation) + (_boundingSphere.getCenter() * _slerpStep);
+    QVector3D curPos = _currentTranslation + (_boundingSphere.getCenter() - _currentTranslation) * t;
 
     // Set camera vectors
     QMatrix4x4 rotMat = QMatrix4x4(curRot.toRotationMatrix());
@@ -1044,60 +1878,16 @@ void GLView::setRotations(GLfloat xRot, GLfloat yRot, GLfloat zRot)
     _camera->setView(curPos, viewDir, upDir, rightDir);
 
     // Set zoom
-    GLfloat scaleStep = (_currentViewRange - _viewBoundingSphereDia) * _slerpFrac;
-    _viewRange -= scaleStep;
-
-    if (qFuzzyCompare(_slerpStep, 1.0f))
-    {
-        // Set camera vectors
-        QMatrix4x4 rotMat = QMatrix4x4(curRot.toRotationMatrix());
-        QVector3D viewDir = -rotMat.row(2).toVector3D();
-        QVector3D upDir = rotMat.row(1).toVector3D();
-        QVector3D rightDir = rotMat.row(0).toVector3D();
-        _camera->setView(curPos, viewDir, upDir, rightDir);
-
-        // Set all defaults
-        _currentRotation = QQuaternion::fromRotationMatrix(_camera->getViewMatrix().toGenericMatrix<3, 3>());
-        _currentTranslation = _camera->getPosition();
-        _currentViewRange = _viewRange;
-        _viewMode = ViewMode::NONE;
-        _slerpStep = 0.0f;
-
-        _animateViewTimer->stop();
-    }
+    _viewRange = _currentViewRange + (_viewBoundingSphereDia - _currentViewRange) * t;
 }
 
-void GLView::setZoomAndPan(GLfloat zoom, QVector3D pan)
+void GLView::setZoomAndPan(GLfloat zoom, QVector3D pan, GLfloat t)
 {
-    _slerpStep += _slerpFrac;
-
     // Translation
-    QVector3D curPos = pan *_slerpFrac;
-    _camera->move(curPos.x(), curPos.y(), curPos.z());
+    _camera->setPosition(_currentTranslation + pan * t);
 
     // Set zoom
-    GLfloat scaleStep = (_currentViewRange - zoom) * _slerpFrac;
-    _viewRange -= scaleStep;
-
-    if (qFuzzyCompare(_slerpStep, 1.0f))
-    {
-        // position the camera for rotation center
-        //QVector3D Z(0, 0, 0); // instead of 0 for x and y we need worldPosition.x() and worldPosition.y() ....
-        //Z = Z.project(_viewMatrix * _modelMatrix, _projectionMatrix, QRect(0, 0, width(), height()));
-        //QPoint point = geometry().center();
-        //QVector3D p(point.x(), height() - point.y(), Z.z());
-        //QVector3D P = p.unproject(_viewMatrix * _modelMatrix, _projectionMatrix, QRect(0, 0, width(), height()));
-        //_camera->setPosition(P.x(), P.y(), P.z());
-
-        // Set all defaults
-        _currentTranslation = _camera->getPosition();
-        _currentViewRange = _viewRange;
-        _viewMode = ViewMode::NONE;
-        _slerpStep = 0.0f;
-
-        _animateFitAllTimer->stop();
-        _animateWindowZoomTimer->stop();
-    }
+    _viewRange = _currentViewRange + (zoom - _currentViewRange) * t;
 }
 
 void GLView::showEvent(QShowEvent* /*event*/)
@@ -1185,6 +1975,8 @@ void GLView::gradientBackground(float top_r, float top_g, float top_b, float top
     if (!_bgVAO.isCreated())
     {
         _bgVAO.create();
+        _bgVAO.bind();
+        GLDebugLog::label(this, GL_VERTEX_ARRAY, _bgVAO.objectId(), "Full screen triangle VAO");
     }
 
     glDisable(GL_DEPTH_TEST);
@@ -1197,6 +1989,7 @@ void GLView::gradientBackground(float top_r, float top_g, float top_b, float top
 
     _bgVAO.bind();
     glDrawArrays(GL_TRIANGLES, 0, 3);
+    DrawStatistics::count(GL_TRIANGLES, 3);
 
     glEnable(GL_DEPTH_TEST);
 
@@ -1210,6 +2003,7 @@ void GLView::splitScreen()
     {
         _bgSplitVAO.create();
         _bgSplitVAO.bind();
+        GLDebugLog::label(this, GL_VERTEX_ARRAY, _bgSplitVAO.objectId(), "Split lines VAO");
     }
 
     if (!_bgSplitVBO.isCreated())
@@ -1217,6 +2011,7 @@ void GLView::splitScreen()
         _bgSplitVBO = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
         _bgSplitVBO.create();
         _bgSplitVBO.bind();
+        GLDebugLog::label(this, GL_BUFFER, _bgSplitVBO.bufferId(), "Split lines");
         _bgSplitVBO.setUsagePattern(QOpenGLBuffer::StaticDraw);
 
         static const std::vector<GLfloat> vertices = {
@@ -1235,13 +2030,14 @@ void GLView::splitScreen()
         _bgSplitVBO.release();
     }
 
-    glViewport(0, 0, width(), height());
+    setViewport(0, 0, width(), height());
 
     glDisable(GL_DEPTH_TEST);
 
     _bgSplitVAO.bind();
     glLineWidth(2.0);
     glDrawArrays(GL_LINES, 0, 4);
+    DrawStatistics::count(GL_LINES, 4);
     glLineWidth(1);
 
     glEnable(GL_DEPTH_TEST);
@@ -1249,3 +2045,196 @@ void GLView::splitScreen()
     _bgSplitVAO.release();
     _bgSplitShader.release();
 }
+
+bool GLView::isInteracting() const
+{
+    return (_bLeftButtonDown && !_bWindowZoomActive) || _bRightButtonDown || _bMiddleButtonDown;
+}
+
+QSize GLView::framebufferSize() const
+{
+    return size() * devicePixelRatioF();
+}
+
+QRect GLView::framePixels(const QRect& rect) const
+{
+    // Round the edges rather than the extent so adjacent rectangles stay adjacent
+    qreal scale = _frameScale * devicePixelRatioF();
+    int left = qRound(rect.x() * scale);
+    int bottom = qRound(rect.y() * scale);
+    int right = qRound((rect.x() + rect.width()) * scale);
+    int top = qRound((rect.y() + rect.height()) * scale);
+    return QRect(left, bottom, right - left, top - bottom);
+}
+
+void GLView::setViewport(int x, int y, int w, int h)
+{
+    QRect pixels = framePixels(QRect(x, y, w, h));
+    glViewport(pixels.x(), pixels.y(), pixels.width(), pixels.height());
+}
+
+void GLView::beginScaledFrame()
+{
+    // The target has the device pixels of the widget like its own framebuffer,
+    // scaled frames use its lower left part
+    QSize pixels = framebufferSize();
+    if (!_scaledFrame || _scaledFrame->size() != pixels)
+    {
+        if (_scaledFrame)
+            delete _scaledFrame;
+        _scaledFrame = new QOpenGLFramebufferObject(pixels, QOpenGLFramebufferObject::Depth);
+        glBindTexture(GL_TEXTURE_2D, _scaledFrame->texture());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    // Adapt to the last measured frame without waiting on the GPU
+    if (_scaleQueryPending)
+    {
+        GLint available = 0;
+        glGetQueryObjectiv(_scaleQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available)
+        {
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(_scaleQuery, GL_QUERY_RESULT, &elapsed);
+            adaptRenderScale(elapsed / 1.0e6);
+            _scaleQueryPending = false;
+        }
+    }
+
+    _scaledFrame->bind();
+    _frameScale = _renderScale;
+    if (!_scaleQueryPending)
+        glBeginQuery(GL_TIME_ELAPSED, _scaleQuery);
+}
+
+void GLView::endScaledFrame()
+{
+    if (!_scaleQueryPending)
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        _scaleQueryPending = true;
+    }
+
+    QSize pixels = _scaledFrame->size();
+    QRect drawn = framePixels(rect());
+    GLfloat uScale = drawn.width() / static_cast<GLfloat>(pixels.width());
+    GLfloat vScale = drawn.height() / static_cast<GLfloat>(pixels.height());
+    _frameScale = 1.0f;
+
+    // Upscale into the widget framebuffer
+    glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+    glViewport(0, 0, pixels.width(), pixels.height());
+    compositeTexture(_scaledFrame->texture(), uScale, vScale);
+}
+
+void GLView::compositeTexture(GLuint texture, GLfloat uScale, GLfloat vScale)
+{
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+    _upscaleShader.bind();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    _upscaleShader.setUniformValue("frame", 0);
+    _upscaleShader.setUniformValue("uv_scale", QVector2D(uScale, vScale));
+
+    if (!_bgVAO.isCreated())
+    {
+        _bgVAO.create();
+        _bgVAO.bind();
+        GLDebugLog::label(this, GL_VERTEX_ARRAY, _bgVAO.objectId(), "Full screen triangle VAO");
+    }
+    _bgVAO.bind();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    DrawStatistics::count(GL_TRIANGLES, 3);
+    _bgVAO.release();
+    _upscaleShader.release();
+
+    glEnable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+}
+
+void GLView::adaptRenderScale(double frameTime)
+{
+    // Fill cost grows with the pixel count, the square of the scale. Limit the
+    // change per frame so a single slow frame does not make the view flicker.
+    GLfloat ratio = static_cast<GLfloat>(qSqrt(_targetFrameTime / qMax(frameTime, 0.01)));
+    _renderScale = qBound(0.5f, _renderScale * qBound(0.9f, ratio, 1.1f), 1.0f);
+}
+
+void GLView::showGpuProfiler(bool show)
+{
+    if (!_gpuProfiler)
+        return;
+    if (show && !_gpuProfiler->isEnabled())
+        _gpuProfiler->reset();
+    _gpuProfiler->setEnabled(show);
+    if (show)
+        _gpuProfilerTimer->start();
+    else
+        _gpuProfilerTimer->stop();
+    markDirty(DirtyOverlay);
+}
+
+bool GLView::exportGpuProfile(const QString& fileName) const
+{
+    return _gpuProfiler && _gpuProfiler->exportCsv(fileName);
+}
+
+void GLView::refreshGpuProfiler()
+{
+    // The profiler is drawn over the scene, cached quadrants stay valid
+    markDirty(DirtyFrame);
+}
+
+void GLView::renderGpuProfiler()
+{
+    setViewport(0, 0, width(), height());
+
+    // Below the model name, columns at fixed positions as the font is proportional
+    const GLfloat scale = 0.6f;
+    const GLfloat lineHeight = 18.0f;
+    const GLfloat columns[6] = { 8.0f, 130.0f, 190.0f, 250.0f, 310.0f, 370.0f };
+    const glm::vec3 headerColor(1.0f, 1.0f, 0.0f);
+    const glm::vec3 color(1.0f, 1.0f, 1.0f);
+
+    GLfloat y = 36.0f;
+    const char* header[6] = { "GPU ms", "avg", "p50", "p95", "p99", "max" };
+    for (int i = 0; i < 6; i++)
+        _textRenderer->RenderText(header[i], columns[i], y, scale, headerColor);
+
+    for (const GpuProfiler::Statistics& scope : _gpuProfiler->statistics())
+    {
+        y += lineHeight;
+        double values[5] = { scope.average, scope.median, scope.p95, scope.p99, scope.max };
+        _textRenderer->RenderText(scope.name, columns[0], y, scale, color);
+        for (int i = 0; i < 5; i++)
+            _textRenderer->RenderText(QString::number(values[i], 'f', 2).toStdString(), columns[i + 1], y, scale, color);
+    }
+
+    if (_gpuProfiler->skippedFrames())
+    {
+        y += lineHeight;
+        _textRenderer->RenderText(QString("%1 frames skipped, results late").arg(_gpuProfiler->skippedFrames()).toStdString(),
+                                  columns[0], y, scale, headerColor);
+    }
+
+    // The newest driver messages, with --gl-debug
+    if (_glDebugLog)
+    {
+        const glm::vec3 warningColor(1.0f, 0.5f, 0.3f);
+        for (const GLDebugLog::Message& message : _glDebugLog->recent(5))
+        {
+            y += lineHeight;
+            QString line = message.count > 1 ? QString("%1x %2").arg(message.count).arg(message.text) : message.text;
+            if (line.size() > 110)
+                line = line.left(107) + "...";
+            _textRenderer->RenderText(line.toStdString(), columns[0], y, scale, warningColor);
+        }
+    }
+}
@@ -14,6 +14,11 @@
 /* Custom OpenGL Viewer Widget */
 
 class TextRenderer;
+class GlyphCache;
+class GpuProfiler;
+class GLDebugLog;
+class RenderThread;
+struct RenderState;
 class TriangleMesh;
 class SphericalHarmonicsEditor;
 class SuperToroidEditor;
@@ -28,10 +33,31 @@ enum class ViewProjection { ORTHOGRAPHIC, PERSPECTIVE };
 class GLView : public QOpenGLWidget, QOpenGLFunctions_4_5_Core
 {
 	friend class ClippingPlanesEditor;
+	friend class ViewBenchmark;
+	friend class SessionRecorder;
+	friend class SessionReplay;
 	Q_OBJECT
 public:
 	GLView(QWidget *parent = 0, const char *name = 0);
 	~GLView();
+
+	// What changed since the last frame, nothing is drawn while no flag is set
+	enum DirtyFlag
+	{
+		DirtyNone     = 0x00,
+		DirtyCamera   = 0x01,
+		DirtyMaterial = 0x02,
+		DirtyGeometry = 0x04,
+		DirtyClipping = 0x08,
+		DirtyOverlay  = 0x10,
+		DirtyAll      = 0x1F,
+		// Only what is drawn over the scene needs redrawing, a frame from the
+		// render thread or a new reading of the profiler overlay
+		DirtyFrame    = 0x20
+	};
+	// Records the changed state and schedules a repaint
+	void markDirty(unsigned int flags);
+
 	void changeModel(bool forward);
 	void updateView();
 	void setTexture(QImage img);
@@ -40,9 +66,11 @@ public:
 	void setViewMode(ViewMode mode);
 	void setProjection(ViewProjection proj);
 
-	void setMultiView(bool active) { _bMultiView = active; }
+	void setMultiView(bool active) { _bMultiView = active; markDirty(DirtyCamera | DirtyOverlay); }
 
 	void fitAll();
+	// Jumps to the end of a running view transition, for runs timed by frame instead of the clock
+	void finishAnimation();
 
 	void beginWindowZoom();
 	void endWindowZoom();
@@ -55,8 +83,33 @@ public:
 
 	void showClippingPlaneEditor(bool show);
 
+	// World space labels drawn over the model, e.g. vertex indices or dimensions
+	void addLabel(const QVector3D& position, const QString& text, float pixelHeight = 16.0f, QColor color = Qt::yellow);
+	void clearLabels();
+
 	std::vector<TriangleMesh*> getMeshStore() const { return _meshStore; }
 
+	// Time from the first camera input event of a frame until that frame was presented
+	struct InputLatency
+	{
+		double lastMs;
+		double averageMs;
+		double maxMs;
+		int eventsPerFrame; // Input events coalesced into the last frame
+	};
+	InputLatency inputLatency() const { return _inputLatency; }
+	void resetInputLatency();
+
+	// Saves the single view at the given size, the window size if invalid. The
+	// image is read back without stalling and written on a worker thread. Sizes
+	// beyond one render target are drawn in tiles and streamed to a PNG file, false
+	// if such a poster was asked for under another suffix or could not be written.
+	bool saveSnapshot(const QString& fileName, QSize size = QSize());
+
+	// GPU time of the parts of a frame, shown over the view while measuring
+	void showGpuProfiler(bool show);
+	bool exportGpuProfile(const QString& fileName) const;
+
 public:
 	QVector4D _ambiLight;
 	QVector4D _diffLight;
@@ -84,17 +137,27 @@ signals:
 	void modelChanged(int num);
 	void windowZoomEnded();
 
-public slots:
-	void animateViewChange();
-	void animateFitAll();
-	void animateWindowZoom();
+private slots:
+	// Steps the running view animation once per presented frame
+	void advanceAnimation();
+	// Closes the latency measurement of the frame that consumed input
+	void recordInputLatency();
+	// Shows the parameter editor belonging to the current model only
+	void updateEditorVisibility();
+	// Schedules the composite of a frame finished by the render thread
+	void scheduleComposite();
+	// Hands the snapshots whose read completed to the writers
+	void pollSnapshots();
+	// Redraws the profiler overlay with the results that arrived since
+	void refreshGpuProfiler();
 
 protected:
 	void initializeGL();
 	void resizeGL(int width, int height);
 	void paintGL();
 
-	void render();
+	// Labels are placed in a viewport of the given size, the view size if invalid
+	void render(const QSize& labelViewport = QSize());
 
 	void mousePressEvent(QMouseEvent *);
 	void mouseReleaseEvent(QMouseEvent *);
@@ -107,19 +170,22 @@ protected:
 
     QRect getViewportFromPoint(const QPoint& pixel);
     QRect getClientRectFromPoint(const QPoint& pixel);
-    QVector3D get3dTranslationVectorFromMousePoints(const QPoint& start, const QPoint& end);
+    QVector3D get3dTranslationVectorFromMousePoints(const QPointF& start, const QPointF& end);
 
 
 private:
     int _modelNum;
+	unsigned int _dirty;
 	QImage _texImage, _texBuffer;
 	TextRenderer* _textRenderer;
+	GlyphCache* _glyphCache;
+	GpuProfiler* _gpuProfiler;
+	QTimer* _gpuProfilerTimer;
+	GLDebugLog* _glDebugLog;
 	QString _modelName;
 
 	QVector3D _currentTranslation;
 	QQuaternion _currentRotation;
-    GLfloat _slerpStep;
-    GLfloat _slerpFrac;
 
     GLfloat _currentViewRange;
     GLfloat _scaleFrac;
@@ -137,6 +203,24 @@ private:
 	bool _bMiddleButtonDown;
 	QPoint _middleButtonPoint;
 
+	// Camera input accumulated between frames, applied once at the start of paintGL
+	QPoint _pendingRotation;
+	QPoint _pendingPan;
+	// Zooms are not merged, each moves the camera about the anchor it was made at
+	struct ZoomStep
+	{
+		GLfloat factor;
+		QPoint anchor;
+		QPointF shift;
+	};
+	std::vector<ZoomStep> _pendingZooms;
+	int _pendingEvents;
+	qint64 _pendingInputTime;
+	qint64 _frameInputTime;
+	int _frameInputEvents;
+	QElapsedTimer _inputClock;
+	InputLatency _inputLatency;
+
 	QRubberBand* _rubberBand;
 	QVector3D _rubberBandPan;
     GLfloat _rubberBandZoomRatio;
@@ -161,12 +245,62 @@ private:
 
 	QOpenGLShaderProgram*     _fgShader;
 
+	// All four views of the multi view layout in one instanced draw
+	QOpenGLShaderProgram     _multiViewShader;
+	GLuint                   _viewsUBO;
+	bool                     _bViewportArrays;
+
+	// Multi view quadrants are kept in a cache and redrawn only when their
+	// camera or the scene they show changes
+	struct ViewQuadrant
+	{
+		QRect viewport;      // Widget coordinates with the origin bottom left
+		QMatrix4x4 projectionMatrix;
+		QMatrix4x4 viewMatrix;
+		// State of the cached image
+		QMatrix4x4 cachedProjection;
+		QMatrix4x4 cachedView;
+		unsigned int cachedScene;
+		bool cached;
+	};
+	ViewQuadrant               _quadrants[4];
+	unsigned int               _sceneVersion;
+	QOpenGLFramebufferObject*  _multiViewCache;
+	QOpenGLFramebufferObject*  _multiViewResolved;
+
+	// Optional thread drawing the single view, started with --render-thread
+	RenderThread*              _renderThread;
+	int                        _postedModel;
+	unsigned int               _postedGeneration;
+
+	// Snapshots with a read into a pixel buffer in flight
+	struct PendingSnapshot
+	{
+		GLuint pbo;
+		GLsync fence;
+		QSize size;
+		QString fileName;
+	};
+	std::vector<PendingSnapshot> _pendingSnapshots;
+	QThreadPool                  _snapshotWriters;
+
 	QOpenGLShaderProgram     _textShader;
+	QOpenGLShaderProgram     _labelShader;
 	GLuint                   _texture;
 
 	QOpenGLShaderProgram     _bgShader;
 	QOpenGLVertexArrayObject _bgVAO;
 
+	// Reduced resolution rendering while the view is dragged
+	QOpenGLShaderProgram       _upscaleShader;
+	QOpenGLFramebufferObject*  _scaledFrame;
+	GLfloat                    _renderScale;
+	GLfloat                    _frameScale;     // Resolution of the current frame relative to the full one
+	GLfloat                    _targetFrameTime;
+	GLuint                     _scaleQuery;
+	bool                       _scaleQueryPending;
+	bool                       _lastFrameScaled; // The shown frame is a reduced resolution one
+
 	QOpenGLShaderProgram     _bgSplitShader;
 	QOpenGLVertexArrayObject _bgSplitVAO;
 	QOpenGLBuffer _bgSplitVBO;
@@ -185,9 +319,12 @@ private:
 
 	GLCamera* _camera;
 
-	QTimer* _animateViewTimer;
-	QTimer* _animateFitAllTimer;
-	QTimer* _animateWindowZoomTimer;
+	// View transitions, interpolated from the _current* state by elapsed time
+	enum class Animation { NONE, VIEW_CHANGE, FIT_ALL, WINDOW_ZOOM };
+	Animation _animation;
+	QElapsedTimer _animationClock;
+	QEasingCurve _animationCurve;
+	int _animationDuration;
 
 	BoundingSphere _boundingSphere;
 
@@ -196,15 +333,63 @@ private:
 	void createShaderPrograms();
 	void createGeometry();
 	void createTexture();
-
-    void setRotations(GLfloat xRot, GLfloat yRot, GLfloat zRot);
-    void setZoomAndPan(GLfloat zoom, QVector3D pan);
+	// Light and material uniforms of the model shaders
+	void setLightingUniforms(QOpenGLShaderProgram* prog);
+	// Clipping planes in eye space for the current camera position
+	void computeClipPlanes(const QMatrix4x4& modelView, QVector4D planes[3]);
+	// Views of the quadrants in the order Top, Front, Left, Isometric
+	void updateQuadrants();
+	void renderMultiView();
+	void renderQuadrantsInstanced(const std::vector<int>& quadrants);
+	// Snapshot of everything the render thread needs to draw the single view
+	void captureState(RenderState& state);
+	void postRenderState();
+	void compositeRenderedFrame();
+	// Camera screen size, view range and projection type into _projectionMatrix
+	void updateProjection(int width, int height);
+
+	// Draws the part of an image of the given size covered by the tile, with the
+	// origin bottom left, into the bound framebuffer
+	void renderSnapshotTile(const QSize& size, const QRect& tile);
+	void startSnapshot(const QString& fileName, const QSize& size);
+	void finishSnapshot(PendingSnapshot& snapshot);
+	bool saveTiledSnapshot(const QString& fileName, const QSize& size, int tileSize);
+
+	// Records an input event for coalescing and schedules a frame
+	void queueInput();
+	void applyPendingInput();
+
+	void startAnimation(Animation animation);
+	void stopAnimation();
+	void animateViewChange(GLfloat t);
+	void animateFitAll(GLfloat t);
+	void animateWindowZoom(GLfloat t);
+
+    void setRotations(GLfloat xRot, GLfloat yRot, GLfloat zRot, GLfloat t);
+    void setZoomAndPan(GLfloat zoom, QVector3D pan, GLfloat t);
 	void setView(QVector3D viewPos, QVector3D viewDir, QVector3D upDir, QVector3D rightDir);
 
 	void gradientBackground(float top_r, float top_g, float top_b, float top_a,
 		float bot_r, float bot_g, float bot_b, float bot_a);
 
 	void splitScreen();
+
+	// A rotate, pan or zoom drag is in progress
+	bool isInteracting() const;
+	// Framebuffer size of a full resolution frame, in device pixels
+	QSize framebufferSize() const;
+	// Rectangle in widget coordinates as pixels of the current frame
+	QRect framePixels(const QRect& rect) const;
+	// glViewport in widget coordinates, scaled to the pixels of the current frame
+	void setViewport(int x, int y, int w, int h);
+	void beginScaledFrame();
+	void endScaledFrame();
+	// Draws a texture over the whole bound framebuffer
+	void compositeTexture(GLuint texture, GLfloat uScale, GLfloat vScale);
+	// Picks the next render scale from the measured GPU time of a scaled frame
+	void adaptRenderScale(double frameTime);
+	// Table of the GPU profiler statistics in the top left corner
+	void renderGpuProfiler();
 };
 
 #endif
@@ -0,0 +1,382 @@
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include "GlyphCache.h"
+#include "MemoryStatistics.h"
+#include "GLDebugLog.h"
+
+// Empty texels left around each glyph so linear filtering does not bleed
+static const GLuint GLYPH_PADDING = 1;
+// Distance in pixels covered by the signed distance field on each side of an edge
+static const GLuint SDF_SPREAD = 6;
+
+// One dimensional squared Euclidean distance transform of a sampled function
+// (Felzenszwalb and Huttenlocher), f and d hold n values, v and z are scratch.
+static void distanceTransform1D(const float* f, float* d, int* v, float* z, int n)
+{
+    const float inf = 1e20f;
+    int k = 0;
+    v[0] = 0;
+    z[0] = -inf;
+    z[1] = inf;
+    for (int q = 1; q < n; q++)
+    {
+        float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+        while (s <= z[k])
+        {
+            k--;
+            s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+        }
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = inf;
+    }
+    k = 0;
+    for (int q = 0; q < n; q++)
+    {
+        while (z[k + 1] < q)
+            k++;
+        d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+    }
+}
+
+// Squared distance of every cell of the grid to the nearest cell holding zero
+static void distanceTransform2D(std::vector<float>& grid, int width, int height)
+{
+    int n = std::max(width, height);
+    std::vector<float> f(n), d(n), z(n + 1);
+    std::vector<int> v(n);
+    for (int x = 0; x < width; x++)
+    {
+        for (int y = 0; y < height; y++)
+            f[y] = grid[y * width + x];
+        distanceTransform1D(f.data(), d.data(), v.data(), z.data(), height);
+        for (int y = 0; y < height; y++)
+            grid[y * width + x] = d[y];
+    }
+    for (int y = 0; y < height; y++)
+    {
+        distanceTransform1D(&grid[y * width], d.data(), v.data(), z.data(), width);
+        std::copy(d.begin(), d.begin() + width, grid.begin() + y * width);
+    }
+}
+
+// Converts a coverage bitmap into a signed distance field with spread pixels of
+// margin on every side. 0.5 lies on the glyph outline, larger values are inside.
+static std::vector<GLubyte> makeDistanceField(const FT_Bitmap& bitmap, GLuint spread, GLuint& outWidth, GLuint& outHeight)
+{
+    const float inf = 1e20f;
+    int w = bitmap.width + 2 * spread, h = bitmap.rows + 2 * spread;
+    std::vector<float> toInside(w * h, inf), toOutside(w * h, 0.0f);
+    for (GLuint row = 0; row < bitmap.rows; row++)
+    {
+        const unsigned char* src = bitmap.buffer + row * bitmap.pitch;
+        for (GLuint col = 0; col < bitmap.width; col++)
+        {
+            if (src[col] > 127)
+            {
+                int idx = (row + spread) * w + col + spread;
+                toInside[idx] = 0.0f;
+                toOutside[idx] = inf;
+            }
+        }
+    }
+    distanceTransform2D(toInside, w, h);
+    distanceTransform2D(toOutside, w, h);
+
+    std::vector<GLubyte> field(w * h);
+    for (int i = 0; i < w * h; i++)
+    {
+        float dist = std::sqrt(toOutside[i]) - std::sqrt(toInside[i]);
+        float value = 0.5f + dist / (2.0f * spread);
+        field[i] = static_cast<GLubyte>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f);
+    }
+    outWidth = w;
+    outHeight = h;
+    return field;
+}
+
+// Highest Unicode code point, the key keeps 21 bits for it
+static const char32_t MAX_CODE_POINT = 0x10FFFF;
+// Fonts are numbered in the 10 bits left above the code point, flag and size
+static const size_t MAX_FONTS = 0x400;
+
+// Packs code point (bits 0-20), sdf flag (bit 21), the full pixel size
+// (bits 22-53) and font (bits 54-63) so no two glyphs share a key
+static uint64_t glyphKey(int font, GLuint pixelSize, bool sdf, char32_t codePoint)
+{
+    return (static_cast<uint64_t>(font) << 54) |
+           (static_cast<uint64_t>(pixelSize) << 22) |
+           (static_cast<uint64_t>(sdf) << 21) |
+           static_cast<uint64_t>(codePoint);
+}
+
+
+GlyphCache::GlyphCache(GLuint pageSize, GLuint maxPages) :
+    _pageSize(pageSize),
+    _maxPages(maxPages),
+    _texture(0),
+    _stamp(1),
+    _generation(0),
+    _ft(nullptr)
+{
+    initializeOpenGLFunctions();
+    if (FT_Init_FreeType(&_ft)) // All functions return a value different than 0 whenever an error occurred
+    {
+        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+        _ft = nullptr;
+    }
+
+    // The pages are the layers of one immutable texture array, so the memory
+    // used by the cache is fixed no matter how many glyphs are drawn
+    glGenTextures(1, &_texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, _texture);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_R8, _pageSize, _pageSize, _maxPages);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    GLDebugLog::label(this, GL_TEXTURE, _texture, "Glyph pages");
+    MemoryStatistics::setAllocation(MemoryStatistics::GPU_TEXTURE, this, "Glyph pages",
+                                    MemoryStatistics::textureBytes(_pageSize, _pageSize, 1, false, _maxPages));
+}
+
+GlyphCache::~GlyphCache()
+{
+    if (_texture)
+    {
+        GLDebugLog::unlabel(GL_TEXTURE, _texture);
+        glDeleteTextures(1, &_texture);
+    }
+    MemoryStatistics::release(this);
+    for (Font& font : _fonts)
+    {
+        if (font.face)
+            FT_Done_Face(font.face);
+    }
+    if (_ft)
+        FT_Done_FreeType(_ft);
+}
+
+int GlyphCache::addFont(const std::string& fileName)
+{
+    for (size_t i = 0; i < _fonts.size(); i++)
+    {
+        if (_fonts[i].fileName == fileName)
+            return static_cast<int>(i);
+    }
+    if (_fonts.size() >= MAX_FONTS)
+        return -1;
+    _fonts.push_back(Font{ fileName, nullptr, 0, false });
+    return static_cast<int>(_fonts.size() - 1);
+}
+
+FT_Face GlyphCache::openFace(int font, GLuint pixelSize)
+{
+    if (!_ft || font < 0 || font >= static_cast<int>(_fonts.size()))
+        return nullptr;
+    Font& f = _fonts[font];
+    if (f.failed)
+        return nullptr;
+    if (!f.face)
+    {
+        // Load font as face
+        if (FT_New_Face(_ft, f.fileName.c_str(), 0, &f.face))
+        {
+            std::cout << "ERROR::FREETYPE: Failed to load font " << f.fileName << std::endl;
+            f.face = nullptr;
+            f.failed = true;
+            return nullptr;
+        }
+        FT_Select_Charmap(f.face, FT_ENCODING_UNICODE);
+    }
+    if (f.pixelSize != pixelSize)
+    {
+        FT_Set_Pixel_Sizes(f.face, 0, pixelSize);
+        f.pixelSize = pixelSize;
+    }
+    return f.face;
+}
+
+const Glyph* GlyphCache::glyph(int font, GLuint pixelSize, bool sdf, char32_t codePoint)
+{
+    if (codePoint > MAX_CODE_POINT)
+        return nullptr;
+    uint64_t key = glyphKey(font, pixelSize, sdf, codePoint);
+    auto it = _glyphs.find(key);
+    if (it != _glyphs.end())
+    {
+        if (it->second.Page >= 0)
+            _pages[it->second.Page].lastUsed = _stamp;
+        return &it->second;
+    }
+
+    FT_Face face = openFace(font, pixelSize);
+    if (!face)
+        return nullptr;
+    // Load character glyph
+    if (FT_Load_Char(face, codePoint, FT_LOAD_RENDER))
+    {
+        std::cout << "Error in FreeType: Failed to load Glyph" << std::endl;
+        return nullptr;
+    }
+
+    const FT_Bitmap& bitmap = face->glyph->bitmap;
+    GLuint w = bitmap.width, h = bitmap.rows;
+    GLint margin = 0;
+    std::vector<GLubyte> pixels;
+    if (sdf && w > 0 && h > 0)
+    {
+        pixels = makeDistanceField(bitmap, SDF_SPREAD, w, h);
+        margin = SDF_SPREAD;
+    }
+    else
+    {
+        pixels.resize(w * h);
+        for (GLuint row = 0; row < h; row++)
+        {
+            const unsigned char* src = bitmap.buffer + row * bitmap.pitch;
+            std::copy(src, src + w, pixels.begin() + row * w);
+        }
+    }
+
+    Glyph g = {
+        glm::ivec2(w, h),
+        glm::ivec2(face->glyph->bitmap_left - margin, face->glyph->bitmap_top + margin),
+        static_cast<GLuint>(face->glyph->advance.x),
+        glm::vec2(0.0f),
+        glm::vec2(0.0f),
+        -1
+    };
+
+    // Blank glyphs such as spaces only need their metrics
+    if (w > 0 && h > 0)
+    {
+        glm::ivec2 pos;
+        if (!allocate(w, h, g.Page, pos))
+            return nullptr;
+        g.UVMin = glm::vec2(pos) / static_cast<float>(_pageSize);
+        g.UVMax = glm::vec2(pos + g.Size) / static_cast<float>(_pageSize);
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, _texture);
+        // Disable byte-alignment restriction
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, pos.x, pos.y, g.Page, w, h, 1, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        _pages[g.Page].keys.push_back(key);
+        _pages[g.Page].lastUsed = _stamp;
+    }
+
+    return &(_glyphs[key] = g);
+}
+
+bool GlyphCache::allocate(GLuint w, GLuint h, GLint& page, glm::ivec2& pos)
+{
+    if (w + 2 * GLYPH_PADDING > _pageSize || h + 2 * GLYPH_PADDING > _pageSize)
+        return false;
+
+    for (;;)
+    {
+        // Shelf pack into the first page with room
+        for (size_t i = 0; i < _pages.size(); i++)
+        {
+            Page& p = _pages[i];
+            GLuint x = p.penX, y = p.penY, rowHeight = p.rowHeight;
+            if (x + w + GLYPH_PADDING > _pageSize)
+            {
+                x = GLYPH_PADDING;
+                y += rowHeight + GLYPH_PADDING;
+                rowHeight = 0;
+            }
+            if (y + h + GLYPH_PADDING > _pageSize)
+                continue;
+            p.penX = x + w + GLYPH_PADDING;
+            p.penY = y;
+            p.rowHeight = std::max(rowHeight, h);
+            page = static_cast<GLint>(i);
+            pos = glm::ivec2(x, y);
+            return true;
+        }
+
+        if (_pages.size() < _maxPages)
+            _pages.push_back(Page{ GLYPH_PADDING, GLYPH_PADDING, 0, _stamp, {} });
+        else if (!evictLeastRecentlyUsed())
+            return false;
+    }
+}
+
+bool GlyphCache::evictLeastRecentlyUsed()
+{
+    // Pages used since the last stamp hold glyphs of text being laid out right now
+    int victim = -1;
+    for (size_t i = 0; i < _pages.size(); i++)
+    {
+        if (_pages[i].lastUsed == _stamp)
+            continue;
+        if (victim < 0 || _pages[i].lastUsed < _pages[victim].lastUsed)
+            victim = static_cast<int>(i);
+    }
+    if (victim < 0)
+    {
+        std::cout << "GlyphCache: all atlas pages are in use, glyph dropped" << std::endl;
+        return false;
+    }
+
+    Page& p = _pages[victim];
+    for (uint64_t key : p.keys)
+        _glyphs.erase(key);
+    p.keys.clear();
+    p.penX = GLYPH_PADDING;
+    p.penY = GLYPH_PADDING;
+    p.rowHeight = 0;
+
+    // Clear the layer so stale texels never bleed into the padding of new glyphs
+    const GLubyte zero = 0;
+    glClearTexSubImage(_texture, 0, 0, 0, victim, _pageSize, _pageSize, 1, GL_RED, GL_UNSIGNED_BYTE, &zero);
+
+    _generation++;
+    return true;
+}
+
+std::u32string GlyphCache::decodeUtf8(const std::string& text)
+{
+    std::u32string result;
+    result.reserve(text.size());
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(text.data());
+    size_t n = text.size(), i = 0;
+    while (i < n)
+    {
+        unsigned char c = s[i];
+        int extra;
+        char32_t cp;
+        if (c < 0x80)      { cp = c;        extra = 0; }
+        else if (c < 0xC2) { cp = 0xFFFD;   extra = -1; } // continuation byte or overlong lead
+        else if (c < 0xE0) { cp = c & 0x1F; extra = 1; }
+        else if (c < 0xF0) { cp = c & 0x0F; extra = 2; }
+        else if (c < 0xF5) { cp = c & 0x07; extra = 3; }
+        else               { cp = 0xFFFD;   extra = -1; }
+        i++;
+        if (extra < 0)
+        {
+            result.push_back(cp);
+            continue;
+        }
+        int k = 0;
+        for (; k < extra && i < n && (s[i] & 0xC0) == 0x80; k++, i++)
+            cp = (cp << 6) | (s[i] & 0x3F);
+        // Reject truncated sequences, overlong forms, surrogates and out of range values
+        if (k < extra ||
+            (extra == 2 && cp < 0x800) || (extra == 3 && cp < 0x10000) ||
+            (cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF)
+            cp = 0xFFFD;
+        result.push_back(cp);
+    }
+    return result;
+}
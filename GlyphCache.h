@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+#include <QtOpenGL>
+#include <QOpenGLFunctions_4_5_Core>
+
+typedef struct FT_LibraryRec_* FT_Library;
+typedef struct FT_FaceRec_* FT_Face;
+
+
+/// A glyph rasterized into one of the atlas pages
+struct Glyph {
+    glm::ivec2 Size;    // Size of glyph
+    glm::ivec2 Bearing; // Offset from baseline to left/top of glyph
+    GLuint Advance;     // Horizontal offset to advance to next glyph
+    glm::vec2 UVMin;    // Top left corner of the glyph in its page (normalized)
+    glm::vec2 UVMax;    // Bottom right corner of the glyph in its page (normalized)
+    GLint Page;         // Layer of the atlas texture array holding the glyph
+};
+
+
+// Glyphs of any number of fonts rasterized on demand through FreeType into a
+// fixed number of fixed-size atlas pages, the layers of one texture array.
+// When all pages are full the least recently used page is evicted and its
+// glyphs are rasterized again the next time they are asked for.
+class GlyphCache : public QOpenGLFunctions_4_5_Core
+{
+public:
+    GlyphCache(GLuint pageSize = 1024, GLuint maxPages = 4);
+    ~GlyphCache();
+
+    // Registers a font file, the face is opened lazily. Returns the font id, or -1
+    // once the cache holds as many fonts as its glyph keys can tell apart.
+    int addFont(const std::string& fileName);
+    // Returns the glyph of the code point, rasterizing it if needed. The pointer
+    // stays valid at least until the next call to nextStamp().
+    const Glyph* glyph(int font, GLuint pixelSize, bool sdf, char32_t codePoint);
+    // Starts a new use period, pages used since the last stamp are not evicted
+    void nextStamp() { _stamp++; }
+
+    GLuint texture() const { return _texture; }
+    // Incremented every time a page is evicted, cached glyph layouts must be rebuilt
+    GLuint generation() const { return _generation; }
+
+    // Decodes UTF-8 text, invalid sequences become U+FFFD
+    static std::u32string decodeUtf8(const std::string& text);
+
+private:
+    struct Page {
+        GLuint penX;
+        GLuint penY;
+        GLuint rowHeight;
+        GLuint lastUsed;
+        std::vector<uint64_t> keys;
+    };
+
+    struct Font {
+        std::string fileName;
+        FT_Face face;
+        GLuint pixelSize;
+        bool failed;
+    };
+
+    FT_Face openFace(int font, GLuint pixelSize);
+    bool allocate(GLuint w, GLuint h, GLint& page, glm::ivec2& pos);
+    bool evictLeastRecentlyUsed();
+
+    GLuint _pageSize;
+    GLuint _maxPages;
+    GLuint _texture;
+    GLuint _stamp;
+    GLuint _generation;
+
+    FT_Library _ft;
+    std::vector<Font> _fonts;
+    std::vector<Page> _pages;
+    std::unordered_map<uint64_t, Glyph> _glyphs;
+};
@@ -0,0 +1,235 @@
+#include "GpuProfiler.h"
+
+#include <QFile>
+#include <QTextStream>
+
+#include <algorithm>
+#include <iostream>
+
+GpuProfiler::GpuProfiler() :
+    _enabled(false),
+    _inFrame(false),
+    _current(0),
+    _frameNumber(0),
+    _skippedFrames(0)
+{
+    initializeOpenGLFunctions();
+    for (FrameQueries& frame : _frames)
+    {
+        frame.used = 0;
+        frame.number = 0;
+        frame.pending = false;
+    }
+}
+
+GpuProfiler::~GpuProfiler()
+{
+    for (FrameQueries& frame : _frames)
+    {
+        if (!frame.queries.empty())
+            glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+    }
+}
+
+void GpuProfiler::setEnabled(bool enabled)
+{
+    _enabled = enabled;
+}
+
+void GpuProfiler::beginFrame()
+{
+    if (!_enabled)
+        return;
+
+    FrameQueries& frame = _frames[_current];
+    if (frame.pending)
+    {
+        // Its queries are needed again, take the results only if they are there
+        if (resultsAvailable(frame))
+            readFrame(frame);
+        else
+        {
+            frame.pending = false;
+            _skippedFrames++;
+        }
+    }
+
+    frame.used = 0;
+    frame.number = _frameNumber++;
+    _openScopes.clear();
+    _inFrame = true;
+    beginScope("Frame");
+}
+
+void GpuProfiler::endFrame()
+{
+    if (!_inFrame)
+        return;
+
+    while (!_openScopes.empty())
+        endScope();
+    _frames[_current].pending = true;
+    _inFrame = false;
+    _current = (_current + 1) % FRAME_LATENCY;
+    collect();
+}
+
+void GpuProfiler::beginScope(const char* name)
+{
+    if (!_inFrame)
+        return;
+
+    FrameQueries& frame = _frames[_current];
+    int pair = frame.used++;
+    if (static_cast<int>(frame.queries.size()) < frame.used * 2)
+    {
+        size_t first = frame.queries.size();
+        frame.queries.resize(frame.used * 2);
+        glGenQueries(static_cast<GLsizei>(frame.queries.size() - first), frame.queries.data() + first);
+        frame.scopes.resize(frame.used);
+    }
+    frame.scopes[pair] = scopeIndex(name);
+    glQueryCounter(frame.queries[pair * 2], GL_TIMESTAMP);
+    _openScopes.push_back(pair);
+}
+
+void GpuProfiler::endScope()
+{
+    if (!_inFrame || _openScopes.empty())
+        return;
+
+    int pair = _openScopes.back();
+    _openScopes.pop_back();
+    glQueryCounter(_frames[_current].queries[pair * 2 + 1], GL_TIMESTAMP);
+}
+
+int GpuProfiler::scopeIndex(const char* name)
+{
+    for (size_t i = 0; i < _scopeNames.size(); i++)
+    {
+        if (_scopeNames[i] == name)
+            return static_cast<int>(i);
+    }
+    _scopeNames.push_back(name);
+    _windows.push_back(std::deque<double>());
+    return static_cast<int>(_scopeNames.size()) - 1;
+}
+
+void GpuProfiler::collect()
+{
+    // The slot about to be reused holds the oldest frame, results arrive in order
+    for (int i = 0; i < FRAME_LATENCY; i++)
+    {
+        FrameQueries& frame = _frames[(_current + i) % FRAME_LATENCY];
+        if (!frame.pending)
+            continue;
+        if (!resultsAvailable(frame))
+            break;
+        readFrame(frame);
+    }
+}
+
+bool GpuProfiler::resultsAvailable(const FrameQueries& frame)
+{
+    // "Frame" is the first scope and ends after all others, queries complete in order
+    GLint available = 0;
+    glGetQueryObjectiv(frame.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+    return available != 0;
+}
+
+void GpuProfiler::readFrame(FrameQueries& frame)
+{
+    FrameTimes times;
+    times.number = frame.number;
+    times.times.assign(_scopeNames.size(), -1.0);
+    for (int pair = 0; pair < frame.used; pair++)
+    {
+        GLuint64 begin = 0;
+        GLuint64 end = 0;
+        glGetQueryObjectui64v(frame.queries[pair * 2], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(frame.queries[pair * 2 + 1], GL_QUERY_RESULT, &end);
+        double& time = times.times[frame.scopes[pair]];
+        time = qMax(time, 0.0) + (end - begin) / 1.0e6;
+    }
+    frame.pending = false;
+
+    for (size_t scope = 0; scope < times.times.size(); scope++)
+    {
+        if (times.times[scope] < 0.0)
+            continue;
+        std::deque<double>& window = _windows[scope];
+        window.push_back(times.times[scope]);
+        if (window.size() > static_cast<size_t>(WINDOW_SIZE))
+            window.pop_front();
+    }
+    _history.push_back(times);
+    if (_history.size() > static_cast<size_t>(HISTORY_SIZE))
+        _history.pop_front();
+}
+
+std::vector<GpuProfiler::Statistics> GpuProfiler::statistics() const
+{
+    std::vector<Statistics> result;
+    for (size_t scope = 0; scope < _scopeNames.size(); scope++)
+    {
+        std::vector<double> times(_windows[scope].begin(), _windows[scope].end());
+        if (times.empty())
+            continue;
+        std::sort(times.begin(), times.end());
+        auto percentile = [&times](double p) {
+            return times[std::min(times.size() - 1, static_cast<size_t>(p * (times.size() - 1) + 0.5))];
+        };
+
+        Statistics statistics;
+        statistics.name = _scopeNames[scope];
+        statistics.samples = static_cast<int>(times.size());
+        double sum = 0.0;
+        for (double time : times)
+            sum += time;
+        statistics.average = sum / times.size();
+        statistics.median = percentile(0.5);
+        statistics.p95 = percentile(0.95);
+        statistics.p99 = percentile(0.99);
+        statistics.max = times.back();
+        result.push_back(statistics);
+    }
+    return result;
+}
+
+void GpuProfiler::reset()
+{
+    for (std::deque<double>& window : _windows)
+        window.clear();
+    _history.clear();
+    _skippedFrames = 0;
+}
+
+bool GpuProfiler::exportCsv(const QString& fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        std::cout << "Could not write " << fileName.toStdString() << ": " << file.errorString().toStdString() << std::endl;
+        return false;
+    }
+
+    QTextStream stream(&file);
+    stream << "frame";
+    for (const std::string& name : _scopeNames)
+        stream << ',' << QString::fromStdString(name);
+    stream << '\n';
+
+    // Times in ms, empty where the scope was not entered that frame
+    for (const FrameTimes& times : _history)
+    {
+        stream << times.number;
+        for (size_t scope = 0; scope < _scopeNames.size(); scope++)
+        {
+            stream << ',';
+            if (scope < times.times.size() && times.times[scope] >= 0.0)
+                stream << QString::number(times.times[scope], 'f', 4);
+        }
+        stream << '\n';
+    }
+    return stream.status() == QTextStream::Ok;
+}
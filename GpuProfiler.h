@@ -0,0 +1,109 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <QString>
+#include <QOpenGLFunctions_4_5_Core>
+
+
+// Measures the GPU time of named scopes of a frame with timestamp queries.
+// The queries of a frame are read a few frames later, once the GPU finished
+// them, so the profiler never waits on the GPU; a frame whose results are not
+// ready when its queries are needed again is skipped.
+//
+// Scopes may nest and may be entered several times a frame, their times add up.
+class GpuProfiler : protected QOpenGLFunctions_4_5_Core
+{
+public:
+    // Times of one scope over the recent frames, in ms
+    struct Statistics
+    {
+        std::string name;
+        int samples;
+        double average;
+        double median;
+        double p95;
+        double p99;
+        double max;
+    };
+
+    // Begins a scope and ends it when going out of scope, does nothing without a profiler
+    class Scope
+    {
+    public:
+        Scope(GpuProfiler* profiler, const char* name) : _profiler(profiler)
+        {
+            if (_profiler)
+                _profiler->beginScope(name);
+        }
+        ~Scope()
+        {
+            if (_profiler)
+                _profiler->endScope();
+        }
+
+    private:
+        GpuProfiler* _profiler;
+    };
+
+    // Created and destroyed with the context current
+    GpuProfiler();
+    ~GpuProfiler();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return _enabled; }
+
+    void beginFrame();
+    void endFrame();
+    void beginScope(const char* name);
+    void endScope();
+
+    // Rolling statistics of every scope seen, in the order they were first seen
+    std::vector<Statistics> statistics() const;
+    int skippedFrames() const { return _skippedFrames; }
+    void reset();
+
+    // One row per measured frame, one column per scope
+    bool exportCsv(const QString& fileName) const;
+
+private:
+    // Queries of one frame in flight
+    struct FrameQueries
+    {
+        std::vector<GLuint> queries;
+        std::vector<int> scopes;       // Scope of every begin and end query pair
+        int used;                      // Query pairs used
+        unsigned long long number;
+        bool pending;
+    };
+
+    int scopeIndex(const char* name);
+    // Reads the frames whose results arrived, oldest first
+    void collect();
+    // Whether the last query of the frame, the end of its "Frame" scope, has a result
+    bool resultsAvailable(const FrameQueries& frame);
+    void readFrame(FrameQueries& frame);
+
+    static const int FRAME_LATENCY = 4;     // Frames between issuing and reading the queries
+    static const int WINDOW_SIZE = 240;     // Frames in the rolling statistics
+    static const int HISTORY_SIZE = 3600;   // Frames kept for the export
+
+    bool _enabled;
+    bool _inFrame;
+    FrameQueries _frames[FRAME_LATENCY];
+    int _current;
+    unsigned long long _frameNumber;
+    std::vector<int> _openScopes;          // Query pairs of the scopes not yet ended
+    int _skippedFrames;
+
+    std::vector<std::string> _scopeNames;
+    std::vector<std::deque<double>> _windows;
+    struct FrameTimes
+    {
+        unsigned long long number;
+        std::vector<double> times;         // By scope, negative where the scope was not entered
+    };
+    std::deque<FrameTimes> _history;
+};
@@ -2,6 +2,7 @@
 #include "ui_GraysKleinEditor.h"
 #include "GraysKlein.h"
 #include "GLView.h"
+#include "CpuTrace.h"
 
 GraysKleinEditor::GraysKleinEditor(GraysKlein* klein, QWidget *parent)
 	: QWidget(parent),
@@ -22,6 +23,7 @@ GraysKleinEditor::~GraysKleinEditor()
 
 void GraysKleinEditor::on_doubleSpinBoxA_valueChanged(double val)
 {
+	TRACE_SCOPE("GraysKleinEditor rebuild");
 	_graysKlein->_A = val;
 	_graysKlein->buildMesh(_graysKlein->getSlices(), _graysKlein->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -29,6 +31,7 @@ void GraysKleinEditor::on_doubleSpinBoxA_valueChanged(double val)
 
 void GraysKleinEditor::on_doubleSpinBoxM_valueChanged(double val)
 {
+	TRACE_SCOPE("GraysKleinEditor rebuild");
 	_graysKlein->_M = val;
 	_graysKlein->buildMesh(_graysKlein->getSlices(), _graysKlein->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -36,6 +39,7 @@ void GraysKleinEditor::on_doubleSpinBoxM_valueChanged(double val)
 
 void GraysKleinEditor::on_doubleSpinBoxN_valueChanged(double val)
 {
+	TRACE_SCOPE("GraysKleinEditor rebuild");
 	_graysKlein->_N = val;
 	_graysKlein->buildMesh(_graysKlein->getSlices(), _graysKlein->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
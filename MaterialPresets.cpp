@@ -0,0 +1,71 @@
+#include "MaterialPresets.h"
+
+// The presets are shown under a white light without ambient contribution
+static const QVector3D LIGHT_AMBIENT(0.0f, 0.0f, 0.0f);
+static const QVector3D LIGHT_DIFFUSE(1.0f, 1.0f, 1.0f);
+static const QVector3D LIGHT_SPECULAR(0.5f, 0.5f, 0.5f);
+
+const std::vector<MaterialPreset>& materialPresets()
+{
+    static const std::vector<MaterialPreset> presets = {
+        { "brass", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.329412f, 0.223529f, 0.027451f), QVector3D(0.780392f, 0.568627f, 0.113725f), QVector3D(0.992157f, 0.941176f, 0.807843f), 128.0f * 0.21794872f },
+        { "bronze", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.2125f, 0.1275f, 0.054f), QVector3D(0.714f, 0.4284f, 0.18144f), QVector3D(0.393548f, 0.271906f, 0.166721f), 128.0f * 0.2f },
+        { "copper", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.19125f, 0.0735f, 0.0225f), QVector3D(0.7038f, 0.27048f, 0.0828f), QVector3D(0.256777f, 0.137622f, 0.086014f), 128.0f * 0.1f },
+        { "gold", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.24725f, 0.1995f, 0.0745f), QVector3D(0.75164f, 0.60648f, 0.22648f), QVector3D(0.628281f, 0.555802f, 0.366065f), 128.0f * 0.4f },
+        { "silver", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.19225f, 0.19225f, 0.19225f), QVector3D(0.50754f, 0.50654f, 0.50754f), QVector3D(0.508273f, 0.508273f, 0.508273f), 128.0f * 0.4f },
+        { "ruby", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.1745f, 0.01175f, 0.01175f), QVector3D(0.61424f, 0.04136f, 0.04136f), QVector3D(0.727811f, 0.626959f, 0.626959f), 128.0f * 0.6f },
+        { "emerald", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.0215f, 0.1745f, 0.0215f), QVector3D(0.07568f, 0.61424f, 0.07568f), QVector3D(0.633f, 0.727811f, 0.633f), 128.0f * 0.6f },
+        { "turquoise", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.1f, 0.18725f, 0.1745f), QVector3D(0.396f, 0.74151f, 0.69102f), QVector3D(0.297254f, 0.30829f, 0.306678f), 128.0f * 0.1f },
+        { "jade", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.135f, 0.2225f, 0.1575f), QVector3D(0.54f, 0.89f, 0.63f), QVector3D(0.316228f, 0.316228f, 0.316228f), 128.0f * 0.1f },
+        { "obsidian", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.05375f, 0.05f, 0.06625f), QVector3D(0.18275f, 0.17f, 0.22525f), QVector3D(0.332741f, 0.328634f, 0.346435f), 128.0f * 0.3f },
+        { "pearl", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.25f, 0.20725f, 0.20725f), QVector3D(1.0f, 0.829f, 0.829f), QVector3D(0.299948f, 0.296648f, 0.296648f), 128.0f * 0.088f },
+        { "chrome", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.25f, 0.25f, 0.25f), QVector3D(0.4f, 0.4f, 0.4f), QVector3D(0.774597f, 0.774597f, 0.774597f), 128.0f * 0.6f },
+        { "black-plastic", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.0f, 0.0f, 0.0f), QVector3D(0.01f, 0.01f, 0.01f), QVector3D(0.5f, 0.5f, 0.5f), 128.0f * 0.25f },
+        { "cyan-plastic", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.0f, 0.1f, 0.06f), QVector3D(0.0f, 0.50980392f, 0.50980392f), QVector3D(0.50196078f, 0.50196078f, 0.50196078f), 128.0f * 0.25f },
+        { "green-plastic", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.0f, 0.0f, 0.0f), QVector3D(0.1f, 0.35f, 0.1f), QVector3D(0.45f, 0.55f, 0.45f), 128.0f * 0.25f },
+        { "red-plastic", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.0f, 0.0f, 0.0f), QVector3D(0.5f, 0.0f, 0.0f), QVector3D(0.7f, 0.6f, 0.6f), 128.0f * 0.25f },
+        { "white-plastic", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.0f, 0.0f, 0.0f), QVector3D(0.55f, 0.55f, 0.55f), QVector3D(0.70f, 0.70f, 0.70f), 128.0f * 0.25f },
+        { "yellow-plastic", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.0f, 0.0f, 0.0f), QVector3D(0.5f, 0.5f, 0.0f), QVector3D(0.6f, 0.6f, 0.5f), 128.0f * 0.25f },
+        { "black-rubber", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.02f, 0.02f, 0.02f), QVector3D(0.01f, 0.01f, 0.01f), QVector3D(0.4f, 0.4f, 0.4f), 128.0f * 0.078125f },
+        { "cyan-rubber", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.0f, 0.05f, 0.05f), QVector3D(0.4f, 0.5f, 0.5f), QVector3D(0.04f, 0.7f, 0.7f), 128.0f * 0.078125f },
+        { "green-rubber", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.0f, 0.05f, 0.0f), QVector3D(0.4f, 0.5f, 0.4f), QVector3D(0.04f, 0.7f, 0.04f), 128.0f * 0.078125f },
+        { "red-rubber", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.05f, 0.0f, 0.0f), QVector3D(0.7f, 0.4f, 0.4f), QVector3D(0.7f, 0.04f, 0.04f), 128.0f * 0.078125f },
+        { "white-rubber", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.05f, 0.05f, 0.05f), QVector3D(0.5f, 0.5f, 0.5f), QVector3D(0.7f, 0.7f, 0.7f), 128.0f * 0.078125f },
+        { "yellow-rubber", LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR,
+          QVector3D(0.05f, 0.05f, 0.0f), QVector3D(0.5f, 0.5f, 0.4f), QVector3D(0.7f, 0.7f, 0.04f), 128.0f * 0.078125f }
+    };
+    return presets;
+}
+
+const MaterialPreset* findMaterialPreset(const QString& name)
+{
+    for (const MaterialPreset& preset : materialPresets())
+    {
+        if (name.compare(preset.name, Qt::CaseInsensitive) == 0)
+            return &preset;
+    }
+    return nullptr;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+
+#include <QString>
+#include <QVector3D>
+#include <QtOpenGL>
+
+
+/// A named material from the editor's preset buttons, with the light it is
+/// meant to be shown under
+struct MaterialPreset
+{
+    const char* name;       // Lower case, as used on the command line
+    QVector3D ambiLight;
+    QVector3D diffLight;
+    QVector3D specLight;
+    QVector3D ambiMat;
+    QVector3D diffMat;
+    QVector3D specMat;
+    GLfloat shine;
+};
+
+// All presets in the order of the editor's buttons
+const std::vector<MaterialPreset>& materialPresets();
+// Preset by name, case insensitive, nullptr if there is none
+const MaterialPreset* findMaterialPreset(const QString& name);
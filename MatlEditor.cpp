@@ -1,8 +1,16 @@
 #include <QApplication>
+#include <QInputDialog>
+#include <QMessageBox>
 #include "MatlEditor.h"
 #include "GLView.h"
 #include "SphericalHarmonicsEditor.h"
 #include "TriangleMesh.h"
+#include "MaterialPresets.h"
+#include "CpuTrace.h"
+#include "SessionRecorder.h"
+#include "StallWatchdog.h"
+#include "MemoryStatisticsDialog.h"
+#include "GLDebugLog.h"
 
 MatlEditor::MatlEditor(QWidget* parent) : QWidget(parent)
 {
@@ -17,6 +25,44 @@ MatlEditor::MatlEditor(QWidget* parent) : QWidget(parent)
 	trimetricView = new QAction(QIcon(":/new/prefix1/res/trimetric.png"), "Trimetric", this);
 	trimetricView->setObjectName(QString::fromUtf8("trimetricView"));
 	trimetricView->setShortcut(QKeySequence(Qt::Key_End));
+
+	// Keyboard only, the overlay is a developer tool
+	gpuProfilerOverlay = new QAction("GPU Profiler", this);
+	gpuProfilerOverlay->setObjectName(QString::fromUtf8("gpuProfilerOverlay"));
+	gpuProfilerOverlay->setShortcut(QKeySequence(Qt::Key_F3));
+	gpuProfilerOverlay->setCheckable(true);
+	addAction(gpuProfilerOverlay);
+
+	gpuProfilerExport = new QAction("Export GPU Profile", this);
+	gpuProfilerExport->setObjectName(QString::fromUtf8("gpuProfilerExport"));
+	gpuProfilerExport->setShortcut(QKeySequence(Qt::SHIFT + Qt::Key_F3));
+	addAction(gpuProfilerExport);
+
+	cpuTraceSave = new QAction("Save CPU Trace", this);
+	cpuTraceSave->setObjectName(QString::fromUtf8("cpuTraceSave"));
+	cpuTraceSave->setShortcut(QKeySequence(Qt::Key_F4));
+	addAction(cpuTraceSave);
+
+	sessionRecord = new QAction("Record Session", this);
+	sessionRecord->setObjectName(QString::fromUtf8("sessionRecord"));
+	sessionRecord->setShortcut(QKeySequence(Qt::Key_F5));
+	sessionRecord->setCheckable(true);
+	addAction(sessionRecord);
+	_sessionRecorder = nullptr;
+
+	stallHistogram = new QAction("GUI Stalls", this);
+	stallHistogram->setObjectName(QString::fromUtf8("stallHistogram"));
+	stallHistogram->setShortcut(QKeySequence(Qt::Key_F6));
+	addAction(stallHistogram);
+
+	memoryStatistics = new QAction("Memory", this);
+	memoryStatistics->setObjectName(QString::fromUtf8("memoryStatistics"));
+	memoryStatistics->setShortcut(QKeySequence(Qt::Key_F7));
+	addAction(memoryStatistics);
+
+	// Measures the responsiveness of the event loop for the whole session
+	_stallWatchdog = new StallWatchdog(this);
+	_stallWatchdog->start();
 	
 	setupUi(this);
 
@@ -35,6 +81,8 @@ MatlEditor::MatlEditor(QWidget* parent) : QWidget(parent)
 	QSurfaceFormat format = QSurfaceFormat::defaultFormat();
 	format.setSamples(4);
 	format.setStereo(true);
+	if (GLDebugLog::isRequested())
+		format.setOption(QSurfaceFormat::DebugContext);
 	_glView = new GLView(glframe, "glview");
 	_glView->setFormat(format);
 	// Put the GL widget inside the frame
@@ -90,6 +138,7 @@ void MatlEditor::on_textureButton_clicked()
 		"Images (*.bmp *.png *.xpm *.jpg)");
 	if (str != "")
 	{
+		TRACE_SCOPE("MatlEditor texture load");
 		if (!buf.load(str))
 		{	// Load first image from file
 			qWarning("Could not read image file, using single-color instead.");
@@ -246,6 +295,105 @@ void MatlEditor::on_toolButtonMultiView_toggled(bool checked)
 	_glView->updateView();
 }
 
+void MatlEditor::on_toolButtonSnapshot_clicked()
+{
+	QString fileName = QFileDialog::getSaveFileName(
+		this,
+		"Save Snapshot",
+		"snapshot.png",
+		"PNG Images (*.png);;All Images (*)");
+	if (fileName.isEmpty())
+		return;
+
+	// Sizes above the window size are drawn in tiles, e.g. 16384x16384 posters
+	bool ok = false;
+	QString size = QInputDialog::getText(this, "Snapshot Size", "Width x height in pixels:", QLineEdit::Normal,
+		QString("%1x%2").arg(_glView->width()).arg(_glView->height()), &ok);
+	QStringList dimensions = size.split('x');
+	if (!ok || dimensions.size() != 2 || dimensions[0].toInt() <= 0 || dimensions[1].toInt() <= 0)
+		return;
+
+	QApplication::setOverrideCursor(Qt::WaitCursor);
+	bool saved = _glView->saveSnapshot(fileName, QSize(dimensions[0].toInt(), dimensions[1].toInt()));
+	QApplication::restoreOverrideCursor();
+	if (!saved)
+		QMessageBox::warning(this, "Save Snapshot", "Could not save " + fileName +
+			"\nSnapshots drawn in tiles, larger than 4096 pixels, are saved as PNG only.");
+}
+
+void MatlEditor::on_gpuProfilerOverlay_toggled(bool checked)
+{
+	_glView->showGpuProfiler(checked);
+}
+
+void MatlEditor::on_gpuProfilerExport_triggered()
+{
+	QString fileName = QFileDialog::getSaveFileName(
+		this,
+		"Export GPU Profile",
+		"gpu-profile.csv",
+		"CSV Files (*.csv)");
+	if (fileName.isEmpty())
+		return;
+
+	if (!_glView->exportGpuProfile(fileName))
+		QMessageBox::warning(this, "Export GPU Profile", "Could not write " + fileName);
+}
+
+void MatlEditor::on_cpuTraceSave_triggered()
+{
+	if (!CpuTrace::isAvailable())
+	{
+		QMessageBox::information(this, "Save CPU Trace", "Tracing was compiled out of this build.");
+		return;
+	}
+
+	QString fileName = QFileDialog::getSaveFileName(
+		this,
+		"Save CPU Trace",
+		"cpu-trace.json",
+		"Chrome Trace Files (*.json)");
+	if (fileName.isEmpty())
+		return;
+
+	if (!CpuTrace::write(fileName))
+		QMessageBox::warning(this, "Save CPU Trace", "Could not write " + fileName);
+}
+
+void MatlEditor::on_sessionRecord_toggled(bool checked)
+{
+	if (checked)
+	{
+		_sessionRecorder = new SessionRecorder(this, _glView);
+		return;
+	}
+	if (!_sessionRecorder)
+		return;
+
+	QString fileName = QFileDialog::getSaveFileName(
+		this,
+		"Save Session",
+		"session.json",
+		"Session Files (*.json)");
+	if (!fileName.isEmpty() && !_sessionRecorder->save(fileName))
+		QMessageBox::warning(this, "Save Session", "Could not write " + fileName);
+
+	delete _sessionRecorder;
+	_sessionRecorder = nullptr;
+}
+
+void MatlEditor::on_stallHistogram_triggered()
+{
+	StallHistogramDialog* dialog = new StallHistogramDialog(_stallWatchdog, this);
+	dialog->show();
+}
+
+void MatlEditor::on_memoryStatistics_triggered()
+{
+	MemoryStatisticsDialog* dialog = new MemoryStatisticsDialog(this);
+	dialog->show();
+}
+
 void MatlEditor::on_pushButtonLightAmbient_clicked()
 {
 	QColor c = QColorDialog::getColor(QColor::fromRgbF(_glView->_ambiLight.x(), _glView->_ambiLight.y(), _glView->_ambiLight.z()), this, "Ambient Light Color");
@@ -391,568 +539,168 @@ void MatlEditor::on_sliderShine_valueChanged(int value)
 	_glView->updateView();
 }
 
-void MatlEditor::on_pushButtonBrass_clicked()
+void MatlEditor::applyPreset(const char* name)
 {
+	const MaterialPreset* preset = findMaterialPreset(name);
+	if (!preset)
+		return;
+
 	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
+	_glView->_ambiLight = QVector4D(preset->ambiLight, 1);
+	_glView->_diffLight = QVector4D(preset->diffLight, 1);
+	_glView->_specLight = QVector4D(preset->specLight, 1);
 
 	//Material Values
-	_glView->_ambiMat = { 0.329412f, 0.223529f,	0.027451f, 1 };
-	_glView->_diffMat = { 0.780392f, 0.568627f,	0.113725f, 1 };
-	_glView->_specMat = { 0.992157f, 0.941176f,	0.807843f, 1 };
-	_glView->_shine = fabs(128.0*0.21794872);
+	_glView->_ambiMat = QVector4D(preset->ambiMat, _glView->_opacity);
+	_glView->_diffMat = QVector4D(preset->diffMat, _glView->_opacity);
+	_glView->_specMat = QVector4D(preset->specMat, _glView->_opacity);
+	_glView->_shine = preset->shine;
 
 	_glView->updateView();
 	updateControls();
+}
 
+void MatlEditor::on_pushButtonBrass_clicked()
+{
+	applyPreset("brass");
 }
 
 
 void MatlEditor::on_pushButtonBronze_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat = { 0.2125f, 0.1275f, 0.054f, 1 };
-	_glView->_diffMat = { 0.714f, 0.4284f, 0.18144f, 1 };
-	_glView->_specMat = { 0.393548f, 0.271906f, 0.166721f, 1 };
-	_glView->_shine = fabs(128.0*0.2);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("bronze");
 }
 
 
 void MatlEditor::on_pushButtonCopper_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.19125f;
-	_glView->_ambiMat[1] = 0.0735f;
-	_glView->_ambiMat[2] = 0.0225f;
-	_glView->_diffMat[0] = 0.7038f;
-	_glView->_diffMat[1] = 0.27048f;
-	_glView->_diffMat[2] = 0.0828f;
-	_glView->_specMat[0] = 0.256777f;
-	_glView->_specMat[1] = 0.137622f;
-	_glView->_specMat[2] = 0.086014f;
-	_glView->_shine = fabs(128.0*0.1);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("copper");
 }
 
 
 void MatlEditor::on_pushButtonGold_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.24725f;
-	_glView->_ambiMat[1] = 0.1995f;
-	_glView->_ambiMat[2] = 0.0745f;
-	_glView->_diffMat[0] = 0.75164f;
-	_glView->_diffMat[1] = 0.60648f;
-	_glView->_diffMat[2] = 0.22648f;
-	_glView->_specMat[0] = 0.628281f;
-	_glView->_specMat[1] = 0.555802f;
-	_glView->_specMat[2] = 0.366065f;
-	_glView->_shine = fabs(128.0*0.4);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("gold");
 }
 
 
 void MatlEditor::on_pushButtonSilver_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.19225f;
-	_glView->_ambiMat[1] = 0.19225f;
-	_glView->_ambiMat[2] = 0.19225f;
-	_glView->_diffMat[0] = 0.50754f;
-	_glView->_diffMat[1] = 0.50654f;
-	_glView->_diffMat[2] = 0.50754f;
-	_glView->_specMat[0] = 0.508273f;
-	_glView->_specMat[1] = 0.508273f;
-	_glView->_specMat[2] = 0.508273f;
-	_glView->_shine = fabs(128.0*0.4);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("silver");
 }
 
 
 void MatlEditor::on_pushButtonRuby_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.1745f;
-	_glView->_ambiMat[1] = 0.01175f;
-	_glView->_ambiMat[2] = 0.01175f;
-	_glView->_diffMat[0] = 0.61424f;
-	_glView->_diffMat[1] = 0.04136f;
-	_glView->_diffMat[2] = 0.04136f;
-	_glView->_specMat[0] = 0.727811f;
-	_glView->_specMat[1] = 0.626959f;
-	_glView->_specMat[2] = 0.626959f;
-	_glView->_shine = fabs(128.0*0.6);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("ruby");
 }
 
 
 void MatlEditor::on_pushButtonEmerald_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.0215f;
-	_glView->_ambiMat[1] = 0.1745f;
-	_glView->_ambiMat[2] = 0.0215f;
-	_glView->_diffMat[0] = 0.07568f;
-	_glView->_diffMat[1] = 0.61424f;
-	_glView->_diffMat[2] = 0.07568f;
-	_glView->_specMat[0] = 0.633f;
-	_glView->_specMat[1] = 0.727811f;
-	_glView->_specMat[2] = 0.633f;
-	_glView->_shine = fabs(128.0*0.6);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("emerald");
 }
 
 
 void MatlEditor::on_pushButtonTurquoise_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.1f;
-	_glView->_ambiMat[1] = 0.18725f;
-	_glView->_ambiMat[2] = 0.1745f;
-	_glView->_diffMat[0] = 0.396f;
-	_glView->_diffMat[1] = 0.74151f;
-	_glView->_diffMat[2] = 0.69102f;
-	_glView->_specMat[0] = 0.297254f;
-	_glView->_specMat[1] = 0.30829f;
-	_glView->_specMat[2] = 0.306678f;
-	_glView->_shine = fabs(128.0*0.1);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("turquoise");
 }
 
 void MatlEditor::on_pushButtonJade_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.135f;
-	_glView->_ambiMat[1] = 0.2225f;
-	_glView->_ambiMat[2] = 0.1575f;
-	_glView->_diffMat[0] = 0.54f;
-	_glView->_diffMat[1] = 0.89f;
-	_glView->_diffMat[2] = 0.63f;
-	_glView->_specMat[0] = 0.316228f;
-	_glView->_specMat[1] = 0.316228f;
-	_glView->_specMat[2] = 0.316228f;
-	_glView->_shine = fabs(128.0*0.1);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("jade");
 }
 
 
 void MatlEditor::on_pushButtonObsidian_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.05375f;
-	_glView->_ambiMat[1] = 0.05f;
-	_glView->_ambiMat[2] = 0.06625f;
-	_glView->_diffMat[0] = 0.18275f;
-	_glView->_diffMat[1] = 0.17f;
-	_glView->_diffMat[2] = 0.22525f;
-	_glView->_specMat[0] = 0.332741f;
-	_glView->_specMat[1] = 0.328634f;
-	_glView->_specMat[2] = 0.346435f;
-	_glView->_shine = fabs(128.0*0.3);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("obsidian");
 }
 
 
 void MatlEditor::on_pushButtonPearl_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.25f;
-	_glView->_ambiMat[1] = 0.20725f;
-	_glView->_ambiMat[2] = 0.20725f;
-	_glView->_diffMat[0] = 1.0f;
-	_glView->_diffMat[1] = 0.829f;
-	_glView->_diffMat[2] = 0.829f;
-	_glView->_specMat[1] = 0.296648f;
-	_glView->_specMat[2] = 0.296648f;
-	_glView->_specMat[0] = 0.299948f;
-	_glView->_shine = fabs(128.0*0.088);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("pearl");
 }
 
 
 void MatlEditor::on_pushButtonChrome_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.25f;
-	_glView->_ambiMat[1] = 0.25f;
-	_glView->_ambiMat[2] = 0.25f;
-	_glView->_diffMat[0] = 0.4f;
-	_glView->_diffMat[1] = 0.4f;
-	_glView->_diffMat[2] = 0.4f;
-	_glView->_specMat[0] = 0.774597f;
-	_glView->_specMat[1] = 0.774597f;
-	_glView->_specMat[2] = 0.774597f;
-	_glView->_shine = fabs(128.0*0.6);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("chrome");
 }
 
 
 
 void MatlEditor::on_pushButtonBlackPlastic_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.0f;
-	_glView->_ambiMat[1] = 0.0f;
-	_glView->_ambiMat[2] = 0.0f;
-	_glView->_diffMat[0] = 0.01f;
-	_glView->_diffMat[1] = 0.01f;
-	_glView->_diffMat[2] = 0.01f;
-	_glView->_specMat[0] = 0.5f;
-	_glView->_specMat[1] = 0.5f;
-	_glView->_specMat[2] = 0.5f;
-	_glView->_shine = fabs(128.0*0.25);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("black-plastic");
 }
 
 
 void MatlEditor::on_pushButtonCyanPlastic_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.0f;
-	_glView->_ambiMat[1] = 0.1f;
-	_glView->_ambiMat[2] = 0.06f;
-	_glView->_diffMat[0] = 0.0f;
-	_glView->_diffMat[1] = 0.50980392f;
-	_glView->_diffMat[2] = 0.50980392f;
-	_glView->_specMat[0] = 0.50196078f;
-	_glView->_specMat[1] = 0.50196078f;
-	_glView->_specMat[2] = 0.50196078f;
-	_glView->_shine = fabs(128.0*0.25);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("cyan-plastic");
 }
 
 
 void MatlEditor::on_pushButtonGreenPlastic_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.0f;
-	_glView->_ambiMat[1] = 0.0f;
-	_glView->_ambiMat[2] = 0.0f;
-	_glView->_diffMat[0] = 0.1f;
-	_glView->_diffMat[1] = 0.35f;
-	_glView->_diffMat[2] = 0.1f;
-	_glView->_specMat[0] = 0.45f;
-	_glView->_specMat[1] = 0.55f;
-	_glView->_specMat[2] = 0.45f;
-	_glView->_shine = fabs(128.0*0.25);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("green-plastic");
 }
 
 
 void MatlEditor::on_pushButtonRedPlastic_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.0f;
-	_glView->_ambiMat[1] = 0.0f;
-	_glView->_ambiMat[2] = 0.0f;
-	_glView->_diffMat[0] = 0.5f;
-	_glView->_diffMat[1] = 0.0f;
-	_glView->_diffMat[2] = 0.0f;
-	_glView->_specMat[0] = 0.7f;
-	_glView->_specMat[1] = 0.6f;
-	_glView->_specMat[2] = 0.6f;
-	_glView->_shine = fabs(128.0*0.25);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("red-plastic");
 }
 
 
 void MatlEditor::on_pushButtonWhitePlastic_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.0f;
-	_glView->_ambiMat[1] = 0.0f;
-	_glView->_ambiMat[2] = 0.0f;
-	_glView->_diffMat[0] = 0.55f;
-	_glView->_diffMat[1] = 0.55f;
-	_glView->_diffMat[2] = 0.55f;
-	_glView->_specMat[0] = 0.70f;
-	_glView->_specMat[1] = 0.70f;
-	_glView->_specMat[2] = 0.70f;
-	_glView->_shine = fabs(128.0*0.25);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("white-plastic");
 }
 
 
 void MatlEditor::on_pushButtonYellowPlastic_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.0f;
-	_glView->_ambiMat[1] = 0.0f;
-	_glView->_ambiMat[2] = 0.0f;
-	_glView->_diffMat[0] = 0.5f;
-	_glView->_diffMat[1] = 0.5f;
-	_glView->_diffMat[2] = 0.0f;
-	_glView->_specMat[0] = 0.6f;
-	_glView->_specMat[1] = 0.6f;
-	_glView->_specMat[2] = 0.5f;
-	_glView->_shine = fabs(128.0*0.25);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("yellow-plastic");
 }
 
 
 void MatlEditor::on_pushButtonBlackRubber_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.02f;
-	_glView->_ambiMat[1] = 0.02f;
-	_glView->_ambiMat[2] = 0.02f;
-	_glView->_diffMat[0] = 0.01f;
-	_glView->_diffMat[1] = 0.01f;
-	_glView->_diffMat[2] = 0.01f;
-	_glView->_specMat[0] = 0.4f;
-	_glView->_specMat[1] = 0.4f;
-	_glView->_specMat[2] = 0.4f;
-	_glView->_shine = fabs(128.0*0.078125);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("black-rubber");
 }
 
 
 void MatlEditor::on_pushButtonCyanRubber_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.0f;
-	_glView->_ambiMat[1] = 0.05f;
-	_glView->_ambiMat[2] = 0.05f;
-	_glView->_diffMat[0] = 0.4f;
-	_glView->_diffMat[1] = 0.5f;
-	_glView->_diffMat[2] = 0.5f;
-	_glView->_specMat[0] = 0.04f;
-	_glView->_specMat[1] = 0.7f;
-	_glView->_specMat[2] = 0.7f;
-	_glView->_shine = fabs(128.0*0.078125);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("cyan-rubber");
 }
 
 
 void MatlEditor::on_pushButtonGreenRubber_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.0f;
-	_glView->_ambiMat[1] = 0.05f;
-	_glView->_ambiMat[2] = 0.0f;
-	_glView->_diffMat[0] = 0.4f;
-	_glView->_diffMat[1] = 0.5f;
-	_glView->_diffMat[2] = 0.4f;
-	_glView->_specMat[0] = 0.04f;
-	_glView->_specMat[1] = 0.7f;
-	_glView->_specMat[2] = 0.04f;
-	_glView->_shine = fabs(128.0*0.078125);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("green-rubber");
 }
 
 
 void MatlEditor::on_pushButtonRedRubber_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.05f;
-	_glView->_ambiMat[1] = 0.0f;
-	_glView->_ambiMat[2] = 0.0f;
-	_glView->_diffMat[0] = 0.7f;
-	_glView->_diffMat[1] = 0.4f;
-	_glView->_diffMat[2] = 0.4f;
-	_glView->_specMat[0] = 0.7f;
-	_glView->_specMat[1] = 0.04f;
-	_glView->_specMat[2] = 0.04f;
-	_glView->_shine = fabs(128.0*0.078125);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("red-rubber");
 }
 
 
 void MatlEditor::on_pushButtonWhiteRubber_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.05f;
-	_glView->_ambiMat[1] = 0.05f;
-	_glView->_ambiMat[2] = 0.05f;
-	_glView->_diffMat[0] = 0.5f;
-	_glView->_diffMat[1] = 0.5f;
-	_glView->_diffMat[2] = 0.5f;
-	_glView->_specMat[0] = 0.7f;
-	_glView->_specMat[1] = 0.7f;
-	_glView->_specMat[2] = 0.7f;
-	_glView->_shine = fabs(128.0*0.078125);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("white-rubber");
 }
 
 
 void MatlEditor::on_pushButtonYellowRubber_clicked()
 {
-	//Light Values 
-	_glView->_ambiLight = { 0, 0, 0, 1 };
-	_glView->_diffLight = { 1, 1, 1, 1 };
-	_glView->_specLight = { 0.5, 0.5, 0.5, 1 };
-
-	//Material Values
-	_glView->_ambiMat[0] = 0.05f;
-	_glView->_ambiMat[1] = 0.05f;
-	_glView->_ambiMat[2] = 0.0f;
-	_glView->_diffMat[0] = 0.5f;
-	_glView->_diffMat[1] = 0.5f;
-	_glView->_diffMat[2] = 0.4f;
-	_glView->_specMat[0] = 0.7f;
-	_glView->_specMat[1] = 0.7f;
-	_glView->_specMat[2] = 0.04f;
-	_glView->_shine = fabs(128.0*0.078125);
-
-	_glView->updateView();
-	updateControls();
+	applyPreset("yellow-rubber");
 }
 
 void MatlEditor::on_comboBoxModel_currentIndexChanged(int index)
@@ -6,6 +6,8 @@
 
 class GLView;
 class SphericalHarmonicsEditor;
+class SessionRecorder;
+class StallWatchdog;
 class MatlEditor : public QWidget, private Ui::MatlEditor
 {
 	Q_OBJECT
@@ -34,10 +36,18 @@ private slots:
 	void on_toolButtonProjection_toggled(bool checked);
 	void on_toolButtonSectionView_toggled(bool checked);
 	void on_toolButtonMultiView_toggled(bool checked);
+	void on_toolButtonSnapshot_clicked();
 	
 	void on_isometricView_triggered(bool checked);
 	void on_dimetricView_triggered(bool checked);
 	void on_trimetricView_triggered(bool checked);
+
+	void on_gpuProfilerOverlay_toggled(bool checked);
+	void on_gpuProfilerExport_triggered();
+	void on_cpuTraceSave_triggered();
+	void on_sessionRecord_toggled(bool checked);
+	void on_stallHistogram_triggered();
+	void on_memoryStatistics_triggered();
 	
 	void on_pushButtonLightAmbient_clicked();
 	void on_pushButtonLightDiffuse_clicked();
@@ -91,9 +101,21 @@ private:
 	QAction* isometricView;
 	QAction* dimetricView;
 	QAction* trimetricView;
+	QAction* gpuProfilerOverlay;
+	QAction* gpuProfilerExport;
+	QAction* cpuTraceSave;
+	QAction* sessionRecord;
+
+	SessionRecorder* _sessionRecorder;
+
+	QAction* stallHistogram;
+	StallWatchdog* _stallWatchdog;
+	QAction* memoryStatistics;
 
 private:
 	void updateControls();
+	// Light and material of one of the preset buttons, the opacity is kept
+	void applyPreset(const char* name);
 	void updateComboBox();
 };
 
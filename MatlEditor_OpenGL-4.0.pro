@@ -28,7 +28,7 @@ CONFIG += console
 }
 }
 
-QT += core gui widgets opengl
+QT += core gui widgets opengl network
 
 win32:RC_ICONS += res\MatlEditor.ico
 
@@ -43,9 +43,13 @@ DEFINES += QT_DEPRECATED_WARNINGS
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# CPU trace scopes, build with CONFIG+=notrace to compile them out
+!notrace: DEFINES += MATLEDITOR_TRACE
+
 # Input
 HEADERS += AABB.h \
 AppleSurface.h \
+BatchRenderer.h \
 BentHorns.h \
 BoundingSphere.h \
 BowTie.h \
@@ -53,31 +57,47 @@ BoySurface.h \
 BreatherSurface.h \
 Cone.h \
 ConeShell.h \
+CpuTrace.h \
 Crescent.h \
 Cube.h \
 Cylinder.h \
 DoubleCone.h \
 Drawable.h \
+DrawStatistics.h \
 Figure8KleinBottle.h \
 Folium.h \
+FrameRecorder.h \
+GLDebugLog.h \
 GLView.h \
 GLCamera.h \
+GlyphCache.h \
+GpuProfiler.h \
 GraysKlein.h \
 Horn.h \
 IDrawable.h \
 IParametricSurface.h \
 KleinBottle.h \
 LimpetTorus.h \
+MaterialPresets.h \
 MatlEditor.h \
 MainWindow.h \
+MemoryStatistics.h \
+MemoryStatisticsDialog.h \
+ModelCatalogue.h \
 ObjMesh.h \
+OffscreenRenderer.h \
 ParametricSurface.h \
 Periwinkle.h \
 Plane.h \
 Point.h \
 QuadMesh.h \
+RenderDaemon.h \
+RenderThread.h \
 Resource.h \
 SaddleTorus.h \
+SceneRenderer.h \
+SessionRecorder.h \
+SnapshotWriter.h \
 Sphere.h \
 SphericalHarmonic.h \
 SpindleShell.h \
@@ -85,6 +105,7 @@ SteinerSurface.h \
 SuperToroid.h \
 SuperEllipsoid.h \
 Spring.h \
+StallWatchdog.h \
 Teapot.h \
 TeapotData.h \
 TextRenderer.h \
@@ -98,6 +119,7 @@ TwistedTriaxial.h \
 TurretShell.h \
 ui_MatlEditor.h \
 VerrillMinimal.h \
+ViewBenchmark.h \
 WrinkledPeriwinkle.h \
 ParametricSurface.h \
 SphericalHarmonicsEditor.h \
@@ -115,6 +137,7 @@ SuperToroidEditor.ui \
 SuperEllipsoidEditor.ui \
 SpringEditor.ui
 SOURCES += AppleSurface.cpp \
+BatchRenderer.cpp \
 BentHorns.cpp \
 BoundingSphere.cpp \
 BowTie.cpp \
@@ -122,28 +145,44 @@ BoySurface.cpp \
 BreatherSurface.cpp \
 Cone.cpp \
 ConeShell.cpp \
+CpuTrace.cpp \
 Crescent.cpp \
 Cube.cpp \
 Cylinder.cpp \
 DoubleCone.cpp \
+DrawStatistics.cpp \
 Figure8KleinBottle.cpp \
 Folium.cpp \
+FrameRecorder.cpp \
+GLDebugLog.cpp \
 GLView.cpp \
 GLCamera.cpp \
+GlyphCache.cpp \
+GpuProfiler.cpp \
 GraysKlein.cpp \
 Horn.cpp \
 KleinBottle.cpp \
 LimpetTorus.cpp \
 main.cpp \
+MaterialPresets.cpp \
 MatlEditor.cpp \
 MainWindow.cpp \
+MemoryStatistics.cpp \
+MemoryStatisticsDialog.cpp \
+ModelCatalogue.cpp \
 ObjMesh.cpp \
+OffscreenRenderer.cpp \
 ParametricSurface.cpp \
 Periwinkle.cpp \
 Plane.cpp \
 Point.cpp \
 QuadMesh.cpp \
+RenderDaemon.cpp \
+RenderThread.cpp \
 SaddleTorus.cpp \
+SceneRenderer.cpp \
+SessionRecorder.cpp \
+SnapshotWriter.cpp \
 Sphere.cpp \
 SphericalHarmonic.cpp \
 SpindleShell.cpp \
@@ -151,6 +190,7 @@ SteinerSurface.cpp \
 SuperToroid.cpp \
 SuperEllipsoid.cpp \
 Spring.cpp \
+StallWatchdog.cpp \
 Teapot.cpp \
 TextRenderer.cpp \
 TopShell.cpp \
@@ -162,6 +202,7 @@ TwistedPseudoSphere.cpp \
 TwistedTriaxial.cpp \
 TurretShell.cpp \
 VerrillMinimal.cpp \
+ViewBenchmark.cpp \
 WrinkledPeriwinkle.cpp \
 SphericalHarmonicsEditor.cpp \
 ClippingPlanesEditor.cpp \
@@ -175,8 +216,10 @@ OTHER_FILES += \
 shaders/background.frag   shaders/twoside_per_fragment.frag \
 shaders/blinn-phong.frag  shaders/twoside_per_vertex.frag \
 shaders/splitScreen.frag  shaders/wireframe.frag \
-shaders/text.frag \
+shaders/text.frag     shaders/upscale.frag \
 shaders/background.vert   shaders/twoside_per_fragment.vert \
+shaders/twoside_multiview.vert \
 shaders/blinn-phong.vert  shaders/twoside_per_vertex.vert \
 shaders/splitScreen.vert  shaders/wireframe.vert \
-shaders/text.vert
+shaders/text.vert \
+shaders/label.frag     shaders/label.vert
@@ -0,0 +1,136 @@
+#include "MemoryStatistics.h"
+
+#include <QHash>
+#include <QMutex>
+
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+    struct Allocation
+    {
+        MemoryStatistics::Entry entry;
+        int growths;              // Updates in a row that added handles
+        bool reported;
+    };
+
+    // Growing by this many updates in a row is not a rebuild any more
+    const int LEAK_GROWTHS = 3;
+
+    QMutex mutex;
+    QHash<const void*, Allocation> allocations;
+    QHash<QString, MemoryStatistics::Entry> transients;
+}
+
+void MemoryStatistics::setAllocation(Kind kind, const void* owner, const QString& name, long long bytes, int handles)
+{
+    QMutexLocker locker(&mutex);
+    auto it = allocations.find(owner);
+    if (it == allocations.end())
+    {
+        allocations.insert(owner, { { kind, name, bytes, bytes, 1, handles }, 0, false });
+        return;
+    }
+
+    Allocation& allocation = it.value();
+    allocation.growths = handles > allocation.entry.handles ? allocation.growths + 1 : 0;
+    allocation.entry.kind = kind;
+    allocation.entry.name = name;
+    allocation.entry.bytes = bytes;
+    allocation.entry.peakBytes = std::max(allocation.entry.peakBytes, bytes);
+    allocation.entry.updates++;
+    allocation.entry.handles = handles;
+
+    if (allocation.growths >= LEAK_GROWTHS && !allocation.reported)
+    {
+        allocation.reported = true;
+        std::cout << "Possible leak: " << name.toStdString() << " holds " << handles << " "
+                  << kindName(kind) << " handles after " << allocation.entry.updates << " updates" << std::endl;
+    }
+}
+
+void MemoryStatistics::release(const void* owner)
+{
+    QMutexLocker locker(&mutex);
+    allocations.remove(owner);
+}
+
+void MemoryStatistics::recordTransient(const QString& name, long long bytes)
+{
+    QMutexLocker locker(&mutex);
+    auto it = transients.find(name);
+    if (it == transients.end())
+    {
+        transients.insert(name, { CPU_TRANSIENT, name, bytes, bytes, 1, 0 });
+        return;
+    }
+    it->bytes = bytes;
+    it->peakBytes = std::max(it->peakBytes, bytes);
+    it->updates++;
+}
+
+long long MemoryStatistics::total(Kind kind)
+{
+    QMutexLocker locker(&mutex);
+    long long total = 0;
+    if (kind == CPU_TRANSIENT)
+    {
+        // Transients do not add up, they are not held at the same time
+        for (const Entry& entry : transients)
+            total = std::max(total, entry.peakBytes);
+        return total;
+    }
+    for (const Allocation& allocation : allocations)
+    {
+        if (allocation.entry.kind == kind)
+            total += allocation.entry.bytes;
+    }
+    return total;
+}
+
+std::vector<MemoryStatistics::Entry> MemoryStatistics::entries()
+{
+    std::vector<Entry> result;
+    {
+        QMutexLocker locker(&mutex);
+        for (const Allocation& allocation : allocations)
+            result.push_back(allocation.entry);
+        for (const Entry& entry : transients)
+            result.push_back(entry);
+    }
+    std::sort(result.begin(), result.end(), [](const Entry& a, const Entry& b)
+    {
+        return std::max(a.bytes, a.peakBytes) > std::max(b.bytes, b.peakBytes);
+    });
+    return result;
+}
+
+long long MemoryStatistics::textureBytes(int width, int height, int bytesPerTexel, bool mipmapped, int layers)
+{
+    long long bytes = 0;
+    while (true)
+    {
+        bytes += static_cast<long long>(width) * height * bytesPerTexel * layers;
+        if (!mipmapped || (width == 1 && height == 1))
+            break;
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    return bytes;
+}
+
+const char* MemoryStatistics::kindName(Kind kind)
+{
+    switch (kind)
+    {
+    case GPU_BUFFER:
+        return "buffer";
+    case GPU_TEXTURE:
+        return "texture";
+    case CPU_TRANSIENT:
+        return "transient";
+    default:
+        return "";
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+
+#include <QString>
+
+// Bytes held by the meshes, textures and glyph pages on the GPU and the peak
+// of the temporary CPU buffers used to build them, reported by every owner
+// on any thread. Shown by MemoryStatisticsDialog.
+//
+// The GPU sizes are what was uploaded, drivers may pad or keep copies.
+class MemoryStatistics
+{
+public:
+    enum Kind { GPU_BUFFER, GPU_TEXTURE, CPU_TRANSIENT, KIND_COUNT };
+
+    struct Entry
+    {
+        Kind kind;
+        QString name;
+        long long bytes;          // Now, the last use for transients
+        long long peakBytes;
+        int updates;              // Allocations or uses counted
+        int handles;              // Buffers or textures behind the bytes
+    };
+
+    // What the owner holds now, replacing what it reported before. An owner
+    // whose handles keep growing from one update to the next is reported as
+    // a leak, buffers are expected to be reused when rebuilt.
+    static void setAllocation(Kind kind, const void* owner, const QString& name, long long bytes, int handles = 1);
+    static void release(const void* owner);
+    // Temporary memory of one run of a piece of work, freed when it returned
+    static void recordTransient(const QString& name, long long bytes);
+
+    static long long total(Kind kind);
+    // The owners and transients, largest first
+    static std::vector<Entry> entries();
+
+    // Bytes of a texture with all levels of its mip chain
+    static long long textureBytes(int width, int height, int bytesPerTexel, bool mipmapped, int layers = 1);
+    // Bytes of the elements a vector reserved
+    template <typename T>
+    static long long vectorBytes(const std::vector<T>& v) { return static_cast<long long>(v.capacity() * sizeof(T)); }
+
+    static const char* kindName(Kind kind);
+};
@@ -0,0 +1,85 @@
+#include "MemoryStatisticsDialog.h"
+#include "MemoryStatistics.h"
+
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QTimer>
+#include <QVBoxLayout>
+
+MemoryStatisticsDialog::MemoryStatisticsDialog(QWidget* parent) :
+    QDialog(parent)
+{
+    setWindowTitle("Memory");
+    setAttribute(Qt::WA_DeleteOnClose);
+    resize(640, 480);
+
+    _totals = new QLabel(this);
+
+    _table = new QTableWidget(0, 6, this);
+    _table->setHorizontalHeaderLabels({ "Kind", "Owner", "Bytes", "Peak", "Updates", "Handles" });
+    _table->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
+    _table->verticalHeader()->hide();
+    _table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    _table->setSelectionBehavior(QAbstractItemView::SelectRows);
+
+    QPushButton* closeButton = new QPushButton("Close", this);
+    connect(closeButton, SIGNAL(clicked()), this, SLOT(close()));
+
+    QHBoxLayout* buttons = new QHBoxLayout();
+    buttons->addStretch(1);
+    buttons->addWidget(closeButton);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->addWidget(_totals);
+    layout->addWidget(_table, 1);
+    layout->addLayout(buttons);
+
+    _timer = new QTimer(this);
+    connect(_timer, SIGNAL(timeout()), this, SLOT(refresh()));
+    _timer->start(1000);
+    refresh();
+}
+
+QString MemoryStatisticsDialog::formatBytes(long long bytes)
+{
+    if (bytes < 1024)
+        return QString("%1 B").arg(bytes);
+    if (bytes < 1024 * 1024)
+        return QString("%1 KiB").arg(bytes / 1024.0, 0, 'f', 1);
+    if (bytes < 1024LL * 1024 * 1024)
+        return QString("%1 MiB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+    return QString("%1 GiB").arg(bytes / (1024.0 * 1024.0 * 1024.0), 0, 'f', 2);
+}
+
+void MemoryStatisticsDialog::refresh()
+{
+    _totals->setText(QString("GPU buffers %1, GPU textures %2, largest CPU transient %3")
+                         .arg(formatBytes(MemoryStatistics::total(MemoryStatistics::GPU_BUFFER)))
+                         .arg(formatBytes(MemoryStatistics::total(MemoryStatistics::GPU_TEXTURE)))
+                         .arg(formatBytes(MemoryStatistics::total(MemoryStatistics::CPU_TRANSIENT))));
+
+    std::vector<MemoryStatistics::Entry> entries = MemoryStatistics::entries();
+    _table->setRowCount(static_cast<int>(entries.size()));
+    for (int row = 0; row < static_cast<int>(entries.size()); row++)
+    {
+        const MemoryStatistics::Entry& entry = entries[row];
+        QStringList cells = {
+            MemoryStatistics::kindName(entry.kind),
+            entry.name,
+            formatBytes(entry.bytes),
+            formatBytes(entry.peakBytes),
+            QString::number(entry.updates),
+            entry.kind == MemoryStatistics::CPU_TRANSIENT ? QString() : QString::number(entry.handles)
+        };
+        for (int column = 0; column < cells.size(); column++)
+        {
+            QTableWidgetItem* item = new QTableWidgetItem(cells[column]);
+            if (column >= 2)
+                item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            _table->setItem(row, column, item);
+        }
+    }
+}
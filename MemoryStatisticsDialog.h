@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QDialog>
+
+class QLabel;
+class QTableWidget;
+class QTimer;
+
+
+// Shows the totals of MemoryStatistics and what every owner holds, refreshed while open
+class MemoryStatisticsDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    MemoryStatisticsDialog(QWidget* parent = nullptr);
+
+    // Bytes with a binary unit, e.g. "12.5 MiB"
+    static QString formatBytes(long long bytes);
+
+private slots:
+    void refresh();
+
+private:
+    QLabel* _totals;
+    QTableWidget* _table;
+    QTimer* _timer;
+};
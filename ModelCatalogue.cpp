@@ -0,0 +1,146 @@
+#include "ModelCatalogue.h"
+
+#include "Cube.h"
+#include "Sphere.h"
+#include "Cylinder.h"
+#include "Cone.h"
+#include "Torus.h"
+#include "Teapot.h"
+#include "KleinBottle.h"
+#include "Figure8KleinBottle.h"
+#include "BoySurface.h"
+#include "TwistedTriaxial.h"
+#include "SteinerSurface.h"
+#include "AppleSurface.h"
+#include "DoubleCone.h"
+#include "BentHorns.h"
+#include "Folium.h"
+#include "LimpetTorus.h"
+#include "SaddleTorus.h"
+#include "BowTie.h"
+#include "TriaxialTritorus.h"
+#include "TriaxialHexatorus.h"
+#include "VerrillMinimal.h"
+#include "Horn.h"
+#include "Crescent.h"
+#include "ConeShell.h"
+#include "Periwinkle.h"
+#include "TopShell.h"
+#include "WrinkledPeriwinkle.h"
+#include "SpindleShell.h"
+#include "TurretShell.h"
+#include "TwistedPseudoSphere.h"
+#include "BreatherSurface.h"
+#include "Spring.h"
+#include "SuperToroid.h"
+#include "SuperEllipsoid.h"
+#include "GraysKlein.h"
+#include "SphericalHarmonic.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <vector>
+
+using glm::vec3;
+using glm::mat4;
+
+// Model parameter from a job, the constructor default when it is not given
+static GLfloat parameter(const QVariantMap& parameters, const char* name, GLfloat value)
+{
+    return parameters.contains(name) ? parameters.value(name).toFloat() : value;
+}
+
+// Name and factory of one model, in the order GLView shows them
+struct CatalogueEntry
+{
+    const char* name;
+    TriangleMesh* (*create)(QOpenGLShaderProgram* prog, const QVariantMap& parameters);
+};
+
+static const std::vector<CatalogueEntry>& entries()
+{
+    static const std::vector<CatalogueEntry> catalogue = {
+        { "Cube", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new Cube(prog, 100.0f); } },
+        { "Sphere", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new Sphere(prog, 75.0f, 50.0f, 50.0f); } },
+        { "Cylinder", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new Cylinder(prog, 60.0f, 100.0f, 100.0f, 1.0f); } },
+        { "Cone", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new Cone(prog, 60.0f, 100.0f, 100.0f, 1.0f); } },
+        { "Torus", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new Torus(prog, 50.0f, 25.0f, 100.0f, 100.0f); } },
+        { "Teapot", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new Teapot(prog, 35.0f, 50, glm::translate(mat4(1.0f), vec3(0.0f, 15.0f, 25.0f))); } },
+        { "Klein Bottle", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new KleinBottle(prog, 30.0f, 150.0f, 150.0f); } },
+        { "Figure 8 Klein Bottle", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new Figure8KleinBottle(prog, 30.0f, 150.0f, 150.0f); } },
+        { "Boy's Surface", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new BoySurface(prog, 60.0f, 150.0f, 150.0f); } },
+        { "Twisted Triaxial", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new TwistedTriaxial(prog, 110.0f, 150.0f, 150.0f); } },
+        { "Steiner Surface", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new SteinerSurface(prog, 150.0f, 150.0f, 150.0f); } },
+        { "Apple Surface", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new AppleSurface(prog, 7.5f, 150.0f, 150.0f); } },
+        { "Double Cone", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new DoubleCone(prog, 35.0f, 150.0f, 150.0f); } },
+        { "Bent Horns", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new BentHorns(prog, 15.0f, 150.0f, 150.0f); } },
+        { "Folium", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new Folium(prog, 75.0f, 150.0f, 150.0f); } },
+        { "Limpet Torus", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new LimpetTorus(prog, 35.0f, 150.0f, 150.0f); } },
+        { "Saddle Torus", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new SaddleTorus(prog, 30.0f, 150.0f, 150.0f); } },
+        { "Bow Tie", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new BowTie(prog, 40.0f, 150.0f, 150.0f); } },
+        { "Triaxial Tritorus", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new TriaxialTritorus(prog, 45.0f, 150.0f, 150.0f); } },
+        { "Triaxial Hexatorus", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new TriaxialHexatorus(prog, 45.0f, 150.0f, 150.0f); } },
+        { "Verrill Minimal Surface", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new VerrillMinimal(prog, 25.0f, 150.0f, 150.0f); } },
+        { "Horn", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new Horn(prog, 30.0f, 150.0f, 150.0f); } },
+        { "Crescent", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new Crescent(prog, 30.0f, 150.0f, 150.0f); } },
+        { "Cone Sea Shell", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new ConeShell(prog, 45.0f, 150.0f, 150.0f); } },
+        { "Periwinkle Sea Shell", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new Periwinkle(prog, 40.0f, 150.0f, 150.0f); } },
+        { "Top Sea Shell", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new TopShell(prog, Point(-50,0,0), 35.0f, 250.0f, 150.0f); } },
+        { "Wrinkled Periwinkle", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new WrinkledPeriwinkle(prog, 45.0f, 150.0f, 150.0f); } },
+        { "Spindle Sea Shell", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new SpindleShell(prog, 25.0f, 150.0f, 150.0f); } },
+        { "Turret Shell", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new TurretShell(prog, 20.0f, 250.0f, 150.0f); } },
+        { "Twisted Pseudo Sphere", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new TwistedPseudoSphere(prog, 50.0f, 150.0f, 150.0f); } },
+        { "Breather Surface", [](QOpenGLShaderProgram* prog, const QVariantMap&) -> TriangleMesh* { return new BreatherSurface(prog, 15.0f, 150.0f, 150.0f); } },
+        { "Spring", [](QOpenGLShaderProgram* prog, const QVariantMap& p) -> TriangleMesh* {
+            return new Spring(prog, parameter(p, "sectionRadius", 10.0f), parameter(p, "coilRadius", 30.0f),
+                              parameter(p, "pitch", 10.0f), parameter(p, "turns", 2.0f), 50.0f, 150.0f); } },
+        { "Super Toroid", [](QOpenGLShaderProgram* prog, const QVariantMap& p) -> TriangleMesh* {
+            return new SuperToroid(prog, parameter(p, "outerRadius", 50), parameter(p, "innerRadius", 25),
+                                   parameter(p, "n1", 1), parameter(p, "n2", 1), 150.0f, 150.0f); } },
+        { "Super Ellipsoid", [](QOpenGLShaderProgram* prog, const QVariantMap& p) -> TriangleMesh* {
+            return new SuperEllipsoid(prog, parameter(p, "radius", 50), parameter(p, "scaleX", 1.0), parameter(p, "scaleY", 1.0),
+                                      parameter(p, "scaleZ", 1.0), parameter(p, "n1", 1.0), parameter(p, "n2", 1.0), 150.0f, 150.0f); } },
+        { "Gray's Klein Bottle", [](QOpenGLShaderProgram* prog, const QVariantMap& p) -> TriangleMesh* {
+            GraysKlein* gklein = new GraysKlein(prog, parameter(p, "radius", 30.0f), 150.0f, 150.0f);
+            if (p.contains("A") || p.contains("M") || p.contains("N"))
+            {
+                gklein->_A = parameter(p, "A", gklein->_A);
+                gklein->_M = parameter(p, "M", gklein->_M);
+                gklein->_N = parameter(p, "N", gklein->_N);
+                gklein->buildMesh(gklein->getSlices(), gklein->getStacks());
+            }
+            return gklein; } },
+        { "Spherical Harmonics", [](QOpenGLShaderProgram* prog, const QVariantMap& p) -> TriangleMesh* {
+            return new SphericalHarmonic(prog, parameter(p, "radius", 30.0f), 150.0f, 150.0f); } }
+    };
+    return catalogue;
+}
+
+int ModelCatalogue::count()
+{
+    return static_cast<int>(entries().size());
+}
+
+QString ModelCatalogue::name(int index)
+{
+    return QString::fromUtf8(entries().at(index).name);
+}
+
+int ModelCatalogue::find(const QString& name)
+{
+    bool isNumber = false;
+    int number = name.toInt(&isNumber);
+    if (isNumber)
+        return (number >= 1 && number <= count()) ? number - 1 : -1;
+
+    for (int i = 0; i < count(); i++)
+    {
+        if (name.compare(entries().at(i).name, Qt::CaseInsensitive) == 0)
+            return i;
+    }
+    return -1;
+}
+
+TriangleMesh* ModelCatalogue::create(int index, QOpenGLShaderProgram* prog, const QVariantMap& parameters)
+{
+    return entries().at(index).create(prog, parameters);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QString>
+#include <QVariantMap>
+#include <QtOpenGL>
+
+class TriangleMesh;
+
+
+// The models of the viewer in catalogue order, built on demand. GLView shows
+// them all, the batch renderer builds only the ones it draws.
+class ModelCatalogue
+{
+public:
+    static int count();
+    // Display name of the model, as returned by TriangleMesh::getName()
+    static QString name(int index);
+    // Index by name or 1 based number, case insensitive, -1 if there is none
+    static int find(const QString& name);
+    // Builds the model with a current context, prog supplies the attribute locations.
+    // Parametric models take their shape parameters by name, e.g. "turns" of the
+    // Spring, unknown names are ignored.
+    static TriangleMesh* create(int index, QOpenGLShaderProgram* prog, const QVariantMap& parameters = QVariantMap());
+};
@@ -1,28 +1,123 @@
 #include "ObjMesh.h"
+#include "CpuTrace.h"
+#include "DrawStatistics.h"
+#include "MemoryStatistics.h"
 
 
 using std::string;
 using glm::vec3;
 using glm::vec2;
 
+#include <algorithm>
+#include <charconv>
 #include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <iostream>
 using std::cout;
 using std::cerr;
 using std::endl;
-#include <fstream>
-using std::ifstream;
-#include <sstream>
-using std::istringstream;
-#include <map>
-
-void trimString(std::string & str) {
-    const char * whiteSpace = " \t\n\r";
-    size_t location;
-    location = str.find_first_not_of(whiteSpace);
-    str.erase(0, location);
-    location = str.find_last_not_of(whiteSpace);
-    str.erase(location + 1);
+
+#include <QFile>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+
+namespace {
+	// Cursor over one line of an OBJ file, without the comment and the line break
+	struct ObjLine {
+		const char* p;
+		const char* end;
+
+		void skipSpace() {
+			while( p < end && (*p == ' ' || *p == '\t') ) p++;
+		}
+
+		bool atSeparator() const {
+			return p == end || *p == ' ' || *p == '\t';
+		}
+
+		// The keyword starting the line, e.g. "v" or "usemtl"
+		bool keyword(const char* word) {
+			size_t length = strlen(word);
+			if( static_cast<size_t>(end - p) < length || memcmp(p, word, length) != 0 ) return false;
+			const char* after = p + length;
+			if( after != end && *after != ' ' && *after != '\t' ) return false;
+			p = after;
+			return true;
+		}
+
+		bool parseFloat(float & value) {
+			skipSpace();
+			if( p < end && *p == '+' ) p++;
+			auto result = std::from_chars(p, end, value);
+			if( result.ec != std::errc() ) return false;
+			p = result.ptr;
+			return atSeparator();
+		}
+
+		bool parseInt(int & value) {
+			auto result = std::from_chars(p, end, value);
+			if( result.ec != std::errc() ) return false;
+			p = result.ptr;
+			return true;
+		}
+
+		// One vertex of a face, v, v/vt, v//vn or v/vt/vn. Absent indices are 0.
+		bool parseFaceVertex(int & v, int & vt, int & vn) {
+			vt = vn = 0;
+			if( !parseInt(v) ) return false;
+			if( p < end && *p == '/' ) {
+				p++;
+				if( p < end && *p != '/' && !parseInt(vt) ) return false;
+				if( p < end && *p == '/' ) {
+					p++;
+					if( !parseInt(vn) ) return false;
+				}
+			}
+			return atSeparator();
+		}
+	};
+
+	class PartTask : public QRunnable {
+	public:
+		PartTask(const std::function<void()> & work) : _work(work) { }
+		void run() override { _work(); }
+	private:
+		std::function<void()> _work;
+	};
+
+	// Threads for the parts, kept between loads so repeated loads reuse them
+	QThreadPool & partPool() {
+		static QThreadPool pool;
+		return pool;
+	}
+
+	// Runs work(i) for every part, the first on the calling thread and the others
+	// on the part pool, and waits for all
+	void runParts(int count, const std::function<void(int)> & work) {
+		QSemaphore done;
+		for( int i = 1; i < count; i++ ) partPool().start(new PartTask([&work, &done, i]() { work(i); done.release(); }));
+		work(0);
+		done.acquire(count - 1);
+	}
+
+	// Smallest part of a file parsed on a thread of its own
+	const long long MIN_CHUNK_BYTES = 4 << 20;
+
+	// Hash of a point, texture coordinate and normal index triple, packed into
+	// 64 bits and mixed with the finalizer of MurmurHash3
+	quint64 hashVertex(int p, int tc, int n) {
+		quint64 h = (static_cast<quint64>(static_cast<quint32>(p)) << 32) ^ (static_cast<quint64>(static_cast<quint32>(tc)) << 16)
+			^ static_cast<quint32>(n) ^ (static_cast<quint64>(static_cast<quint32>(n)) << 48);
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdULL;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ULL;
+		h ^= h >> 33;
+		return h;
+	}
 }
 
 ObjMesh::ObjMesh(QOpenGLShaderProgram* prog) : TriangleMesh(prog, "Mesh"), drawAdj(false)
@@ -32,6 +127,7 @@ void ObjMesh::render() {
     if( drawAdj ) {
 	_vertexArrayObject.bind();
 	    glDrawElements(GL_TRIANGLES_ADJACENCY, nVerts, GL_UNSIGNED_INT, 0);
+	    DrawStatistics::count(GL_TRIANGLES_ADJACENCY, nVerts);
 	    _vertexArrayObject.release();
     } else {
 	TriangleMesh::render();
@@ -40,11 +136,12 @@ void ObjMesh::render() {
 
 
 std::unique_ptr<ObjMesh> ObjMesh::load(QOpenGLShaderProgram* prog, const char * fileName, bool center, bool genTangents ) {
+	TRACE_SCOPE("ObjMesh::load");
     
 	std::unique_ptr<ObjMesh> mesh(new ObjMesh(prog));
 	
 	ObjMeshData meshData;
-	meshData.load(fileName, mesh->bbox);
+	if( !meshData.load(fileName, mesh->bbox) ) return nullptr;
 	
 	// Generate normals
 	meshData.generateNormalsIfNeeded();
@@ -55,6 +152,7 @@ std::unique_ptr<ObjMesh> ObjMesh::load(QOpenGLShaderProgram* prog, const char *
 		// Convert to GL format
 		GlMeshData glMesh;
 		meshData.toGlMesh(glMesh);
+		MemoryStatistics::recordTransient("ObjMesh::load", meshData.memoryBytes() + glMesh.memoryBytes());
 		
 		if( center ) glMesh.center(mesh->bbox);
 		    
@@ -73,11 +171,12 @@ std::unique_ptr<ObjMesh> ObjMesh::load(QOpenGLShaderProgram* prog, const char *
 }
 
 std::unique_ptr<ObjMesh> ObjMesh::loadWithAdjacency(QOpenGLShaderProgram* prog, const char * fileName, bool center ) {
+	TRACE_SCOPE("ObjMesh::loadWithAdjacency");
     
 	std::unique_ptr<ObjMesh> mesh(new ObjMesh(prog));
 	
 	ObjMeshData meshData;
-	meshData.load(fileName, mesh->bbox);
+	if( !meshData.load(fileName, mesh->bbox) ) return nullptr;
 	
 	// Generate normals
 	meshData.generateNormalsIfNeeded();
@@ -85,6 +184,7 @@ std::unique_ptr<ObjMesh> ObjMesh::loadWithAdjacency(QOpenGLShaderProgram* prog,
 	// Convert to GL format
 	GlMeshData glMesh;
 	meshData.toGlMesh(glMesh);
+	MemoryStatistics::recordTransient("ObjMesh::loadWithAdjacency", meshData.memoryBytes() + glMesh.memoryBytes());
 	
 	if( center ) glMesh.center(mesh->bbox);
 	    
@@ -105,67 +205,266 @@ std::unique_ptr<ObjMesh> ObjMesh::loadWithAdjacency(QOpenGLShaderProgram* prog,
 		return mesh;
 }
 
-void ObjMesh::ObjMeshData::load( const char * fileName, Aabb & bbox ) {
-    ifstream objStream( fileName, std::ios::in );
-	
-	if( !objStream ) {
-	    cerr << "Unable to open OBJ file: " << fileName << endl;
-		exit(1);
-	}
-    
-	bbox.reset();
-	string line, token;
-	getline( objStream, line );
-	while( !objStream.eof() ) {
-	    // Remove comment if it exists
-	    size_t pos = line.find_first_of("#");
-		if( pos != std::string::npos ) {
-		    line = line.substr(0, pos);
+// A newline aligned part of a mapped file, parsed on a thread of its own
+struct ObjMesh::ObjMeshData::Chunk {
+	const char* begin;
+	const char* end;
+	bool startsFile;              // Indices counted back stay within the chunk
+	ObjMeshData data;
+	Aabb bbox;
+	// Face vertices with indices counted back, which are relative to the start of the
+	// chunk until merged. Position * 8 + 1 for the point, 2 the texture coordinate, 4 the normal.
+	std::vector<size_t> relative;
+	// Indices counted back before the chunk, each further back than the ones before
+	// it. Once the offsets are known the first reaching before the file is an error.
+	struct BackReference {
+		long line;
+		int attribute;            // 0 the point, 1 the texture coordinate, 2 the normal
+		int index;                // Relative to the start of the chunk
+	};
+	std::vector<BackReference> backReferences;
+	long lines;                   // Parsed, the last one has the problem
+	const char* problem;
+
+	// Offsets in the merged arrays
+	size_t pointBase, texCoordBase, normalBase, faceBase;
+
+	bool parse();
+};
+
+bool ObjMesh::ObjMeshData::Chunk::parse() {
+	TRACE_SCOPE("ObjMeshData::Chunk::parse");
+	lines = 0;
+	problem = nullptr;
+	int furthestBack[3] = { 0, 0, 0 };
+	auto fail = [&](const char* what) {
+	    problem = what;
+		return false;
+	};
+	auto resolve = [&](int index, size_t count, int bit, int & resolved, int & mask) {
+	    if( index > 0 ) {
+		    resolved = index - 1;
+			return true;
 		}
-	    trimString(line);
-		
-		if( line.length( ) > 0 ) {
-		    istringstream lineStream( line );
-			
-			lineStream >> token;
-			
-			if (token == "v" ) {
-			    float x, y, z;
-				lineStream >> x >> y >> z;
-				glm::vec3 p(x,y,z);
-				points.push_back( p );
-				bbox.add(p);
-			} else if (token == "vt") {
-			    // Process texture coordinate
-			    float s,t;
-				lineStream >> s >> t;
-				texCoords.push_back( vec2(s,t) );
-			} else if (token == "vn" ) {
-			    float x, y, z;
-				lineStream >> x >> y >> z;
-				normals.push_back( vec3(x,y,z) );
-			} else if (token == "f" ) {
-			    std::vector<std::string> parts;
-				while(lineStream.good()) {
-				    std::string s;
-					lineStream >> s;
-					parts.push_back(s);
-				}
-			    
-				// Triangulate as a triangle fan
-				if( parts.size() > 2 ) {
-				    ObjVertex firstVert(parts[0]);
-                    for( ulong i = 2; i < parts.size(); i++ ) {
-					    faces.push_back(firstVert);
-						faces.push_back(ObjVertex(parts[i-1]));
-						faces.push_back(ObjVertex(parts[i]));
-					}
+		resolved = static_cast<int>(count) + index;
+		if( index == 0 || (startsFile && resolved < 0) ) return false;
+		if( !startsFile ) {
+		    mask |= bit;
+			int attribute = bit >> 1;
+			if( resolved < furthestBack[attribute] ) {
+			    furthestBack[attribute] = resolved;
+				backReferences.push_back({ lines, attribute, resolved });
+			}
+		}
+		return true;
+	};
+	auto addFaceVertex = [&](const ObjVertex & vertex, int mask) {
+	    data.faces.push_back(vertex);
+		if( mask ) relative.push_back((data.faces.size() - 1) * 8 + mask);
+	};
+
+	for( const char* next = begin; next < end; ) {
+	    const char* lineStart = next;
+		const char* lineEnd = static_cast<const char*>(memchr(lineStart, '\n', end - lineStart));
+		next = lineEnd ? lineEnd + 1 : end;
+		if( !lineEnd ) lineEnd = end;
+		lines++;
+
+		// Remove the comment, the CR of CRLF and trailing blanks
+		const char* comment = static_cast<const char*>(memchr(lineStart, '#', lineEnd - lineStart));
+		if( comment ) lineEnd = comment;
+		while( lineEnd > lineStart && (lineEnd[-1] == '\r' || lineEnd[-1] == ' ' || lineEnd[-1] == '\t') ) lineEnd--;
+
+		ObjLine line = { lineStart, lineEnd };
+		line.skipSpace();
+		if( line.p == line.end ) continue;
+
+		if( line.keyword("v") ) {
+		    float x, y, z;
+			if( !line.parseFloat(x) || !line.parseFloat(y) || !line.parseFloat(z) ) return fail("invalid vertex");
+			glm::vec3 p(x,y,z);
+			data.points.push_back( p );
+			bbox.add(p);
+		} else if( line.keyword("vt") ) {
+		    // The second coordinate is optional
+		    float s, t = 0.0f;
+			if( !line.parseFloat(s) ) return fail("invalid texture coordinate");
+			line.skipSpace();
+			if( line.p < line.end && !line.parseFloat(t) ) return fail("invalid texture coordinate");
+			data.texCoords.push_back( vec2(s,t) );
+		} else if( line.keyword("vn") ) {
+		    float x, y, z;
+			if( !line.parseFloat(x) || !line.parseFloat(y) || !line.parseFloat(z) ) return fail("invalid normal");
+			data.normals.push_back( vec3(x,y,z) );
+		} else if( line.keyword("f") ) {
+		    // Triangulate as a triangle fan
+		    ObjVertex first, previous, vertex;
+			int firstMask = 0, previousMask = 0;
+			int count = 0;
+			line.skipSpace();
+			while( line.p < line.end ) {
+			    int v, vt, vn;
+				int mask = 0;
+				if( !line.parseFaceVertex(v, vt, vn) ) return fail("invalid face vertex");
+				vertex.tcIdx = vertex.nIdx = -1;
+				if( !resolve(v, data.points.size(), 1, vertex.pIdx, mask)
+					|| (vt && !resolve(vt, data.texCoords.size(), 2, vertex.tcIdx, mask))
+					|| (vn && !resolve(vn, data.normals.size(), 4, vertex.nIdx, mask)) ) return fail("invalid face index");
+
+				if( count == 0 ) {
+				    first = vertex;
+					firstMask = mask;
+				} else if( count >= 2 ) {
+				    addFaceVertex(first, firstMask);
+					addFaceVertex(previous, previousMask);
+					addFaceVertex(vertex, mask);
 				}
+				previous = vertex;
+				previousMask = mask;
+				count++;
+				line.skipSpace();
+			}
+		}
+		// Objects, groups, materials and smoothing groups (o, g, usemtl, mtllib,
+		// s) and everything else are ignored, the file is drawn as one mesh
+	}
+	return true;
+}
+
+bool ObjMesh::ObjMeshData::load( const char * fileName, Aabb & bbox ) {
+	TRACE_SCOPE("ObjMeshData::load");
+	QFile file(QFile::decodeName(fileName));
+	if( !file.open(QIODevice::ReadOnly) ) {
+	    cerr << "Unable to open OBJ file: " << fileName << ": " << file.errorString().toStdString() << endl;
+		return false;
+	}
+
+	// Mapped, so the file is parsed in place without copying a line. Files that
+	// cannot be mapped, e.g. on some network shares, are read at once.
+	qint64 size = file.size();
+	const char* data = size > 0 ? reinterpret_cast<const char*>(file.map(0, size)) : nullptr;
+	QByteArray contents;
+	if( size > 0 && !data ) {
+	    contents = file.readAll();
+		data = contents.constData();
+		size = contents.size();
+	}
+	const char* end = data + size;
+
+	// Large files are cut into a chunk per core, each ending after a line break
+	int chunkCount = static_cast<int>(std::max(1LL, std::min<long long>(size / MIN_CHUNK_BYTES, QThread::idealThreadCount())));
+	std::vector<Chunk> chunks(chunkCount);
+	const char* chunkStart = data;
+	for( int i = 0; i < chunkCount; i++ ) {
+	    const char* split = end;
+		if( i + 1 < chunkCount ) {
+		    split = std::max(chunkStart, data + size * (i + 1) / chunkCount);
+			const char* lineBreak = static_cast<const char*>(memchr(split, '\n', end - split));
+			split = lineBreak ? lineBreak + 1 : end;
+		}
+		chunks[i].begin = chunkStart;
+		chunks[i].end = split;
+		chunks[i].startsFile = i == 0;
+		chunkStart = split;
+	}
+	runParts(chunkCount, [&](int i) { chunks[i].parse(); });
+
+	// The first problem in the file, as a single parse would have stopped there. The
+	// offsets of a chunk are known once the ones before it were parsed without one.
+	long lineNumber = 0;
+	size_t pointCount = 0, texCoordCount = 0, normalCount = 0, faceCount = 0;
+	for( Chunk & chunk : chunks ) {
+	    chunk.pointBase = pointCount;
+		chunk.texCoordBase = texCoordCount;
+		chunk.normalBase = normalCount;
+		chunk.faceBase = faceCount;
+
+		const char* problem = chunk.problem;
+		long problemLine = chunk.lines;
+		const size_t bases[3] = { pointCount, texCoordCount, normalCount };
+		for( const Chunk::BackReference & reference : chunk.backReferences ) {
+		    if( problem && reference.line > problemLine ) break;
+			if( reference.index + static_cast<long long>(bases[reference.attribute]) < 0 ) {
+			    problem = "invalid face index";
+				problemLine = reference.line;
+				break;
 			}
 		}
-	    getline( objStream, line );
+		if( problem ) {
+		    cerr << fileName << ":" << lineNumber + problemLine << ": " << problem << endl;
+			return false;
+		}
+
+		lineNumber += chunk.lines;
+		pointCount += chunk.data.points.size();
+		texCoordCount += chunk.data.texCoords.size();
+		normalCount += chunk.data.normals.size();
+		faceCount += chunk.data.faces.size();
+	}
+
+	bbox.reset();
+	bool outOfRange = false;
+	if( chunkCount == 1 ) {
+	    Chunk & chunk = chunks.front();
+		points.swap(chunk.data.points);
+		texCoords.swap(chunk.data.texCoords);
+		normals.swap(chunk.data.normals);
+		faces.swap(chunk.data.faces);
+		bbox = chunk.bbox;
+	} else {
+	    TRACE_SCOPE("ObjMeshData merge");
+		long long chunkBytes = 0;
+		for( const Chunk & chunk : chunks ) {
+		    chunkBytes += chunk.data.memoryBytes() + MemoryStatistics::vectorBytes(chunk.relative)
+				+ MemoryStatistics::vectorBytes(chunk.backReferences);
+			bbox.add(chunk.bbox);
+		}
+		MemoryStatistics::recordTransient("ObjMeshData::load chunks", chunkBytes);
+
+		points.resize(pointCount);
+		texCoords.resize(texCoordCount);
+		normals.resize(normalCount);
+		faces.resize(faceCount);
+		runParts(chunkCount, [&](int i) {
+		    Chunk & chunk = chunks[i];
+			std::copy(chunk.data.points.begin(), chunk.data.points.end(), points.begin() + chunk.pointBase);
+			std::copy(chunk.data.texCoords.begin(), chunk.data.texCoords.end(), texCoords.begin() + chunk.texCoordBase);
+			std::copy(chunk.data.normals.begin(), chunk.data.normals.end(), normals.begin() + chunk.normalBase);
+			std::copy(chunk.data.faces.begin(), chunk.data.faces.end(), faces.begin() + chunk.faceBase);
+			for( size_t entry : chunk.relative ) {
+			    ObjVertex & vertex = faces[chunk.faceBase + entry / 8];
+				if( entry & 1 ) vertex.pIdx += static_cast<int>(chunk.pointBase);
+				if( entry & 2 ) vertex.tcIdx += static_cast<int>(chunk.texCoordBase);
+				if( entry & 4 ) vertex.nIdx += static_cast<int>(chunk.normalBase);
+			}
+			chunk.data = ObjMeshData();
+			chunk.relative = std::vector<size_t>();
+		});
+	}
+
+	// Indices may refer to vertices defined later in the file
+	bool missingNormals = false, missingTexCoords = false;
+	for( const ObjVertex & vertex : faces ) {
+	    outOfRange |= vertex.pIdx >= static_cast<int>(points.size()) || vertex.tcIdx >= static_cast<int>(texCoords.size())
+			|| vertex.nIdx >= static_cast<int>(normals.size());
+		missingNormals |= vertex.nIdx < 0;
+		missingTexCoords |= vertex.tcIdx < 0;
 	}
-    objStream.close();
+	if( outOfRange ) {
+	    cerr << fileName << ": face index out of range" << endl;
+		return false;
+	}
+	// Faces with and without normals or texture coordinates cannot be drawn as one
+	if( missingNormals && !normals.empty() ) {
+	    cerr << fileName << ": some faces have no normals, generating all" << endl;
+		normals.clear();
+	}
+	if( missingTexCoords && !texCoords.empty() ) {
+	    cerr << fileName << ": some faces have no texture coordinates, ignoring all" << endl;
+		texCoords.clear();
+		for( ObjVertex & vertex : faces ) vertex.tcIdx = -1;
+	}
+	return true;
 }
 
 void ObjMesh::GlMeshData::center( Aabb & bbox ) {
@@ -186,20 +485,8 @@ void ObjMesh::GlMeshData::center( Aabb & bbox ) {
 	bbox.min = bbox.min - center;
 }
 
-ObjMesh::ObjMeshData::ObjVertex::ObjVertex(std::string &vertString) : pIdx(-1), nIdx(-1), tcIdx(-1) {
-    size_t slash1, slash2;
-	slash1 = vertString.find("/");
-	pIdx = std::stoi(vertString.substr(0, slash1)) - 1;
-	if (slash1 != string::npos) {
-	    slash2 = vertString.find("/", slash1 + 1);
-		if (slash2 > slash1 + 1) {
-		    tcIdx = std::stoi(vertString.substr(slash1 + 1, slash2 - slash1 - 1)) - 1;
-		}
-	    nIdx = std::stoi(vertString.substr(slash2 + 1)) - 1;
-	}
-}
-
 void ObjMesh::ObjMeshData::generateNormalsIfNeeded() {
+	TRACE_SCOPE("ObjMeshData::generateNormalsIfNeeded");
     if( normals.size() != 0 ) return;
 	
 	    normals.resize(points.size());
@@ -229,6 +516,7 @@ void ObjMesh::ObjMeshData::generateNormalsIfNeeded() {
 }
 
 void ObjMesh::ObjMeshData::generateTangents() {
+	TRACE_SCOPE("ObjMeshData::generateTangents");
     std::vector<vec3> tan1Accum(points.size());
 	std::vector<vec3> tan2Accum(points.size());
 	tangents.resize(points.size());
@@ -277,46 +565,83 @@ void ObjMesh::ObjMeshData::generateTangents() {
 }
 
 void ObjMesh::ObjMeshData::toGlMesh(GlMeshData & data) {
+	TRACE_SCOPE("ObjMeshData::toGlMesh");
     data.clear();
-	
-	std::map<std::string, GLuint> vertexMap;
-	for( auto & vert : faces ) {
-	    auto vertStr = vert.str();
-		auto it = vertexMap.find(vertStr);
-		if( it == vertexMap.end() ) {
-		    auto vIdx = data.points.size() / 3;
-			
-			auto & pt = points[ vert.pIdx ];
-			data.points.push_back( pt.x );
-			data.points.push_back( pt.y );
-			data.points.push_back( pt.z );
-			
-			auto & n = normals[ vert.nIdx ];
-			data.normals.push_back( n.x );
-			data.normals.push_back( n.y );
-			data.normals.push_back( n.z );
-			
-			if( ! texCoords.empty() ) {
-			    auto & tc = texCoords[ vert.tcIdx ];
-				data.texCoords.push_back( tc.x );
-				data.texCoords.push_back( tc.y );
-			}
-		    
-			if( ! tangents.empty() ) {
-			    // We use the point index for tangents
-			    auto & tang = tangents[ vert.pIdx ];
-				data.tangents.push_back( tang.x );
-				data.tangents.push_back( tang.y );
-				data.tangents.push_back( tang.z );
-				data.tangents.push_back( tang.w );
-			}
-		    
-			data.faces.push_back((GLuint)vIdx);
-			vertexMap[vertStr] = (GLuint)vIdx;
-		} else {
-		    data.faces.push_back(it->second);
+
+	// Open addressing with linear probing, at most half full as every corner
+	// could be a vertex of its own
+	struct Slot {
+		int pIdx, tcIdx, nIdx;
+		GLuint index;
+	};
+	const GLuint EMPTY = std::numeric_limits<GLuint>::max();
+	size_t capacity = 16;
+	while( capacity < faces.size() * 2 ) capacity *= 2;
+	std::vector<Slot> table(capacity, Slot{ -1, -1, -1, EMPTY });
+	const size_t mask = capacity - 1;
+
+	// Numbers the distinct corners in order of appearance, remembering the first of each
+	std::vector<size_t> firstCorner;
+	firstCorner.reserve(faces.size());
+	data.faces.resize(faces.size());
+	for( size_t corner = 0; corner < faces.size(); corner++ ) {
+	    const ObjVertex & vert = faces[corner];
+		size_t slot = hashVertex(vert.pIdx, vert.tcIdx, vert.nIdx) & mask;
+		while( table[slot].index != EMPTY
+			&& (table[slot].pIdx != vert.pIdx || table[slot].tcIdx != vert.tcIdx || table[slot].nIdx != vert.nIdx) )
+			slot = (slot + 1) & mask;
+		if( table[slot].index == EMPTY ) {
+		    table[slot] = Slot{ vert.pIdx, vert.tcIdx, vert.nIdx, static_cast<GLuint>(firstCorner.size()) };
+			firstCorner.push_back(corner);
 		}
+		data.faces[corner] = table[slot].index;
 	}
+
+	size_t vertexCount = firstCorner.size();
+	data.points.resize(vertexCount * 3);
+	data.normals.resize(vertexCount * 3);
+	if( ! texCoords.empty() ) data.texCoords.resize(vertexCount * 2);
+	if( ! tangents.empty() ) data.tangents.resize(vertexCount * 4);
+	for( size_t v = 0; v < vertexCount; v++ ) {
+	    const ObjVertex & vert = faces[ firstCorner[v] ];
+
+		auto & pt = points[ vert.pIdx ];
+		data.points[v * 3 + 0] = pt.x;
+		data.points[v * 3 + 1] = pt.y;
+		data.points[v * 3 + 2] = pt.z;
+
+		auto & n = normals[ vert.nIdx ];
+		data.normals[v * 3 + 0] = n.x;
+		data.normals[v * 3 + 1] = n.y;
+		data.normals[v * 3 + 2] = n.z;
+
+		if( ! texCoords.empty() ) {
+		    auto & tc = texCoords[ vert.tcIdx ];
+			data.texCoords[v * 2 + 0] = tc.x;
+			data.texCoords[v * 2 + 1] = tc.y;
+		}
+
+		if( ! tangents.empty() ) {
+		    // We use the point index for tangents
+		    auto & tang = tangents[ vert.pIdx ];
+			data.tangents[v * 4 + 0] = tang.x;
+			data.tangents[v * 4 + 1] = tang.y;
+			data.tangents[v * 4 + 2] = tang.z;
+			data.tangents[v * 4 + 3] = tang.w;
+		}
+	}
+	MemoryStatistics::recordTransient("ObjMeshData::toGlMesh vertex map",
+		MemoryStatistics::vectorBytes(table) + MemoryStatistics::vectorBytes(firstCorner));
+}
+
+long long ObjMesh::ObjMeshData::memoryBytes() const {
+	return MemoryStatistics::vectorBytes(points) + MemoryStatistics::vectorBytes(normals) + MemoryStatistics::vectorBytes(texCoords)
+		+ MemoryStatistics::vectorBytes(faces) + MemoryStatistics::vectorBytes(tangents);
+}
+
+long long ObjMesh::GlMeshData::memoryBytes() const {
+	return MemoryStatistics::vectorBytes(points) + MemoryStatistics::vectorBytes(normals) + MemoryStatistics::vectorBytes(texCoords)
+		+ MemoryStatistics::vectorBytes(faces) + MemoryStatistics::vectorBytes(tangents);
 }
 
 void ObjMesh::GlMeshData::convertFacesToAdjancencyFormat()
@@ -41,6 +41,7 @@ protected:
         }
         void center(Aabb & bbox);
         void convertFacesToAdjancencyFormat();
+        long long memoryBytes() const;
     };
 
     class ObjMeshData {
@@ -56,11 +57,6 @@ protected:
                 nIdx = -1;
                 tcIdx = -1;
             }
-
-            ObjVertex(std::string &vertString);
-            std::string str() {
-                return std::to_string(pIdx) + "/" + std::to_string(tcIdx) + "/" + std::to_string(nIdx);
-            }
         };
 
         std::vector <glm::vec3> points;
@@ -71,9 +67,13 @@ protected:
 
         ObjMeshData() { }
 
+        struct Chunk;
+
         void generateNormalsIfNeeded();
         void generateTangents();
-        void load( const char * fileName, Aabb & bbox );
+        // False after printing the problem, nothing is drawn of a broken file
+        bool load( const char * fileName, Aabb & bbox );
         void toGlMesh(GlMeshData & data);
+        long long memoryBytes() const;
     };
 };
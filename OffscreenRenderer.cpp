@@ -0,0 +1,299 @@
+#include "OffscreenRenderer.h"
+#include "MaterialPresets.h"
+#include "TriangleMesh.h"
+
+#include <QImage>
+#include <QRunnable>
+
+// Encodes one image read back from the GPU on a worker thread
+class PngWriter : public QRunnable
+{
+public:
+    PngWriter(const QImage& image, const QString& fileName, QAtomicInt* failed, const OffscreenRenderer::Completion& completion) :
+        _image(image), _fileName(fileName), _failed(failed), _completion(completion)
+    {
+    }
+
+    void run() override
+    {
+        // Rows arrive bottom up from OpenGL
+        bool written = _image.mirrored().save(_fileName, "PNG");
+        if (!written)
+        {
+            cerr << "Could not write " << _fileName.toStdString() << endl;
+            _failed->ref();
+        }
+        if (_completion)
+            _completion(written);
+    }
+
+private:
+    QImage _image;
+    QString _fileName;
+    QAtomicInt* _failed;
+    OffscreenRenderer::Completion _completion;
+};
+
+OffscreenRenderer::OffscreenRenderer() :
+    _samples(4),
+    _context(nullptr),
+    _surface(nullptr),
+    _renderer(nullptr),
+    _target(nullptr),
+    _resolve(nullptr),
+    _nextReadback(0),
+    _failed(0)
+{
+}
+
+OffscreenRenderer::~OffscreenRenderer()
+{
+    destroy();
+}
+
+bool OffscreenRenderer::create(int samples, int readbackCount)
+{
+    _samples = samples;
+
+    // Compatibility profile for the quad meshes of the catalogue
+    QSurfaceFormat format;
+    format.setVersion(4, 5);
+    format.setProfile(QSurfaceFormat::CompatibilityProfile);
+
+    _context = new QOpenGLContext();
+    _context->setFormat(format);
+    if (!_context->create())
+    {
+        cerr << "Could not create an OpenGL context" << endl;
+        return false;
+    }
+
+    _surface = new QOffscreenSurface();
+    _surface->setFormat(_context->format());
+    _surface->create();
+    if (!_context->makeCurrent(_surface))
+    {
+        cerr << "Could not make the OpenGL context current" << endl;
+        return false;
+    }
+    if (!initializeOpenGLFunctions())
+    {
+        cerr << "OpenGL 4.5 is required, the context is " << _context->format().majorVersion()
+             << "." << _context->format().minorVersion() << endl;
+        return false;
+    }
+
+    cerr << "Renderer: " << glGetString(GL_RENDERER) << '\n';
+    cerr << "Version:  " << glGetString(GL_VERSION) << "\n\n";
+
+    _renderer = new SceneRenderer();
+    if (!_renderer->initialize())
+        return false;
+
+    _readbacks.resize(qMax(1, readbackCount));
+    for (Readback& readback : _readbacks)
+    {
+        glGenBuffers(1, &readback.pbo);
+        readback.capacity = 0;
+        readback.fence = 0;
+    }
+    return true;
+}
+
+void OffscreenRenderer::destroy()
+{
+    if (!_context)
+        return;
+
+    if (_context->makeCurrent(_surface))
+    {
+        finish();
+        for (Readback& readback : _readbacks)
+        {
+            if (readback.pbo)
+                glDeleteBuffers(1, &readback.pbo);
+        }
+        delete _target;
+        delete _resolve;
+        delete _renderer;
+        _context->doneCurrent();
+    }
+    delete _context;
+    delete _surface;
+    _context = nullptr;
+    _surface = nullptr;
+}
+
+bool OffscreenRenderer::findView(const QString& name, GLCamera::ViewProjection& view)
+{
+    static const struct { const char* name; GLCamera::ViewProjection view; } views[] = {
+        { "top", GLCamera::TOP_VIEW },
+        { "bottom", GLCamera::BOTTOM_VIEW },
+        { "front", GLCamera::FRONT_VIEW },
+        { "back", GLCamera::REAR_VIEW },
+        { "left", GLCamera::LEFT_VIEW },
+        { "right", GLCamera::RIGHT_VIEW },
+        { "iso", GLCamera::SE_ISOMETRIC_VIEW },
+        { "dimetric", GLCamera::DIMETRIC_VIEW },
+        { "trimetric", GLCamera::TRIMETRIC_VIEW }
+    };
+    for (const auto& entry : views)
+    {
+        if (name.compare(entry.name, Qt::CaseInsensitive) == 0)
+        {
+            view = entry.view;
+            return true;
+        }
+    }
+    return false;
+}
+
+RenderState OffscreenRenderer::fittedState(TriangleMesh* mesh, const MaterialPreset& preset, GLCamera::ViewProjection view,
+                                           const QSize& size, GLfloat zoom, bool perspective)
+{
+    BoundingSphere sphere = mesh->getBoundingSphere();
+    GLCamera camera(size.width(), size.height(), sphere.getRadius() * 2 / qMax(zoom, 0.01f), 60.0f);
+    camera.setProjection(perspective ? GLCamera::PERSPECTIVE : GLCamera::ORTHOGRAPHIC);
+    camera.setView(view);
+    camera.setPosition(sphere.getCenter());
+
+    RenderState state;
+    state.width = size.width();
+    state.height = size.height();
+    state.modelIndex = -1; // The mesh is passed directly
+    state.geometryGeneration = mesh->generation();
+    state.indexCount = mesh->indexCount();
+    state.primitiveType = mesh->primitiveType();
+    state.projectionMatrix = camera.getProjectionMatrix();
+    state.modelViewMatrix = camera.getViewMatrix();
+    state.ambiLight = QVector4D(preset.ambiLight, 1.0f);
+    state.diffLight = QVector4D(preset.diffLight, 1.0f);
+    state.specLight = QVector4D(preset.specLight, 1.0f);
+    state.lightPosition = QVector3D(0.0f, 0.0f, 50.0f);
+    state.ambiMat = QVector4D(preset.ambiMat, 1.0f);
+    state.diffMat = QVector4D(preset.diffMat, 1.0f);
+    state.specMat = QVector4D(preset.specMat, 1.0f);
+    state.emmiMat = QVector4D(0.0f, 0.0f, 0.0f, 1.0f);
+    state.opacity = 1.0f;
+    state.shine = preset.shine;
+    state.hasTexture = false;
+    state.texture = 0;
+    state.shaded = true;
+    for (int i = 0; i < 3; i++)
+    {
+        state.clipEnabled[i] = false;
+        state.clipPlanes[i] = QVector4D();
+    }
+    return state;
+}
+
+void OffscreenRenderer::render(const RenderState& state, TriangleMesh* mesh, const QString& fileName, Completion completion)
+{
+    draw(state, mesh);
+    Readback& readback = startReadback(QSize(state.width, state.height));
+    readback.fileName = fileName;
+    readback.completion = completion;
+}
+
+void OffscreenRenderer::render(const RenderState& state, TriangleMesh* mesh, FrameHandler handler)
+{
+    draw(state, mesh);
+    Readback& readback = startReadback(QSize(state.width, state.height));
+    readback.frameHandler = handler;
+}
+
+void OffscreenRenderer::draw(const RenderState& state, TriangleMesh* mesh)
+{
+    QSize size(state.width, state.height);
+    if (!_target || _target->size() != size)
+    {
+        // The reads still pending come from the old resolve target
+        flush();
+        delete _target;
+        delete _resolve;
+        QOpenGLFramebufferObjectFormat targetFormat;
+        targetFormat.setAttachment(QOpenGLFramebufferObject::Depth);
+        targetFormat.setSamples(_samples);
+        _target = new QOpenGLFramebufferObject(size, targetFormat);
+        _resolve = new QOpenGLFramebufferObject(size);
+    }
+
+    _target->bind();
+    _renderer->render(state, mesh);
+    QOpenGLFramebufferObject::blitFramebuffer(_resolve, _target);
+}
+
+OffscreenRenderer::Readback& OffscreenRenderer::startReadback(const QSize& size)
+{
+    Readback& readback = _readbacks[_nextReadback];
+    _nextReadback = (_nextReadback + 1) % static_cast<int>(_readbacks.size());
+    if (readback.fence)
+        finishReadback(readback);
+
+    GLsizeiptr bytes = static_cast<GLsizeiptr>(size.width()) * size.height() * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+    if (readback.capacity < bytes)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+        readback.capacity = bytes;
+    }
+
+    // Returns at once, the copy runs while the next image is drawn
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, _resolve->handle());
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, size.width(), size.height(), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback.size = size;
+    return readback;
+}
+
+void OffscreenRenderer::finishReadback(Readback& readback)
+{
+    glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    glDeleteSync(readback.fence);
+    readback.fence = 0;
+
+    QImage image(readback.size, QImage::Format_RGBA8888);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+    const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, image.sizeInBytes(), GL_MAP_READ_BIT);
+    if (pixels)
+    {
+        memcpy(image.bits(), pixels, image.sizeInBytes());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    else
+    {
+        cerr << "Could not read back " << (readback.frameHandler ? "a frame" : readback.fileName.toStdString()) << endl;
+        _failed.ref();
+        image = QImage();
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (readback.frameHandler)
+        readback.frameHandler(image);
+    else if (!image.isNull())
+        _writers.start(new PngWriter(image, readback.fileName, &_failed, readback.completion));
+    else if (readback.completion)
+        readback.completion(false);
+    readback.completion = Completion();
+    readback.frameHandler = FrameHandler();
+}
+
+void OffscreenRenderer::flush()
+{
+    // Oldest first so the files complete in the order they were drawn
+    for (size_t i = 0; i < _readbacks.size(); i++)
+    {
+        Readback& readback = _readbacks[(_nextReadback + i) % _readbacks.size()];
+        if (readback.fence)
+            finishReadback(readback);
+    }
+}
+
+void OffscreenRenderer::finish()
+{
+    flush();
+    _writers.waitForDone();
+}
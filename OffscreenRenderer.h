@@ -0,0 +1,96 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <QString>
+#include <QThreadPool>
+#include <QOffscreenSurface>
+#include <QtOpenGL>
+#include <QOpenGLFunctions_4_5_Core>
+
+#include "GLCamera.h"
+#include "SceneRenderer.h"
+
+class TriangleMesh;
+struct MaterialPreset;
+
+
+// Renders the model view to PNG files without a window, in its own context on
+// a QOffscreenSurface. Used by the batch renderer and the render daemon.
+//
+// Images are read back through a ring of pixel buffers, so the copy of one
+// image overlaps the rendering of the next, and encoded on worker threads.
+// The frames of the recorder are handed out as images instead.
+class OffscreenRenderer : protected QOpenGLFunctions_4_5_Core
+{
+public:
+    // Runs on a PNG writer thread once the image was written or failed
+    typedef std::function<void(bool written)> Completion;
+    // Runs on the rendering thread with the image once its read completed, a
+    // null image if it failed. Rows are bottom up as read from OpenGL.
+    typedef std::function<void(const QImage& image)> FrameHandler;
+
+    OffscreenRenderer();
+    ~OffscreenRenderer();
+
+    // Creates and makes current the context, false after printing the problem.
+    // More pixel buffers let more reads overlap the rendering.
+    bool create(int samples, int readbackCount = 3);
+    SceneRenderer* sceneRenderer() const { return _renderer; }
+
+    // View by its command line name: top, bottom, front, back, left, right, iso,
+    // dimetric or trimetric
+    static bool findView(const QString& name, GLCamera::ViewProjection& view);
+    // A mesh in the given material and view, fitted to its bounding sphere
+    // like GLView::fitAll. A zoom above 1 moves closer.
+    static RenderState fittedState(TriangleMesh* mesh, const MaterialPreset& preset, GLCamera::ViewProjection view,
+                                   const QSize& size, GLfloat zoom = 1.0f, bool perspective = false);
+
+    // Draws the image and queues it for writing, returns before it is on disk
+    void render(const RenderState& state, TriangleMesh* mesh, const QString& fileName, Completion completion = Completion());
+    // Draws the image and hands it to the handler once read, in drawing order
+    void render(const RenderState& state, TriangleMesh* mesh, FrameHandler handler);
+    // Completes all pending reads, the PNG writers keep running
+    void flush();
+    // Completes all reads and waits until every queued image is written
+    void finish();
+
+    int failedCount() const { return _failed.loadAcquire(); }
+
+private:
+    // A pixel buffer with a pending read of one image
+    struct Readback
+    {
+        GLuint pbo;
+        GLsizeiptr capacity;
+        GLsync fence;
+        QSize size;
+        QString fileName;
+        Completion completion;
+        FrameHandler frameHandler;
+    };
+
+    void destroy();
+    // Draws into the multisampled target and resolves it
+    void draw(const RenderState& state, TriangleMesh* mesh);
+    // Queues the read of the resolved image, finishing the oldest read if the ring is full
+    Readback& startReadback(const QSize& size);
+    // Waits for the read, copies the pixels out and hands them to a PNG writer
+    void finishReadback(Readback& readback);
+
+    int _samples;
+    QOpenGLContext* _context;
+    QOffscreenSurface* _surface;
+    SceneRenderer* _renderer;
+
+    // Multisampled target and its resolve, the source of the reads
+    QOpenGLFramebufferObject* _target;
+    QOpenGLFramebufferObject* _resolve;
+
+    std::vector<Readback> _readbacks;
+    int _nextReadback;
+
+    QThreadPool _writers;
+    QAtomicInt _failed;
+};
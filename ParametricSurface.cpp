@@ -1,5 +1,7 @@
 #include "ParametricSurface.h"
 #include "Point.h"
+#include "CpuTrace.h"
+#include "MemoryStatistics.h"
 
 #include <glm/gtc/constants.hpp>
 #include <glm/vec3.hpp>
@@ -66,6 +68,7 @@ glm::vec3 ParametricSurface::normalAtParameter(const float& u, const float& v)
 
 void ParametricSurface::buildMesh(GLuint nSlices, GLuint nStacks)
 {
+	TRACE_SCOPE("ParametricSurface::buildMesh");
 	int nVerts = ((nSlices + 1) * (nStacks + 1));
 	int elements = ((nSlices * (nStacks)) * 4);
 
@@ -86,6 +89,8 @@ void ParametricSurface::buildMesh(GLuint nSlices, GLuint nStacks)
 	GLuint idx = 0, tIdx = 0;
 	for (GLuint i = 0; i <= nSlices; i++)
 	{
+		// One slice of points and normals
+		TRACE_SCOPE("ParametricSurface::normalAtParameter batch");
 		v = firstVParameter();
 		s = (GLfloat)i / nSlices;
 		for (GLuint j = 0; j <= nStacks; j++)
@@ -135,6 +140,8 @@ void ParametricSurface::buildMesh(GLuint nSlices, GLuint nStacks)
 		}
 	}
 
+	MemoryStatistics::recordTransient("ParametricSurface::buildMesh",
+		MemoryStatistics::vectorBytes(p) + MemoryStatistics::vectorBytes(n) + MemoryStatistics::vectorBytes(tex) + MemoryStatistics::vectorBytes(el));
 	initBuffers(&el, &p, &n, &tex);
 	computeBoundingSphere(p);
 }
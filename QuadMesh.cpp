@@ -1,4 +1,5 @@
 #include "QuadMesh.h"
+#include "DrawStatistics.h"
 
 
 
@@ -9,6 +10,18 @@ void QuadMesh::render()
 
 	_vertexArrayObject.bind();
 	glDrawElements(GL_QUADS, nVerts, GL_UNSIGNED_INT, 0);
+	DrawStatistics::count(GL_QUADS, nVerts);
+	_vertexArrayObject.release();
+}
+
+void QuadMesh::renderInstanced(GLsizei instances)
+{
+	if (!_vertexArrayObject.isCreated())
+		return;
+
+	_vertexArrayObject.bind();
+	glDrawElementsInstanced(GL_QUADS, nVerts, GL_UNSIGNED_INT, 0, instances);
+	DrawStatistics::count(GL_QUADS, nVerts, instances);
 	_vertexArrayObject.release();
 }
 
@@ -13,5 +13,7 @@ public:
 
     virtual ~QuadMesh();
 	virtual void render();
+	virtual void renderInstanced(GLsizei instances);
+	virtual GLenum primitiveType() const { return GL_QUADS; }
 
 };
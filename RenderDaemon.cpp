@@ -0,0 +1,394 @@
+#include "RenderDaemon.h"
+#include "ModelCatalogue.h"
+#include "TriangleMesh.h"
+
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QTimer>
+
+#include <iostream>
+#include <string>
+#include <algorithm>
+#include <memory>
+
+void StdinReader::run()
+{
+    std::string line;
+    while (std::getline(std::cin, line))
+        emit lineRead(QByteArray::fromStdString(line));
+}
+
+RenderDaemon::RenderDaemon(QObject* parent) : QObject(parent),
+    _samples(4),
+    _cacheSize(8),
+    _readStdin(true),
+    _stdinClosed(false),
+    _server(nullptr),
+    _stdinReader(nullptr),
+    _sequence(0),
+    _scheduled(false),
+    _pending(0),
+    _replies(std::cout.rdbuf())
+{
+    _clock.start();
+}
+
+RenderDaemon::~RenderDaemon()
+{
+    _renderer.finish();
+    for (CachedMesh& entry : _meshCache)
+        delete entry.mesh;
+
+    // Blocked in a read, nothing to clean up in it
+    if (_stdinReader && _stdinReader->isRunning())
+        _stdinReader->terminate();
+    std::cout.rdbuf(_replies);
+}
+
+void RenderDaemon::printUsage()
+{
+    cerr << "Usage: MatlEditor --daemon [options]\n"
+         << "  --socket <name>  Also accept jobs from clients of this local socket\n"
+         << "  --no-stdin       Only accept jobs from the socket\n"
+         << "  --cache <n>      Meshes kept built between jobs, default 8\n"
+         << "  --samples <n>    Multisampling, default 4\n"
+         << "Jobs are JSON objects, one per line, with the keys id, model, parameters,\n"
+         << "material, camera (view, zoom, projection), size, output and priority.\n";
+}
+
+bool RenderDaemon::parseArguments(const QStringList& arguments)
+{
+    for (int i = arguments.indexOf("--daemon") + 1; i < arguments.size(); i++)
+    {
+        const QString& option = arguments.at(i);
+        if (option == "--help")
+        {
+            printUsage();
+            return false;
+        }
+        if (option == "--no-stdin")
+        {
+            _readStdin = false;
+            continue;
+        }
+        if (i + 1 >= arguments.size())
+        {
+            cerr << "Missing value for " << option.toStdString() << endl;
+            return false;
+        }
+        const QString& value = arguments.at(++i);
+
+        if (option == "--socket")
+            _socketName = value;
+        else if (option == "--cache")
+            _cacheSize = qMax(1, value.toInt());
+        else if (option == "--samples")
+            _samples = qMax(0, value.toInt());
+        else
+        {
+            cerr << "Unknown option " << option.toStdString() << endl;
+            printUsage();
+            return false;
+        }
+    }
+
+    if (!_readStdin && _socketName.isEmpty())
+    {
+        cerr << "--no-stdin needs a --socket" << endl;
+        return false;
+    }
+    return true;
+}
+
+bool RenderDaemon::start()
+{
+    // Stdout carries only reply lines, whatever else prints goes to stderr
+    std::cout.rdbuf(std::cerr.rdbuf());
+
+    if (!_renderer.create(_samples))
+        return false;
+
+    if (!_socketName.isEmpty())
+    {
+        // A socket left behind by a crashed daemon would block listen()
+        QLocalServer::removeServer(_socketName);
+        _server = new QLocalServer(this);
+        if (!_server->listen(_socketName))
+        {
+            cerr << "Could not listen on " << _socketName.toStdString() << ": "
+                 << _server->errorString().toStdString() << endl;
+            return false;
+        }
+        connect(_server, SIGNAL(newConnection()), this, SLOT(acceptConnection()));
+    }
+
+    if (_readStdin)
+    {
+        _stdinReader = new StdinReader(this);
+        connect(_stdinReader, SIGNAL(lineRead(QByteArray)), this, SLOT(readStdin(QByteArray)));
+        connect(_stdinReader, SIGNAL(finished()), this, SLOT(stdinClosed()));
+        _stdinReader->start();
+    }
+    return true;
+}
+
+void RenderDaemon::readStdin(const QByteArray& line)
+{
+    submit(line, nullptr);
+}
+
+void RenderDaemon::stdinClosed()
+{
+    _stdinClosed = true;
+    quitWhenIdle();
+}
+
+void RenderDaemon::acceptConnection()
+{
+    while (QLocalSocket* client = _server->nextPendingConnection())
+    {
+        connect(client, SIGNAL(readyRead()), this, SLOT(readSocket()));
+        connect(client, SIGNAL(disconnected()), client, SLOT(deleteLater()));
+    }
+}
+
+void RenderDaemon::readSocket()
+{
+    QLocalSocket* client = qobject_cast<QLocalSocket*>(sender());
+    while (client && client->canReadLine())
+        submit(client->readLine(), client);
+}
+
+void RenderDaemon::submit(const QByteArray& line, QLocalSocket* client)
+{
+    if (line.trimmed().isEmpty())
+        return;
+
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(line, &parseError);
+    Job job;
+    QString error;
+    if (!document.isObject())
+        error = parseError.errorString();
+    else if (parseJob(document.object(), job, error))
+    {
+        job.client = client;
+        job.fromStdin = !client;
+        job.received = _clock.elapsed();
+        job.sequence = _sequence++;
+        _queue.push_back(job);
+        scheduleProcessing();
+        return;
+    }
+
+    QJsonObject message;
+    message["id"] = document.object().value("id");
+    message["status"] = "error";
+    message["error"] = error;
+    reply(!client, client, message);
+}
+
+bool RenderDaemon::parseJob(const QJsonObject& object, Job& job, QString& error)
+{
+    job.id = object.value("id").toVariant().toString();
+    job.priority = object.value("priority").toInt(0);
+
+    job.model = ModelCatalogue::find(object.value("model").toVariant().toString());
+    if (job.model < 0)
+    {
+        error = "unknown model";
+        return false;
+    }
+    job.parameters = object.value("parameters").toObject().toVariantMap();
+    // Object keys are sorted, so equal parameters give equal keys
+    job.meshKey = QString::number(job.model) + ":" +
+                  QJsonDocument(object.value("parameters").toObject()).toJson(QJsonDocument::Compact);
+
+    QJsonValue material = object.value("material");
+    if (material.isObject())
+    {
+        // Custom colours under the light of the presets
+        QJsonObject colors = material.toObject();
+        job.material = materialPresets().front();
+        job.material.name = nullptr;
+        auto color = [&colors](const char* key, const QVector3D& value) {
+            QJsonArray rgb = colors.value(key).toArray();
+            return rgb.size() == 3 ? QVector3D(rgb[0].toDouble(), rgb[1].toDouble(), rgb[2].toDouble()) : value;
+        };
+        job.material.ambiMat = color("ambient", job.material.ambiMat);
+        job.material.diffMat = color("diffuse", job.material.diffMat);
+        job.material.specMat = color("specular", job.material.specMat);
+        job.material.shine = colors.value("shininess").toDouble(job.material.shine);
+    }
+    else
+    {
+        const MaterialPreset* preset = findMaterialPreset(material.toString("chrome"));
+        if (!preset)
+        {
+            error = "unknown material";
+            return false;
+        }
+        job.material = *preset;
+    }
+
+    QJsonValue camera = object.value("camera");
+    QJsonObject cameraObject = camera.isObject() ? camera.toObject() : QJsonObject({ { "view", camera } });
+    if (!OffscreenRenderer::findView(cameraObject.value("view").toString("iso"), job.view))
+    {
+        error = "unknown view";
+        return false;
+    }
+    job.zoom = cameraObject.value("zoom").toDouble(1.0);
+    job.perspective = cameraObject.value("projection").toString() == "perspective";
+
+    QJsonValue size = object.value("size");
+    if (size.isArray())
+        job.size = QSize(size.toArray().at(0).toInt(), size.toArray().at(1).toInt());
+    else
+    {
+        QStringList dimensions = size.toString("512x512").split('x');
+        job.size = dimensions.size() == 2 ? QSize(dimensions[0].toInt(), dimensions[1].toInt()) : QSize();
+    }
+    if (job.size.width() <= 0 || job.size.height() <= 0 || job.size.width() > 16384 || job.size.height() > 16384)
+    {
+        error = "invalid size";
+        return false;
+    }
+
+    job.output = object.value("output").toString();
+    if (job.output.isEmpty())
+    {
+        error = "no output";
+        return false;
+    }
+    return true;
+}
+
+void RenderDaemon::scheduleProcessing()
+{
+    if (!_scheduled)
+    {
+        _scheduled = true;
+        QTimer::singleShot(0, this, SLOT(processQueue()));
+    }
+}
+
+void RenderDaemon::processQueue()
+{
+    _scheduled = false;
+    if (_queue.empty())
+        return;
+
+    // Highest priority first, then in arrival order
+    std::stable_sort(_queue.begin(), _queue.end(), [](const Job& a, const Job& b) {
+        return a.priority != b.priority ? a.priority > b.priority : a.sequence < b.sequence;
+    });
+
+    // Take every queued job for the same mesh along, it is drawn without a rebuild
+    QString key = _queue.front().meshKey;
+    std::vector<Job> batch;
+    auto end = std::stable_partition(_queue.begin(), _queue.end(), [&key](const Job& job) { return job.meshKey == key; });
+    batch.assign(_queue.begin(), end);
+    _queue.erase(_queue.begin(), end);
+
+    qint64 start = _clock.elapsed();
+    bool cached = false;
+    TriangleMesh* batchMesh = mesh(batch.front(), cached);
+    qint64 meshTime = _clock.elapsed() - start;
+
+    for (size_t i = 0; i < batch.size(); i++)
+    {
+        const Job& job = batch[i];
+        qint64 renderStart = _clock.elapsed();
+        RenderState state = OffscreenRenderer::fittedState(batchMesh, job.material, job.view, job.size, job.zoom, job.perspective);
+
+        QJsonObject message;
+        message["id"] = job.id;
+        message["batch"] = static_cast<int>(batch.size());
+        message["meshCached"] = cached || i > 0;
+        message["queueMs"] = static_cast<double>(start - job.received);
+        message["meshMs"] = static_cast<double>(i == 0 ? meshTime : 0);
+
+        // Set before the read of this image completes, which starts its writer
+        std::shared_ptr<qint64> renderEnd = std::make_shared<qint64>(0);
+        QPointer<QLocalSocket> client = job.client;
+        bool fromStdin = job.fromStdin;
+        qint64 received = job.received;
+        _pending++;
+        _renderer.render(state, batchMesh, job.output, [=](bool written) {
+            // On a writer thread, answer from the event loop
+            qint64 done = _clock.elapsed();
+            QMetaObject::invokeMethod(this, [=]() {
+                QJsonObject result = message;
+                result["status"] = written ? "done" : "error";
+                if (!written)
+                    result["error"] = "could not write the image";
+                result["renderMs"] = static_cast<double>(*renderEnd - renderStart);
+                result["writeMs"] = static_cast<double>(done - *renderEnd);
+                result["totalMs"] = static_cast<double>(done - received);
+                reply(fromStdin, client, result);
+                _pending--;
+                quitWhenIdle();
+            }, Qt::QueuedConnection);
+        });
+        *renderEnd = _clock.elapsed();
+    }
+
+    // Nothing more to overlap the pending reads with
+    if (_queue.empty())
+        _renderer.flush();
+    else
+        scheduleProcessing();
+}
+
+TriangleMesh* RenderDaemon::mesh(const Job& job, bool& cached)
+{
+    for (CachedMesh& entry : _meshCache)
+    {
+        if (entry.key == job.meshKey)
+        {
+            entry.lastUsed = _clock.elapsed();
+            cached = true;
+            return entry.mesh;
+        }
+    }
+
+    // Evict the least recently used mesh, pending reads do not need it
+    if (static_cast<int>(_meshCache.size()) >= _cacheSize)
+    {
+        auto oldest = std::min_element(_meshCache.begin(), _meshCache.end(), [](const CachedMesh& a, const CachedMesh& b) {
+            return a.lastUsed < b.lastUsed;
+        });
+        _renderer.sceneRenderer()->releaseMesh(oldest->mesh);
+        delete oldest->mesh;
+        _meshCache.erase(oldest);
+    }
+
+    CachedMesh entry;
+    entry.key = job.meshKey;
+    entry.mesh = ModelCatalogue::create(job.model, _renderer.sceneRenderer()->modelShader(), job.parameters);
+    entry.lastUsed = _clock.elapsed();
+    _meshCache.push_back(entry);
+    cached = false;
+    return entry.mesh;
+}
+
+void RenderDaemon::reply(bool toStdout, QLocalSocket* client, const QJsonObject& message)
+{
+    QByteArray line = QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n';
+    if (toStdout)
+    {
+        std::ostream replies(_replies);
+        replies << line.constData() << std::flush;
+    }
+    else if (client && client->state() == QLocalSocket::ConnectedState)
+        client->write(line);
+}
+
+void RenderDaemon::quitWhenIdle()
+{
+    // With stdin as the only source the daemon ends with its input
+    if (_stdinClosed && !_server && _queue.empty() && _pending == 0)
+        QCoreApplication::quit();
+}
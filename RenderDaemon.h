@@ -0,0 +1,121 @@
+#pragma once
+
+#include <vector>
+#include <streambuf>
+
+#include <QObject>
+#include <QThread>
+#include <QPointer>
+#include <QElapsedTimer>
+#include <QVariantMap>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+#include "OffscreenRenderer.h"
+#include "MaterialPresets.h"
+
+class TriangleMesh;
+
+
+// Reads job lines from stdin without blocking the event loop
+class StdinReader : public QThread
+{
+    Q_OBJECT
+public:
+    StdinReader(QObject* parent = nullptr) : QThread(parent) {}
+
+signals:
+    void lineRead(const QByteArray& line);
+
+protected:
+    void run() override;
+};
+
+
+// Render server started with --daemon. It keeps the context, the compiled
+// shaders and recently used meshes alive between jobs. Jobs are JSON objects,
+// one per line, read from stdin or from clients of a local socket (--socket):
+//
+//   {"id": "42", "model": "Spring", "parameters": {"turns": 4},
+//    "material": "brass", "camera": {"view": "iso", "zoom": 1.2},
+//    "size": [800, 600], "output": "spring.png", "priority": 1}
+//
+// The material may also be an object with ambient, diffuse and specular colours
+// and a shininess. Higher priorities run first; queued jobs for the same mesh
+// are drawn together. Every job is answered with one line carrying its timings.
+class RenderDaemon : public QObject
+{
+    Q_OBJECT
+public:
+    RenderDaemon(QObject* parent = nullptr);
+    ~RenderDaemon();
+
+    // Reads the options following --daemon, false after printing the problem
+    bool parseArguments(const QStringList& arguments);
+    // Creates the context and starts listening
+    bool start();
+
+    static void printUsage();
+
+private slots:
+    void readStdin(const QByteArray& line);
+    void stdinClosed();
+    void acceptConnection();
+    void readSocket();
+    void processQueue();
+
+private:
+    struct Job
+    {
+        QString id;
+        int priority;
+        qint64 sequence;      // Arrival order within a priority
+        int model;
+        QVariantMap parameters;
+        QString meshKey;      // Model and parameters, jobs with the same key share a mesh
+        MaterialPreset material;
+        GLCamera::ViewProjection view;
+        GLfloat zoom;
+        bool perspective;
+        QSize size;
+        QString output;
+        QPointer<QLocalSocket> client;
+        bool fromStdin;
+        qint64 received;
+    };
+
+    struct CachedMesh
+    {
+        QString key;
+        TriangleMesh* mesh;
+        qint64 lastUsed;
+    };
+
+    void submit(const QByteArray& line, QLocalSocket* client);
+    bool parseJob(const QJsonObject& object, Job& job, QString& error);
+    void scheduleProcessing();
+    // Mesh of the job from the cache, built and cached on a miss
+    TriangleMesh* mesh(const Job& job, bool& cached);
+    // A line of JSON to the client of a job, or to stdout for jobs from stdin
+    void reply(bool toStdout, QLocalSocket* client, const QJsonObject& message);
+    void quitWhenIdle();
+
+    OffscreenRenderer _renderer;
+    int _samples;
+    int _cacheSize;
+    QString _socketName;
+    bool _readStdin;
+    bool _stdinClosed;
+
+    QLocalServer* _server;
+    StdinReader* _stdinReader;
+
+    std::vector<Job> _queue;
+    std::vector<CachedMesh> _meshCache;
+    qint64 _sequence;
+    bool _scheduled;
+    int _pending;             // Jobs drawn but not yet written
+    QElapsedTimer _clock;
+    std::streambuf* _replies; // Stdout, std::cout goes to stderr while the daemon runs
+};
@@ -0,0 +1,197 @@
+#include "RenderThread.h"
+#include "TriangleMesh.h"
+#include "CpuTrace.h"
+
+#include <QCoreApplication>
+
+RenderThread::RenderThread(QOpenGLContext* shareContext, const std::vector<TriangleMesh*>& meshes, QObject* parent) : QThread(parent),
+    _meshes(meshes),
+    _hasPending(false),
+    _quit(false),
+    _target(nullptr),
+    _renderIndex(0),
+    _readyIndex(1),
+    _displayIndex(2),
+    _readyFresh(false)
+{
+    for (Buffer& buffer : _buffers)
+    {
+        buffer.fbo = nullptr;
+        buffer.ready = 0;
+        buffer.released = 0;
+    }
+
+    // Context and surface are created here, the surface has to be on the GUI thread
+    _context = new QOpenGLContext();
+    _context->setFormat(shareContext->format());
+    _context->setShareContext(shareContext);
+    if (!_context->create())
+        qDebug() << "Could not create the render thread context";
+    _context->moveToThread(this);
+
+    _surface = new QOffscreenSurface();
+    _surface->setFormat(_context->format());
+    _surface->create();
+}
+
+RenderThread::~RenderThread()
+{
+    stop();
+    wait();
+    delete _context;
+    delete _surface;
+}
+
+void RenderThread::postState(const RenderState& state)
+{
+    QMutexLocker lock(&_mutex);
+    _pending = state;
+    _hasPending = true;
+    _wake.wakeOne();
+}
+
+void RenderThread::stop()
+{
+    QMutexLocker lock(&_mutex);
+    _quit = true;
+    _wake.wakeOne();
+}
+
+bool RenderThread::acquireFrame(Frame& frame)
+{
+    QMutexLocker lock(&_mutex);
+    if (_readyFresh)
+    {
+        std::swap(_displayIndex, _readyIndex);
+        _readyFresh = false;
+    }
+
+    Buffer& buffer = _buffers[_displayIndex];
+    if (!buffer.fbo)
+        return false;
+
+    frame.index = _displayIndex;
+    frame.texture = buffer.fbo->texture();
+    frame.size = buffer.size;
+    frame.ready = buffer.ready;
+    buffer.ready = 0;
+    return true;
+}
+
+void RenderThread::releaseFrame(int index, GLsync released)
+{
+    QMutexLocker lock(&_mutex);
+    Buffer& buffer = _buffers[index];
+    if (buffer.released)
+        glDeleteSync(buffer.released);
+    buffer.released = released;
+}
+
+void RenderThread::run()
+{
+    TRACE_THREAD_NAME("Render");
+    if (!_context->makeCurrent(_surface))
+    {
+        qDebug() << "Could not make the render thread context current";
+        return;
+    }
+    initializeOpenGLFunctions();
+
+    SceneRenderer* renderer = new SceneRenderer();
+    bool initialized = renderer->initialize();
+
+    forever
+    {
+        RenderState state;
+        {
+            QMutexLocker lock(&_mutex);
+            while (!_hasPending && !_quit)
+                _wake.wait(&_mutex);
+            if (_quit)
+                break;
+            state = _pending;
+            _hasPending = false;
+        }
+
+        if (initialized && renderFrame(*renderer, state))
+            emit frameReady();
+    }
+
+    // Clean up in this context, then hand it back for deletion
+    delete renderer;
+    delete _target;
+    for (Buffer& buffer : _buffers)
+    {
+        delete buffer.fbo;
+        if (buffer.ready)
+            glDeleteSync(buffer.ready);
+        if (buffer.released)
+            glDeleteSync(buffer.released);
+    }
+    _context->doneCurrent();
+    _context->moveToThread(QCoreApplication::instance()->thread());
+}
+
+bool RenderThread::renderFrame(SceneRenderer& renderer, const RenderState& state)
+{
+    TRACE_SCOPE("RenderThread::renderFrame");
+    if (state.modelIndex < 0 || state.modelIndex >= static_cast<int>(_meshes.size()))
+        return false;
+
+    QSize size(qMax(1, state.width), qMax(1, state.height));
+
+    // The GUI may still be sampling this buffer from an earlier display
+    Buffer* buffer;
+    GLsync released;
+    {
+        QMutexLocker lock(&_mutex);
+        buffer = &_buffers[_renderIndex];
+        released = buffer->released;
+        buffer->released = 0;
+        if (buffer->ready)
+        {
+            // Never displayed, the newer frame replaces it
+            glDeleteSync(buffer->ready);
+            buffer->ready = 0;
+        }
+    }
+    if (released)
+    {
+        glWaitSync(released, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(released);
+    }
+
+    if (!_target || _target->size() != size)
+    {
+        delete _target;
+        QOpenGLFramebufferObjectFormat targetFormat;
+        targetFormat.setAttachment(QOpenGLFramebufferObject::Depth);
+        targetFormat.setSamples(_context->format().samples());
+        _target = new QOpenGLFramebufferObject(size, targetFormat);
+    }
+    if (!buffer->fbo || buffer->size != size)
+    {
+        delete buffer->fbo;
+        buffer->fbo = new QOpenGLFramebufferObject(size);
+        buffer->size = size;
+    }
+
+    _target->bind();
+    bool drawn = renderer.render(state, _meshes.at(state.modelIndex));
+    if (drawn)
+        QOpenGLFramebufferObject::blitFramebuffer(buffer->fbo, _target);
+    _target->release();
+    // Rebuilt on the GUI thread meanwhile, its next state has the new geometry
+    if (!drawn)
+        return false;
+
+    // Flushed so the GUI context can wait on the fence
+    GLsync ready = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+
+    QMutexLocker lock(&_mutex);
+    buffer->ready = ready;
+    std::swap(_renderIndex, _readyIndex);
+    _readyFresh = true;
+    return true;
+}
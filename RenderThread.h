@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vector>
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QOffscreenSurface>
+#include <QtOpenGL>
+#include <QOpenGLFunctions_4_5_Core>
+
+#include "SceneRenderer.h"
+
+class TriangleMesh;
+
+
+// Renders the model view on its own thread, in a context shared with the GUI
+// context, into offscreen frames the GUI thread composites. The GUI thread only
+// posts RenderState snapshots, so a slow frame never blocks it.
+//
+// Frames are triple buffered: one being rendered, the newest finished one and
+// the one the GUI displays. Fences order the GPU work across the two contexts.
+class RenderThread : public QThread, protected QOpenGLFunctions_4_5_Core
+{
+    Q_OBJECT
+public:
+    // A finished frame handed to the GUI context
+    struct Frame
+    {
+        int index;
+        GLuint texture;
+        QSize size;
+        GLsync ready; // Wait on it before sampling, then delete it. 0 if already waited on.
+    };
+
+    // Must be constructed on the GUI thread with the share context current
+    RenderThread(QOpenGLContext* shareContext, const std::vector<TriangleMesh*>& meshes, QObject* parent = nullptr);
+    ~RenderThread();
+
+    // Replaces any state the thread has not picked up yet, only the newest is drawn
+    void postState(const RenderState& state);
+    void stop();
+
+    // Takes the newest finished frame, false before the first one
+    bool acquireFrame(Frame& frame);
+    // Fence after the GUI commands reading the acquired frame
+    void releaseFrame(int index, GLsync released);
+
+signals:
+    void frameReady();
+
+protected:
+    void run() override;
+
+private:
+    struct Buffer
+    {
+        QOpenGLFramebufferObject* fbo; // Resolved, single sample
+        QSize size;
+        GLsync ready;
+        GLsync released;
+    };
+
+    // False if nothing new was published
+    bool renderFrame(SceneRenderer& renderer, const RenderState& state);
+
+    QOpenGLContext* _context;
+    QOffscreenSurface* _surface;
+    std::vector<TriangleMesh*> _meshes;
+
+    QMutex _mutex;
+    QWaitCondition _wake;
+    RenderState _pending;
+    bool _hasPending;
+    bool _quit;
+
+    // Multisampled target, resolved into the buffer being rendered
+    QOpenGLFramebufferObject* _target;
+    Buffer _buffers[3];
+    int _renderIndex;
+    int _readyIndex;
+    int _displayIndex;
+    bool _readyFresh;
+};
@@ -0,0 +1,174 @@
+#include "SceneRenderer.h"
+#include "TriangleMesh.h"
+#include "DrawStatistics.h"
+
+SceneRenderer::SceneRenderer()
+{
+}
+
+SceneRenderer::~SceneRenderer()
+{
+    for (auto& entry : _vertexArrays)
+    {
+        entry.second.vao->destroy();
+        delete entry.second.vao;
+    }
+    _bgVAO.destroy();
+}
+
+bool SceneRenderer::initialize()
+{
+    initializeOpenGLFunctions();
+
+    // per fragment lighting
+    if (!_fgShader.addShaderFromSourceFile(QOpenGLShader::Vertex, "shaders/twoside_per_fragment.vert")) {
+        qDebug() << "Error in vertex shader:" << _fgShader.log();
+        return false;
+    }
+    if (!_fgShader.addShaderFromSourceFile(QOpenGLShader::Fragment, "shaders/twoside_per_fragment.frag")) {
+        qDebug() << "Error in fragment shader:" << _fgShader.log();
+        return false;
+    }
+    if (!_fgShader.link()) {
+        qDebug() << "Error linking shader program:" << _fgShader.log();
+        return false;
+    }
+
+    // background gradient
+    if (!_bgShader.addShaderFromSourceFile(QOpenGLShader::Vertex, "shaders/background.vert")) {
+        qDebug() << "Error in vertex shader:" << _bgShader.log();
+        return false;
+    }
+    if (!_bgShader.addShaderFromSourceFile(QOpenGLShader::Fragment, "shaders/background.frag")) {
+        qDebug() << "Error in fragment shader:" << _bgShader.log();
+        return false;
+    }
+    if (!_bgShader.link()) {
+        qDebug() << "Error linking shader program:" << _bgShader.log();
+        return false;
+    }
+    _bgVAO.create();
+
+    return true;
+}
+
+bool SceneRenderer::render(const RenderState& state, TriangleMesh* mesh)
+{
+    glViewport(0, 0, state.width, state.height);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // Same gradient as GLView
+    glDisable(GL_DEPTH_TEST);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    _bgShader.bind();
+    _bgShader.setUniformValue("top_color", QVector4D(0.3f, 0.3f, 0.3f, 1.0f));
+    _bgShader.setUniformValue("bot_color", QVector4D(0.925f, 0.913f, 0.847f, 1.0f));
+    _bgVAO.bind();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    DrawStatistics::count(GL_TRIANGLES, 3);
+    _bgVAO.release();
+    _bgShader.release();
+    glEnable(GL_DEPTH_TEST);
+
+    if (!mesh || state.indexCount == 0)
+        return true;
+
+    // The buffers must stay as captured until the draw below reads them on the GPU
+    QMutexLocker lock(mesh->bufferLock());
+    if (mesh->generation() != state.geometryGeneration)
+        return false;
+
+    _fgShader.bind();
+    _fgShader.setUniformValue("lightSource.ambient", state.ambiLight.toVector3D());
+    _fgShader.setUniformValue("lightSource.diffuse", state.diffLight.toVector3D());
+    _fgShader.setUniformValue("lightSource.specular", state.specLight.toVector3D());
+    _fgShader.setUniformValue("lightSource.position", state.lightPosition);
+    _fgShader.setUniformValue("lightModel.ambient", QVector3D(0.2f, 0.2f, 0.2f));
+    _fgShader.setUniformValue("material.emission", state.emmiMat.toVector3D());
+    _fgShader.setUniformValue("material.ambient", state.ambiMat.toVector3D());
+    _fgShader.setUniformValue("material.diffuse", state.diffMat.toVector3D());
+    _fgShader.setUniformValue("material.specular", state.specMat.toVector3D());
+    _fgShader.setUniformValue("material.shininess", state.shine);
+    _fgShader.setUniformValue("b_texEnabled", state.hasTexture && state.texture != 0);
+    _fgShader.setUniformValue("f_alpha", state.opacity);
+
+    _fgShader.setUniformValue("modelViewMatrix", state.modelViewMatrix);
+    _fgShader.setUniformValue("normalMatrix", state.modelViewMatrix.normalMatrix());
+    _fgShader.setUniformValue("projectionMatrix", state.projectionMatrix);
+    _fgShader.setUniformValue("b_wireframe", !state.shaded);
+
+    glPolygonMode(GL_FRONT_AND_BACK, state.shaded ? GL_FILL : GL_LINE);
+    glLineWidth(state.shaded ? 1.0 : 1.5);
+
+    // Clipping Planes
+    for (int i = 0; i < 3; i++)
+    {
+        if (state.clipEnabled[i])
+            glEnable(GL_CLIP_DISTANCE0 + i);
+    }
+    _fgShader.setUniformValue("b_SectionActive", state.clipEnabled[0] || state.clipEnabled[1] || state.clipEnabled[2]);
+    _fgShader.setUniformValue("clipPlaneX", state.clipPlanes[0]);
+    _fgShader.setUniformValue("clipPlaneY", state.clipPlanes[1]);
+    _fgShader.setUniformValue("clipPlaneZ", state.clipPlanes[2]);
+
+    // Render
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, state.texture);
+    _fgShader.setUniformValue("texUnit", 0);
+
+    QOpenGLVertexArrayObject* vao = vertexArray(mesh);
+    vao->bind();
+    glDrawElements(state.primitiveType, state.indexCount, GL_UNSIGNED_INT, 0);
+    DrawStatistics::count(state.primitiveType, state.indexCount);
+    vao->release();
+
+    // Flushed, a rebuild in another context waits on the fence
+    mesh->setReadFence(this, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    glFlush();
+    lock.unlock();
+
+    glDisable(GL_CLIP_DISTANCE0);
+    glDisable(GL_CLIP_DISTANCE1);
+    glDisable(GL_CLIP_DISTANCE2);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+    _fgShader.release();
+    return true;
+}
+
+void SceneRenderer::releaseMesh(TriangleMesh* mesh)
+{
+    auto it = _vertexArrays.find(mesh);
+    if (it == _vertexArrays.end())
+        return;
+    it->second.vao->destroy();
+    delete it->second.vao;
+    _vertexArrays.erase(it);
+}
+
+QOpenGLVertexArrayObject* SceneRenderer::vertexArray(TriangleMesh* mesh)
+{
+    auto it = _vertexArrays.find(mesh);
+    if (it == _vertexArrays.end())
+    {
+        VertexArray entry;
+        entry.vao = new QOpenGLVertexArrayObject();
+        entry.vao->create();
+        entry.generation = mesh->generation() - 1;
+        it = _vertexArrays.insert(std::make_pair(mesh, entry)).first;
+    }
+
+    // Rebinding also picks up buffers reallocated in another context
+    if (it->second.generation != mesh->generation())
+    {
+        it->second.vao->bind();
+        mesh->setupVertexArray(this);
+        it->second.vao->release();
+        it->second.generation = mesh->generation();
+    }
+    return it->second.vao;
+}
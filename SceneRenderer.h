@@ -0,0 +1,83 @@
+#pragma once
+
+#include <map>
+
+#include <QtOpenGL>
+#include <QOpenGLFunctions_4_5_Core>
+
+class TriangleMesh;
+
+
+/// Everything needed to draw one frame of the model view. It is copied out of
+/// GLView so a renderer in another thread or context never reads live state.
+/// The mesh is drawn as it was captured, or not at all once it was rebuilt.
+struct RenderState
+{
+    int width;
+    int height;
+
+    int modelIndex;                  // Index into the mesh store
+    unsigned int geometryGeneration; // TriangleMesh::generation() when captured
+    GLuint indexCount;               // Of that generation
+    GLenum primitiveType;
+
+    QMatrix4x4 projectionMatrix;
+    QMatrix4x4 modelViewMatrix;
+
+    QVector4D ambiLight;
+    QVector4D diffLight;
+    QVector4D specLight;
+    QVector3D lightPosition;
+
+    QVector4D ambiMat;
+    QVector4D diffMat;
+    QVector4D specMat;
+    QVector4D emmiMat;
+    GLfloat opacity;
+    GLfloat shine;
+
+    bool hasTexture;
+    GLuint texture;                  // Shared texture object, 0 for none
+    bool shaded;
+
+    bool clipEnabled[3];
+    QVector4D clipPlanes[3];         // Eye space
+};
+
+
+// Draws the model view described by a RenderState into the bound framebuffer
+// of the current context. Shader programs and vertex arrays are owned per
+// context, the meshes and their buffers come from the share group.
+class SceneRenderer : public QOpenGLFunctions_4_5_Core
+{
+public:
+    SceneRenderer();
+    ~SceneRenderer();
+
+    // Compiles the shaders, needs a current context
+    bool initialize();
+    // False if the mesh was rebuilt since the state was captured, the frame then
+    // has only the background
+    bool render(const RenderState& state, TriangleMesh* mesh);
+    // Drops the vertex array of a mesh about to be deleted. The cache is keyed by
+    // the pointer, a mesh allocated later at the same address must not find it.
+    void releaseMesh(TriangleMesh* mesh);
+    // Program whose attribute locations meshes built for this renderer use
+    QOpenGLShaderProgram* modelShader() { return &_fgShader; }
+
+private:
+    struct VertexArray
+    {
+        QOpenGLVertexArrayObject* vao;
+        unsigned int generation;
+    };
+
+    // Vertex array of the mesh in this context, rebuilt when the mesh was reloaded
+    QOpenGLVertexArrayObject* vertexArray(TriangleMesh* mesh);
+
+    QOpenGLShaderProgram _fgShader;
+    QOpenGLShaderProgram _bgShader;
+    QOpenGLVertexArrayObject _bgVAO;
+
+    std::map<TriangleMesh*, VertexArray> _vertexArrays;
+};
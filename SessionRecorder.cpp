@@ -0,0 +1,669 @@
+#include "SessionRecorder.h"
+#include "GLView.h"
+#include "MainWindow.h"
+
+#include <QAbstractButton>
+#include <QAbstractSlider>
+#include <QAction>
+#include <QApplication>
+#include <QComboBox>
+#include <QDateTime>
+#include <QDoubleSpinBox>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonDocument>
+#include <QMouseEvent>
+#include <QThread>
+#include <QToolButton>
+#include <QWheelEvent>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Open file dialogs or only serve the developer, a replay cannot run them
+    const char* IGNORED_CONTROLS[] = {
+        "toolButtonSnapshot", "textureButton",
+        "gpuProfilerOverlay", "gpuProfilerExport", "cpuTraceSave", "sessionRecord", "stallHistogram", "memoryStatistics"
+    };
+
+    // Open color dialogs, the color picked is recorded after they closed
+    const char* COLOR_BUTTONS[] = {
+        "pushButtonLightAmbient", "pushButtonLightDiffuse", "pushButtonLightSpecular",
+        "pushButtonMaterialAmbient", "pushButtonMaterialDiffuse", "pushButtonMaterialSpecular", "pushButtonMaterialEmissive"
+    };
+
+    bool isOneOf(const QString& name, const char* const* begin, const char* const* end)
+    {
+        return std::find_if(begin, end, [&](const char* n) { return name == n; }) != end;
+    }
+
+    QJsonArray toJson(const QVector3D& v)
+    {
+        return QJsonArray({ v.x(), v.y(), v.z() });
+    }
+
+    QJsonArray toJson(const QVector4D& v)
+    {
+        return QJsonArray({ v.x(), v.y(), v.z(), v.w() });
+    }
+
+    QVector3D toVector3D(const QJsonValue& value)
+    {
+        QJsonArray a = value.toArray();
+        return QVector3D(a[0].toDouble(), a[1].toDouble(), a[2].toDouble());
+    }
+
+    QVector4D toVector4D(const QJsonValue& value)
+    {
+        QJsonArray a = value.toArray();
+        return QVector4D(a[0].toDouble(), a[1].toDouble(), a[2].toDouble(), a[3].toDouble());
+    }
+
+    // Nearest rank percentile of sorted times
+    double percentile(const std::vector<double>& sorted, double p)
+    {
+        if (sorted.empty())
+            return 0.0;
+        size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+        return sorted[qBound<size_t>(1, rank, sorted.size()) - 1];
+    }
+
+    QJsonObject statistics(std::vector<double> times)
+    {
+        std::sort(times.begin(), times.end());
+        double total = 0.0;
+        for (double time : times)
+            total += time;
+
+        QJsonObject result;
+        result["count"] = static_cast<int>(times.size());
+        result["p50Ms"] = percentile(times, 50.0);
+        result["p95Ms"] = percentile(times, 95.0);
+        result["p99Ms"] = percentile(times, 99.0);
+        result["meanMs"] = times.empty() ? 0.0 : total / times.size();
+        result["maxMs"] = times.empty() ? 0.0 : times.back();
+        return result;
+    }
+
+    // Value of a recorded control, null for the ones without a value
+    QJsonValue controlValue(QObject* control)
+    {
+        if (QAbstractSlider* slider = qobject_cast<QAbstractSlider*>(control))
+            return slider->value();
+        if (QDoubleSpinBox* spinBox = qobject_cast<QDoubleSpinBox*>(control))
+            return spinBox->value();
+        if (QComboBox* comboBox = qobject_cast<QComboBox*>(control))
+            return comboBox->currentIndex();
+        if (QAbstractButton* button = qobject_cast<QAbstractButton*>(control))
+            return button->isCheckable() ? QJsonValue(button->isChecked()) : QJsonValue();
+        return QJsonValue();
+    }
+}
+
+SessionRecorder::SessionRecorder(QWidget* editor, GLView* view) :
+    QObject(editor),
+    _view(view),
+    _sliderAction(nullptr)
+{
+    watchControls(editor);
+    _view->installEventFilter(this);
+    connect(_view, SIGNAL(frameSwapped()), this, SLOT(recordFrame()));
+
+    QJsonObject camera;
+    camera["position"] = toJson(_view->_camera->getPosition());
+    camera["viewDir"] = toJson(_view->_camera->getViewDir());
+    camera["up"] = toJson(_view->_camera->getUpVector());
+    camera["right"] = toJson(_view->_camera->getRightVector());
+    camera["viewRange"] = _view->_viewRange;
+
+    QJsonObject controls;
+    for (QObject* control : _watched)
+    {
+        QJsonValue value = controlValue(control);
+        if (!value.isNull())
+            controls[controlPath(control)] = value;
+    }
+
+    _initialState["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    _initialState["viewSize"] = QString("%1x%2").arg(_view->width()).arg(_view->height());
+    _initialState["model"] = _view->getModelNum();
+    _initialState["camera"] = camera;
+    _initialState["controls"] = controls;
+    _initialState["material"] = material();
+
+    _clock.start();
+}
+
+QString SessionRecorder::controlPath(QObject* control)
+{
+    QWidget* widget = qobject_cast<QWidget*>(control);
+    if (!widget)
+        widget = qobject_cast<QWidget*>(control->parent());
+    QString window = widget ? widget->window()->metaObject()->className() : "";
+    return window + "/" + control->objectName();
+}
+
+void SessionRecorder::watchControls(QWidget* widget)
+{
+    for (QObject* control : widget->findChildren<QObject*>())
+    {
+        if (control->objectName().isEmpty() || _watched.count(control)
+            || isOneOf(control->objectName(), std::begin(IGNORED_CONTROLS), std::end(IGNORED_CONTROLS)))
+            continue;
+
+        // A tool button showing an action triggers the action, which is recorded
+        QToolButton* toolButton = qobject_cast<QToolButton*>(control);
+        if (toolButton && toolButton->defaultAction())
+            continue;
+
+        if (qobject_cast<QAbstractButton*>(control))
+            connect(control, SIGNAL(clicked()), this, SLOT(recordClick()));
+        else if (qobject_cast<QAbstractSlider*>(control))
+        {
+            // Drags, wheel and keys trigger an action before the value changes,
+            // setValue() from code does not
+            connect(control, SIGNAL(actionTriggered(int)), this, SLOT(sliderAction()));
+            connect(control, SIGNAL(valueChanged(int)), this, SLOT(recordValue(int)));
+        }
+        else if (qobject_cast<QDoubleSpinBox*>(control))
+            connect(control, SIGNAL(valueChanged(double)), this, SLOT(recordDoubleValue(double)));
+        else if (qobject_cast<QComboBox*>(control))
+            connect(control, SIGNAL(currentIndexChanged(int)), this, SLOT(recordValue(int)));
+        else if (qobject_cast<QAction*>(control))
+            connect(control, SIGNAL(triggered()), this, SLOT(recordAction()));
+        else
+            continue;
+        _watched.insert(control);
+        connect(control, &QObject::destroyed, this, [this, control]() { _watched.erase(control); });
+    }
+}
+
+bool SessionRecorder::eventFilter(QObject* watched, QEvent* event)
+{
+    if (watched != _view)
+        return false;
+
+    QJsonObject e;
+    switch (event->type())
+    {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseMove:
+    {
+        QMouseEvent* mouse = static_cast<QMouseEvent*>(event);
+        e["type"] = event->type() == QEvent::MouseButtonPress ? "press" :
+                    event->type() == QEvent::MouseButtonRelease ? "release" : "move";
+        e["x"] = mouse->localPos().x();
+        e["y"] = mouse->localPos().y();
+        e["button"] = static_cast<int>(mouse->button());
+        e["buttons"] = static_cast<int>(mouse->buttons());
+        e["modifiers"] = static_cast<int>(mouse->modifiers());
+        break;
+    }
+    case QEvent::Wheel:
+    {
+        QWheelEvent* wheel = static_cast<QWheelEvent*>(event);
+        e["type"] = "wheel";
+        e["x"] = wheel->position().x();
+        e["y"] = wheel->position().y();
+        e["dx"] = wheel->angleDelta().x();
+        e["dy"] = wheel->angleDelta().y();
+        e["buttons"] = static_cast<int>(wheel->buttons());
+        e["modifiers"] = static_cast<int>(wheel->modifiers());
+        break;
+    }
+    case QEvent::ChildPolished:
+    {
+        // Editors created later, the clipping planes editor
+        QWidget* child = qobject_cast<QWidget*>(static_cast<QChildEvent*>(event)->child());
+        if (child)
+            watchControls(child);
+        return false;
+    }
+    default:
+        return false;
+    }
+    record(e);
+    return false;
+}
+
+void SessionRecorder::record(QJsonObject event)
+{
+    event["t"] = _clock.nsecsElapsed() / 1.0e6;
+    _events.append(event);
+}
+
+void SessionRecorder::recordFrame()
+{
+    // Frames without input in between draw nothing new
+    if (!_events.isEmpty() && _events.last().toObject()["type"] == "frame")
+        return;
+    record({ { "type", "frame" } });
+}
+
+void SessionRecorder::recordClick()
+{
+    QString path = controlPath(sender());
+    if (isOneOf(sender()->objectName(), std::begin(COLOR_BUTTONS), std::end(COLOR_BUTTONS)))
+    {
+        // The dialog closed before this slot, the view holds the color picked
+        record({ { "type", "material" }, { "control", path }, { "material", material() } });
+        return;
+    }
+    record({ { "type", "click" }, { "control", path } });
+}
+
+void SessionRecorder::recordValue(int value)
+{
+    // Values set by the editor itself follow from recorded events, only the
+    // control the user works with is recorded
+    if (QAbstractSlider* slider = qobject_cast<QAbstractSlider*>(sender()))
+    {
+        // Sliders change under the wheel without taking the focus
+        bool user = _sliderAction == slider || slider->isSliderDown();
+        _sliderAction = nullptr;
+        if (!user)
+            return;
+    }
+    else if (!qobject_cast<QWidget*>(sender())->hasFocus())
+        return;
+    record({ { "type", "value" }, { "control", controlPath(sender()) }, { "value", value } });
+}
+
+void SessionRecorder::recordDoubleValue(double value)
+{
+    if (!qobject_cast<QWidget*>(sender())->hasFocus())
+        return;
+    record({ { "type", "value" }, { "control", controlPath(sender()) }, { "value", value } });
+}
+
+void SessionRecorder::sliderAction()
+{
+    _sliderAction = sender();
+}
+
+void SessionRecorder::recordAction()
+{
+    record({ { "type", "action" }, { "control", controlPath(sender()) } });
+}
+
+QJsonObject SessionRecorder::material() const
+{
+    QJsonObject m;
+    m["ambientLight"] = toJson(_view->_ambiLight);
+    m["diffuseLight"] = toJson(_view->_diffLight);
+    m["specularLight"] = toJson(_view->_specLight);
+    m["ambient"] = toJson(_view->_ambiMat);
+    m["diffuse"] = toJson(_view->_diffMat);
+    m["specular"] = toJson(_view->_specMat);
+    m["emissive"] = toJson(_view->_emmiMat);
+    return m;
+}
+
+bool SessionRecorder::save(const QString& fileName) const
+{
+    QJsonObject document;
+    document["session"] = _initialState;
+    document["events"] = _events;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(document).toJson(QJsonDocument::Compact)) < 0)
+    {
+        cout << "Could not write " << fileName.toStdString() << ": " << file.errorString().toStdString() << endl;
+        return false;
+    }
+    return true;
+}
+
+
+SessionReplay::SessionReplay() :
+    _threshold(10.0),
+    _realTime(false),
+    _window(nullptr),
+    _view(nullptr)
+{
+}
+
+SessionReplay::~SessionReplay()
+{
+    delete _window;
+}
+
+void SessionReplay::printUsage()
+{
+    cout << "Usage: MatlEditor --replay <session> [options]\n"
+         << "  --output <file>        Report as JSON, default replay-report.json\n"
+         << "  --baseline <file>      Report of an earlier replay to compare with\n"
+         << "  --threshold <percent>  Growth of the median or p95 times that fails, default 10\n"
+         << "  --realtime             Delivers the events at their recorded times instead of at once\n"
+         << "Sessions are recorded in the editor with F5. Without a display:\n"
+         << "  MatlEditor -platform offscreen --replay session.json ...\n";
+}
+
+bool SessionReplay::parseArguments(const QStringList& arguments)
+{
+    int start = arguments.indexOf("--replay") + 1;
+    if (start >= arguments.size() || arguments.at(start).startsWith("--"))
+    {
+        printUsage();
+        return false;
+    }
+    _session = arguments.at(start);
+    _output = "replay-report.json";
+
+    for (int i = start + 1; i < arguments.size(); i++)
+    {
+        const QString& option = arguments.at(i);
+        if (option == "--help")
+        {
+            printUsage();
+            return false;
+        }
+        if (option == "--realtime")
+        {
+            _realTime = true;
+            continue;
+        }
+        if (i + 1 >= arguments.size())
+        {
+            cout << "Missing value for " << option.toStdString() << endl;
+            return false;
+        }
+        const QString& value = arguments.at(++i);
+
+        if (option == "--output")
+            _output = value;
+        else if (option == "--baseline")
+            _baseline = value;
+        else if (option == "--threshold")
+            _threshold = value.toDouble();
+        else
+        {
+            cout << "Unknown option " << option.toStdString() << endl;
+            printUsage();
+            return false;
+        }
+    }
+    return true;
+}
+
+int SessionReplay::run()
+{
+    QFile sessionFile(_session);
+    QJsonDocument session = sessionFile.open(QIODevice::ReadOnly) ? QJsonDocument::fromJson(sessionFile.readAll()) : QJsonDocument();
+    if (!session.isObject())
+    {
+        cout << "Could not read the session " << _session.toStdString() << endl;
+        return 1;
+    }
+    QJsonObject state = session.object()["session"].toObject();
+    QJsonArray events = session.object()["events"].toArray();
+
+    QJsonObject baseline;
+    if (!_baseline.isEmpty())
+    {
+        QFile file(_baseline);
+        QJsonDocument document = file.open(QIODevice::ReadOnly) ? QJsonDocument::fromJson(file.readAll()) : QJsonDocument();
+        if (!document.isObject())
+        {
+            cout << "Could not read the baseline " << _baseline.toStdString() << endl;
+            return 1;
+        }
+        baseline = document.object();
+    }
+
+    _window = new MainWindow();
+    _view = _window->findChild<GLView*>();
+    QStringList size = state["viewSize"].toString().split('x');
+    if (size.size() == 2)
+        _view->setFixedSize(size.at(0).toInt(), size.at(1).toInt());
+    _window->show();
+
+    // The meshes and the surface editors are created by initializeGL on the first frame
+    QElapsedTimer wait;
+    wait.start();
+    while (!_view->isValid() && wait.elapsed() < 10000)
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+    if (!_view->isValid())
+    {
+        cout << "The view did not initialize" << endl;
+        return 1;
+    }
+    QCoreApplication::processEvents();
+    restoreState(state);
+
+    _view->makeCurrent();
+    QOpenGLFunctions* f = _view->context()->functions();
+    QString renderer = QString::fromLatin1(reinterpret_cast<const char*>(f->glGetString(GL_RENDERER)));
+
+    std::vector<double> latencies;
+    std::vector<double> frameTimes;
+    QHash<QString, std::vector<double>> processing;
+    int missing = 0;
+
+    QElapsedTimer clock;
+    clock.start();
+    qint64 firstInput = -1;           // Delivery of the first event since the last frame
+    for (int i = 0; i <= events.size(); i++)
+    {
+        // The input after the last frame is drawn once more at the end
+        QJsonObject event = i < events.size() ? events[i].toObject() : QJsonObject({ { "type", "frame" } });
+        QString type = event["type"].toString();
+
+        if (_realTime)
+        {
+            while (clock.nsecsElapsed() / 1.0e6 < event["t"].toDouble())
+                QThread::usleep(100);
+        }
+
+        if (type == "frame")
+        {
+            if (firstInput < 0)
+                continue;
+
+            qint64 begin = clock.nsecsElapsed();
+            _view->repaint();
+            _view->makeCurrent();
+            f->glFinish();
+            qint64 end = clock.nsecsElapsed();
+            latencies.push_back((end - firstInput) / 1.0e6);
+            frameTimes.push_back((end - begin) / 1.0e6);
+            firstInput = -1;
+
+            // Timers and the updates the controls queued, outside of the measurement
+            QCoreApplication::processEvents();
+            continue;
+        }
+
+        qint64 begin = clock.nsecsElapsed();
+        if (!deliver(event))
+        {
+            missing++;
+            continue;
+        }
+        qint64 end = clock.nsecsElapsed();
+        if (firstInput < 0)
+            firstInput = begin;
+
+        QString source = event.contains("control") ? event["control"].toString() : "GLView/" + type;
+        processing[source].push_back((end - begin) / 1.0e6);
+    }
+
+    QJsonObject sources;
+    for (auto it = processing.constBegin(); it != processing.constEnd(); ++it)
+        sources[it.key()] = statistics(it.value());
+
+    QJsonObject report;
+    report["replay"] = QFileInfo(_session).fileName();
+    report["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report["renderer"] = renderer;
+    report["size"] = state["viewSize"];
+    report["events"] = events.size();
+    report["latency"] = statistics(latencies);
+    report["frameTime"] = statistics(frameTimes);
+    report["processing"] = sources;
+
+    QJsonObject latency = report["latency"].toObject();
+    cout << _session.toStdString() << ": " << latency["count"].toInt() << " frames, input to present p50 "
+         << latency["p50Ms"].toDouble() << " ms, p95 " << latency["p95Ms"].toDouble()
+         << " ms, max " << latency["maxMs"].toDouble() << " ms" << endl;
+    if (missing)
+        cout << missing << " events addressed controls that do not exist" << endl;
+
+    QFile file(_output);
+    if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(report).toJson()) < 0)
+    {
+        cout << "Could not write " << _output.toStdString() << ": " << file.errorString().toStdString() << endl;
+        return 1;
+    }
+    cout << "Wrote " << _output.toStdString() << endl;
+
+    if (!baseline.isEmpty() && !compare(report, baseline))
+        return 2;
+    return 0;
+}
+
+void SessionReplay::restoreState(const QJsonObject& state)
+{
+    // Setting the controls runs their slots, which apply the values
+    QJsonObject controls = state["controls"].toObject();
+    for (QObject* control : _window->findChildren<QObject*>())
+    {
+        QString path = SessionRecorder::controlPath(control);
+        if (control->objectName().isEmpty() || !controls.contains(path))
+            continue;
+
+        QJsonValue value = controls[path];
+        if (QAbstractSlider* slider = qobject_cast<QAbstractSlider*>(control))
+            slider->setValue(value.toInt());
+        else if (QDoubleSpinBox* spinBox = qobject_cast<QDoubleSpinBox*>(control))
+            spinBox->setValue(value.toDouble());
+        else if (QComboBox* comboBox = qobject_cast<QComboBox*>(control))
+            comboBox->setCurrentIndex(value.toInt());
+        else if (QAbstractButton* button = qobject_cast<QAbstractButton*>(control))
+            button->setChecked(value.toBool());
+    }
+    deliver({ { "type", "material" }, { "material", state["material"] } });
+
+    _view->setModelNum(state["model"].toInt());
+    _view->finishAnimation();
+
+    QJsonObject camera = state["camera"].toObject();
+    _view->_camera->setView(toVector3D(camera["position"]), toVector3D(camera["viewDir"]),
+                            toVector3D(camera["up"]), toVector3D(camera["right"]));
+    _view->_viewRange = camera["viewRange"].toDouble();
+    _view->_currentViewRange = _view->_viewRange;
+    _view->updateProjection(_view->width(), _view->height());
+    _view->markDirty(GLView::DirtyAll);
+
+    _view->repaint();
+    QCoreApplication::processEvents();
+}
+
+bool SessionReplay::deliver(const QJsonObject& event)
+{
+    QString type = event["type"].toString();
+    if (type == "press" || type == "release" || type == "move")
+    {
+        QMouseEvent mouse(type == "press" ? QEvent::MouseButtonPress : type == "release" ? QEvent::MouseButtonRelease : QEvent::MouseMove,
+                          QPointF(event["x"].toDouble(), event["y"].toDouble()),
+                          static_cast<Qt::MouseButton>(event["button"].toInt()),
+                          static_cast<Qt::MouseButtons>(event["buttons"].toInt()),
+                          static_cast<Qt::KeyboardModifiers>(event["modifiers"].toInt()));
+        QApplication::sendEvent(_view, &mouse);
+    }
+    else if (type == "wheel")
+    {
+        QPointF position(event["x"].toDouble(), event["y"].toDouble());
+        QWheelEvent wheel(position, _view->mapToGlobal(position.toPoint()), QPoint(),
+                          QPoint(event["dx"].toInt(), event["dy"].toInt()),
+                          static_cast<Qt::MouseButtons>(event["buttons"].toInt()),
+                          static_cast<Qt::KeyboardModifiers>(event["modifiers"].toInt()),
+                          Qt::NoScrollPhase, false);
+        QApplication::sendEvent(_view, &wheel);
+    }
+    else if (type == "material")
+    {
+        QJsonObject m = event["material"].toObject();
+        _view->_ambiLight = toVector4D(m["ambientLight"]);
+        _view->_diffLight = toVector4D(m["diffuseLight"]);
+        _view->_specLight = toVector4D(m["specularLight"]);
+        _view->_ambiMat = toVector4D(m["ambient"]);
+        _view->_diffMat = toVector4D(m["diffuse"]);
+        _view->_specMat = toVector4D(m["specular"]);
+        _view->_emmiMat = toVector4D(m["emissive"]);
+        _view->updateView();
+    }
+    else
+    {
+        QString path = event["control"].toString();
+        QObject* control = nullptr;
+        for (QObject* child : _window->findChildren<QObject*>(path.section('/', 1)))
+        {
+            if (SessionRecorder::controlPath(child) == path)
+                control = child;
+        }
+        if (!control)
+            return false;
+
+        if (type == "click")
+            qobject_cast<QAbstractButton*>(control)->click();
+        else if (type == "action")
+            qobject_cast<QAction*>(control)->trigger();
+        else if (QAbstractSlider* slider = qobject_cast<QAbstractSlider*>(control))
+            slider->setValue(event["value"].toInt());
+        else if (QDoubleSpinBox* spinBox = qobject_cast<QDoubleSpinBox*>(control))
+            spinBox->setValue(event["value"].toDouble());
+        else if (QComboBox* comboBox = qobject_cast<QComboBox*>(control))
+            comboBox->setCurrentIndex(event["value"].toInt());
+        else
+            return false;
+    }
+
+    // A replay is timed by the recorded frames, not by the clock of a transition
+    _view->finishAnimation();
+    return true;
+}
+
+bool SessionReplay::compare(const QJsonObject& report, const QJsonObject& baseline) const
+{
+    if (report["renderer"] != baseline["renderer"] || report["size"] != baseline["size"])
+    {
+        cout << "The baseline was replayed with " << baseline["renderer"].toString().toStdString()
+             << " at " << baseline["size"].toString().toStdString() << ", the times are not comparable" << endl;
+        return true;
+    }
+
+    QStringList problems;
+    double limit = 1.0 + _threshold / 100.0;
+    auto check = [&](const QString& name, const QJsonObject& now, const QJsonObject& then)
+    {
+        for (const char* key : { "p50Ms", "p95Ms" })
+        {
+            double n = now[key].toDouble();
+            double t = then[key].toDouble();
+            if (t > 0.0 && n > t * limit)
+                problems << QString("%1 %2 %3 ms, was %4 ms (+%5%)").arg(name).arg(key).arg(n, 0, 'f', 2).arg(t, 0, 'f', 2)
+                            .arg((n / t - 1.0) * 100.0, 0, 'f', 0);
+        }
+    };
+
+    check("latency", report["latency"].toObject(), baseline["latency"].toObject());
+    check("frameTime", report["frameTime"].toObject(), baseline["frameTime"].toObject());
+    QJsonObject sources = report["processing"].toObject();
+    QJsonObject baseSources = baseline["processing"].toObject();
+    for (const QString& source : sources.keys())
+    {
+        if (baseSources.contains(source))
+            check(source, sources[source].toObject(), baseSources[source].toObject());
+    }
+
+    for (const QString& problem : problems)
+        cout << "REGRESSION " << problem.toStdString() << endl;
+    if (problems.isEmpty())
+        cout << "No regressions against " << _baseline.toStdString() << endl;
+    return problems.isEmpty();
+}
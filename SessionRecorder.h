@@ -0,0 +1,103 @@
+#pragma once
+
+#include <set>
+#include <vector>
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+
+class GLView;
+class MainWindow;
+
+
+// Records what the user does in the editor as a timestamped event stream:
+// the mouse and wheel on the view, every button, slider, spin box and combo
+// box of the editor and the surface editors, the view actions and the colors
+// picked in dialogs. The frames the view presented are recorded between the
+// events, so a replay draws the same frames from the same coalesced input.
+//
+// The state at the start is saved with the events, a replay starts from it.
+class SessionRecorder : public QObject
+{
+    Q_OBJECT
+public:
+    // Records the controls below the editor and the input of its view
+    SessionRecorder(QWidget* editor, GLView* view);
+
+    bool save(const QString& fileName) const;
+    int eventCount() const { return _events.size(); }
+
+    // Path of a control in a session, the class of its window and its object name
+    static QString controlPath(QObject* control);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private slots:
+    void recordFrame();
+    void recordClick();
+    void recordValue(int value);
+    void recordDoubleValue(double value);
+    void sliderAction();
+    void recordAction();
+
+private:
+    // Connects the controls below the widget that are not yet recorded
+    void watchControls(QWidget* widget);
+    void record(QJsonObject event);
+    // Light and material, set in color dialogs that cannot be replayed
+    QJsonObject material() const;
+
+    GLView* _view;
+    QElapsedTimer _clock;
+    QJsonObject _initialState;
+    QJsonArray _events;
+    std::set<QObject*> _watched;
+    QObject* _sliderAction;       // Slider the user is changing, its next value is recorded
+};
+
+
+// Replays a recorded session against the editor without a display, started
+// with --replay:
+//
+//   MatlEditor -platform offscreen --replay drag.json --output report.json
+//
+// Events are delivered in order and the view is drawn where the session
+// presented a frame, so the work per frame matches the session and not the
+// timing of the machine. View transitions jump to their end. Measured are the
+// time from the first event of a frame until it was drawn and the processing
+// time of every event, by control.
+class SessionReplay
+{
+public:
+    SessionReplay();
+    ~SessionReplay();
+
+    // Reads the options following --replay, false after printing the problem
+    bool parseArguments(const QStringList& arguments);
+    // Replays the session, returns 0, 1 on errors or 2 on regressions
+    int run();
+
+    static void printUsage();
+
+private:
+    void restoreState(const QJsonObject& state);
+    // Delivers one event, false if its target does not exist
+    bool deliver(const QJsonObject& event);
+    // Regressions against the baseline report, printed, false if there are any
+    bool compare(const QJsonObject& report, const QJsonObject& baseline) const;
+
+    // Options
+    QString _session;
+    QString _output;
+    QString _baseline;
+    double _threshold;            // Percent the times may grow
+    bool _realTime;               // Waits for the recorded time of every event
+
+    MainWindow* _window;
+    GLView* _view;
+};
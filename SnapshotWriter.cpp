@@ -0,0 +1,236 @@
+#include "SnapshotWriter.h"
+
+#include <QImageWriter>
+#include <QtEndian>
+
+#include <iostream>
+
+// Largest stored deflate block and the size of the IDAT chunks written
+static const int STORED_BLOCK_SIZE = 65535;
+static const int IDAT_CHUNK_SIZE = 1 << 20;
+// Bands waiting for the encoder
+static const size_t MAX_QUEUED_BANDS = 2;
+
+static quint32 crc32(quint32 crc, const char* data, int size)
+{
+    static quint32 table[256];
+    static bool initialized = false;
+    if (!initialized)
+    {
+        for (quint32 n = 0; n < 256; n++)
+        {
+            quint32 c = n;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        initialized = true;
+    }
+
+    crc = ~crc;
+    for (int i = 0; i < size; i++)
+        crc = table[(crc ^ static_cast<uchar>(data[i])) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static quint32 adler32(quint32 adler, const uchar* data, int size)
+{
+    quint32 a = adler & 0xFFFF;
+    quint32 b = adler >> 16;
+    while (size > 0)
+    {
+        // Largest run that cannot overflow before the modulo
+        int run = qMin(size, 5552);
+        size -= run;
+        while (run--)
+        {
+            a += *data++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+static void appendBigEndian(QByteArray& bytes, quint32 value)
+{
+    char buffer[4];
+    qToBigEndian(value, buffer);
+    bytes.append(buffer, 4);
+}
+
+SnapshotWriter::SnapshotWriter(const QImage& image, const QString& fileName) :
+    _image(image), _fileName(fileName)
+{
+}
+
+void SnapshotWriter::run()
+{
+    // Rows arrive bottom up from OpenGL
+    QImageWriter writer(_fileName);
+    if (!writer.write(_image.mirrored()))
+        std::cout << "Could not write " << _fileName.toStdString() << ": " << writer.errorString().toStdString() << std::endl;
+}
+
+PosterWriter::PosterWriter(QObject* parent) : QThread(parent),
+    _failed(false),
+    _adler(1),
+    _rowsWritten(0),
+    _finished(false)
+{
+}
+
+PosterWriter::~PosterWriter()
+{
+    if (isRunning())
+        finish();
+}
+
+bool PosterWriter::open(const QString& fileName, const QSize& size)
+{
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::WriteOnly))
+    {
+        std::cout << "Could not write " << fileName.toStdString() << ": " << _file.errorString().toStdString() << std::endl;
+        return false;
+    }
+    _size = size;
+    _failed = false;
+    _adler = 1;
+    _rowsWritten = 0;
+    _finished = false;
+    _bands.clear();
+
+    _file.write("\x89PNG\r\n\x1a\n", 8);
+
+    // 8 bit RGB, not interlaced
+    QByteArray header;
+    appendBigEndian(header, static_cast<quint32>(size.width()));
+    appendBigEndian(header, static_cast<quint32>(size.height()));
+    header.append(char(8));
+    header.append(char(2));
+    header.append(char(0));
+    header.append(char(0));
+    header.append(char(0));
+    writeChunk("IHDR", header);
+
+    // Zlib header, deflate with a 32K window and no preset dictionary
+    _idat.clear();
+    _idat.append(char(0x78));
+    _idat.append(char(0x01));
+    _block.clear();
+
+    start();
+    return true;
+}
+
+void PosterWriter::addBand(const QImage& band)
+{
+    QMutexLocker locker(&_mutex);
+    while (_bands.size() >= MAX_QUEUED_BANDS)
+        _bandTaken.wait(&_mutex);
+    _bands.push_back(band);
+    _bandAdded.wakeOne();
+}
+
+bool PosterWriter::finish()
+{
+    {
+        QMutexLocker locker(&_mutex);
+        _finished = true;
+        _bandAdded.wakeOne();
+    }
+    wait();
+
+    if (_rowsWritten != _size.height())
+    {
+        std::cout << "Incomplete image " << _file.fileName().toStdString() << ": "
+                  << _rowsWritten << " of " << _size.height() << " rows" << std::endl;
+        _failed = true;
+    }
+    if (!_failed)
+        writeChunk("IEND", QByteArray());
+    _file.close();
+    return !_failed && _file.error() == QFileDevice::NoError;
+}
+
+void PosterWriter::run()
+{
+    QByteArray scanline(1 + _size.width() * 3, 0);
+    forever
+    {
+        QImage band;
+        {
+            QMutexLocker locker(&_mutex);
+            while (_bands.empty() && !_finished)
+                _bandAdded.wait(&_mutex);
+            if (_bands.empty())
+                return;
+            band = _bands.front();
+            _bands.pop_front();
+            _bandTaken.wakeOne();
+        }
+
+        // Top row of the band first, each scanline starts with filter type none
+        for (int y = band.height() - 1; y >= 0 && _rowsWritten < _size.height(); y--)
+        {
+            const uchar* source = band.constScanLine(y);
+            uchar* target = reinterpret_cast<uchar*>(scanline.data()) + 1;
+            for (int x = 0; x < _size.width(); x++)
+            {
+                target[x * 3 + 0] = source[x * 4 + 0];
+                target[x * 3 + 1] = source[x * 4 + 1];
+                target[x * 3 + 2] = source[x * 4 + 2];
+            }
+            _rowsWritten++;
+            deflate(reinterpret_cast<const uchar*>(scanline.constData()), scanline.size(), _rowsWritten == _size.height());
+        }
+    }
+}
+
+void PosterWriter::writeChunk(const char* type, const QByteArray& data)
+{
+    QByteArray chunk;
+    appendBigEndian(chunk, static_cast<quint32>(data.size()));
+    chunk.append(type, 4);
+    chunk.append(data);
+    // The CRC covers the type and the data
+    appendBigEndian(chunk, crc32(0, chunk.constData() + 4, chunk.size() - 4));
+    if (_file.write(chunk) != chunk.size())
+        _failed = true;
+}
+
+void PosterWriter::deflate(const uchar* data, int size, bool last)
+{
+    _adler = adler32(_adler, data, size);
+    _block.append(reinterpret_cast<const char*>(data), size);
+
+    // Full blocks, and the rest as the final block after the last row
+    while (_block.size() >= STORED_BLOCK_SIZE || (last && !_block.isEmpty()))
+    {
+        int length = qMin(_block.size(), STORED_BLOCK_SIZE);
+        bool final = last && length == _block.size();
+        _idat.append(char(final ? 1 : 0));
+        _idat.append(char(length & 0xFF));
+        _idat.append(char(length >> 8));
+        _idat.append(char(~length & 0xFF));
+        _idat.append(char((~length >> 8) & 0xFF));
+        _idat.append(_block.constData(), length);
+        _block.remove(0, length);
+
+        if (_idat.size() >= IDAT_CHUNK_SIZE)
+            writeImageData(false);
+    }
+
+    if (last)
+        writeImageData(true);
+}
+
+void PosterWriter::writeImageData(bool last)
+{
+    if (last)
+        appendBigEndian(_idat, _adler);
+    writeChunk("IDAT", _idat);
+    _idat.clear();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <deque>
+
+#include <QFile>
+#include <QImage>
+#include <QString>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QRunnable>
+
+
+// Saves one image read back from the GPU on a worker thread. The format
+// follows the file suffix, any format with a Qt image plugin works, e.g. EXR
+// where the KDE image formats are installed.
+class SnapshotWriter : public QRunnable
+{
+public:
+    SnapshotWriter(const QImage& image, const QString& fileName);
+
+    void run() override;
+
+private:
+    QImage _image;
+    QString _fileName;
+};
+
+
+// Streams an image too large for memory to a PNG file, band by band from the
+// top. The encoder runs on its own thread; at most two bands wait for it besides
+// the one it encodes, adding a band blocks while it is behind. With the band the
+// caller fills, memory stays bounded at four bands however large the image is.
+//
+// The image data is stored in uncompressed deflate blocks: no compression
+// library is needed and every PNG reader accepts the file.
+class PosterWriter : public QThread
+{
+public:
+    PosterWriter(QObject* parent = nullptr);
+    ~PosterWriter();
+
+    // Writes the header and starts the encoder, false if the file cannot be created
+    bool open(const QString& fileName, const QSize& size);
+    // The next rows of the image, RGBA with the bottom row first as read from OpenGL
+    void addBand(const QImage& band);
+    // Writes the remaining bands and closes the file, false if any write failed
+    bool finish();
+
+protected:
+    void run() override;
+
+private:
+    void writeChunk(const char* type, const QByteArray& data);
+    // Appends to the deflate stream of the image data, IDAT chunks are written when full
+    void deflate(const uchar* data, int size, bool last);
+    void writeImageData(bool last);
+
+    QFile _file;
+    QSize _size;
+    bool _failed;
+
+    // Deflate stream state
+    QByteArray _block;        // Pending data of the current stored block
+    QByteArray _idat;         // Pending data of the current IDAT chunk
+    quint32 _adler;
+    int _rowsWritten;
+
+    QMutex _mutex;
+    QWaitCondition _bandAdded;
+    QWaitCondition _bandTaken;
+    std::deque<QImage> _bands;
+    bool _finished;
+};
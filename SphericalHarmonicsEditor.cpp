@@ -3,6 +3,7 @@
 
 #include "SphericalHarmonic.h"
 #include "GLView.h"
+#include "CpuTrace.h"
 
 SphericalHarmonicsEditor::SphericalHarmonicsEditor(SphericalHarmonic* sphere, QWidget *parent) :
     QDialog(parent),
@@ -28,6 +29,7 @@ SphericalHarmonicsEditor::~SphericalHarmonicsEditor()
 
 void SphericalHarmonicsEditor::on_doubleSpinBoxM0_valueChanged(double val)
 {
+	TRACE_SCOPE("SphericalHarmonicsEditor rebuild");
 	_sphere->_coeff1 = val;
 	_sphere->buildMesh(_sphere->getSlices(), _sphere->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -35,6 +37,7 @@ void SphericalHarmonicsEditor::on_doubleSpinBoxM0_valueChanged(double val)
 
 void SphericalHarmonicsEditor::on_doubleSpinBoxM1_valueChanged(double val)
 {
+	TRACE_SCOPE("SphericalHarmonicsEditor rebuild");
 	_sphere->_power1 = val;
 	_sphere->buildMesh(_sphere->getSlices(), _sphere->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -42,6 +45,7 @@ void SphericalHarmonicsEditor::on_doubleSpinBoxM1_valueChanged(double val)
 
 void SphericalHarmonicsEditor::on_doubleSpinBoxM2_valueChanged(double val)
 {
+	TRACE_SCOPE("SphericalHarmonicsEditor rebuild");
 	_sphere->_coeff2 = val;
 	_sphere->buildMesh(_sphere->getSlices(), _sphere->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -49,6 +53,7 @@ void SphericalHarmonicsEditor::on_doubleSpinBoxM2_valueChanged(double val)
 
 void SphericalHarmonicsEditor::on_doubleSpinBoxM3_valueChanged(double val)
 {
+	TRACE_SCOPE("SphericalHarmonicsEditor rebuild");
 	_sphere->_power2 = val;
 	_sphere->buildMesh(_sphere->getSlices(), _sphere->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -56,6 +61,7 @@ void SphericalHarmonicsEditor::on_doubleSpinBoxM3_valueChanged(double val)
 
 void SphericalHarmonicsEditor::on_doubleSpinBoxM4_valueChanged(double val)
 {
+	TRACE_SCOPE("SphericalHarmonicsEditor rebuild");
 	_sphere->_coeff3 = val;
 	_sphere->buildMesh(_sphere->getSlices(), _sphere->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -63,6 +69,7 @@ void SphericalHarmonicsEditor::on_doubleSpinBoxM4_valueChanged(double val)
 
 void SphericalHarmonicsEditor::on_doubleSpinBoxM5_valueChanged(double val)
 {
+	TRACE_SCOPE("SphericalHarmonicsEditor rebuild");
 	_sphere->_power3 = val;
 	_sphere->buildMesh(_sphere->getSlices(), _sphere->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -70,6 +77,7 @@ void SphericalHarmonicsEditor::on_doubleSpinBoxM5_valueChanged(double val)
 
 void SphericalHarmonicsEditor::on_doubleSpinBoxM6_valueChanged(double val)
 {
+	TRACE_SCOPE("SphericalHarmonicsEditor rebuild");
 	_sphere->_coeff4 = val;
 	_sphere->buildMesh(_sphere->getSlices(), _sphere->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -77,6 +85,7 @@ void SphericalHarmonicsEditor::on_doubleSpinBoxM6_valueChanged(double val)
 
 void SphericalHarmonicsEditor::on_doubleSpinBoxM7_valueChanged(double val)
 {
+	TRACE_SCOPE("SphericalHarmonicsEditor rebuild");
 	_sphere->_power4 = val;
 	_sphere->buildMesh(_sphere->getSlices(), _sphere->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -2,6 +2,7 @@
 #include "ui_SpringEditor.h"
 #include "Spring.h"
 #include "GLView.h"
+#include "CpuTrace.h"
 
 SpringEditor::SpringEditor(Spring* spring, QWidget *parent)
 	: QDialog(parent),
@@ -24,6 +25,7 @@ SpringEditor::~SpringEditor()
 
 void SpringEditor::on_doubleSpinBoxSecRad_valueChanged(double val)
 {
+	TRACE_SCOPE("SpringEditor rebuild");
 	_spring->_sectionRadius = val;
 	_spring->buildMesh(_spring->getSlices(), _spring->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -31,6 +33,7 @@ void SpringEditor::on_doubleSpinBoxSecRad_valueChanged(double val)
 
 void SpringEditor::on_doubleSpinBoxCoilRad_valueChanged(double val)
 {
+	TRACE_SCOPE("SpringEditor rebuild");
 	_spring->_coilRadius = val;
 	_spring->buildMesh(_spring->getSlices(), _spring->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -38,6 +41,7 @@ void SpringEditor::on_doubleSpinBoxCoilRad_valueChanged(double val)
 
 void SpringEditor::on_doubleSpinBoxPitch_valueChanged(double val)
 {
+	TRACE_SCOPE("SpringEditor rebuild");
 	_spring->_pitch = val;
 	_spring->buildMesh(_spring->getSlices(), _spring->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -45,6 +49,7 @@ void SpringEditor::on_doubleSpinBoxPitch_valueChanged(double val)
 
 void SpringEditor::on_doubleSpinBoxTurns_valueChanged(double val)
 {
+	TRACE_SCOPE("SpringEditor rebuild");
 	_spring->_turns = val;
 	_spring->buildMesh(_spring->getSlices(), _spring->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -0,0 +1,188 @@
+#include "StallWatchdog.h"
+#include "CpuTrace.h"
+
+#include <QFontDatabase>
+#include <QHBoxLayout>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QTimer>
+#include <QVBoxLayout>
+
+#include <cmath>
+#include <iostream>
+
+const double StallWatchdog::BUCKET_LIMITS[StallWatchdog::BUCKET_COUNT - 1] =
+    { 1, 2, 4, 8, 16, 33, 50, 100, 250, 500, 1000 };
+
+StallWatchdog::StallWatchdog(QObject* parent, int intervalMs, int thresholdMs) :
+    QThread(parent),
+    _intervalMs(intervalMs),
+    _thresholdMs(thresholdMs),
+    _guiThread(CpuTrace::threadId()),
+    _pingSent(-1),
+    _histogram(BUCKET_COUNT, 0)
+{
+    _clock.start();
+}
+
+StallWatchdog::~StallWatchdog()
+{
+    stop();
+}
+
+void StallWatchdog::stop()
+{
+    requestInterruption();
+    wait();
+}
+
+void StallWatchdog::run()
+{
+    TRACE_THREAD_NAME("Watchdog");
+
+    while (!isInterruptionRequested())
+    {
+        QThread::msleep(_intervalMs);
+
+        qint64 sent = _pingSent.load();
+        if (sent < 0)
+        {
+            // One ping at a time, a late one is not followed by a queue of others
+            sent = _clock.nsecsElapsed();
+            _pingSent.store(sent);
+            QMetaObject::invokeMethod(this, [this, sent]() { handlePing(sent); }, Qt::QueuedConnection);
+        }
+        else if ((_clock.nsecsElapsed() - sent) / 1000000 >= _thresholdMs)
+        {
+            QString scope = CpuTrace::openScopes(_guiThread);
+            QMutexLocker locker(&_mutex);
+            _stallScopes[scope]++;
+        }
+    }
+}
+
+void StallWatchdog::handlePing(qint64 sent)
+{
+    qint64 now = _clock.nsecsElapsed();
+    double lateMs = (now - sent) / 1.0e6;
+
+    QMutexLocker locker(&_mutex);
+    int bucket = 0;
+    while (bucket < BUCKET_COUNT - 1 && lateMs >= BUCKET_LIMITS[bucket])
+        bucket++;
+    _histogram[bucket]++;
+
+    if (lateMs >= _thresholdMs)
+    {
+        // The scope the samples saw most, the one that held the GUI thread longest
+        QString scope;
+        int samples = 0;
+        for (auto it = _stallScopes.constBegin(); it != _stallScopes.constEnd(); ++it)
+        {
+            if (it.value() > samples)
+            {
+                scope = it.key();
+                samples = it.value();
+            }
+        }
+        if (scope.isEmpty())
+            scope = "no trace scope";
+
+        if (_stalls.size() == MAX_STALLS)
+            _stalls.erase(_stalls.begin());
+        _stalls.push_back({ sent / 1000000, lateMs, scope });
+        std::cout << "GUI thread stalled " << static_cast<int>(lateMs) << " ms in " << scope.toStdString() << std::endl;
+    }
+    _stallScopes.clear();
+    locker.unlock();
+
+    _pingSent.store(-1);
+}
+
+std::vector<int> StallWatchdog::histogram() const
+{
+    QMutexLocker locker(&_mutex);
+    return _histogram;
+}
+
+std::vector<StallWatchdog::Stall> StallWatchdog::stalls() const
+{
+    QMutexLocker locker(&_mutex);
+    return _stalls;
+}
+
+void StallWatchdog::reset()
+{
+    QMutexLocker locker(&_mutex);
+    _histogram.assign(BUCKET_COUNT, 0);
+    _stalls.clear();
+}
+
+
+StallHistogramDialog::StallHistogramDialog(StallWatchdog* watchdog, QWidget* parent) :
+    QDialog(parent),
+    _watchdog(watchdog)
+{
+    setWindowTitle("GUI Stalls");
+    setAttribute(Qt::WA_DeleteOnClose);
+    resize(560, 480);
+
+    _text = new QPlainTextEdit(this);
+    _text->setReadOnly(true);
+    _text->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    QPushButton* resetButton = new QPushButton("Reset", this);
+    QPushButton* closeButton = new QPushButton("Close", this);
+    connect(resetButton, SIGNAL(clicked()), this, SLOT(reset()));
+    connect(closeButton, SIGNAL(clicked()), this, SLOT(close()));
+
+    QHBoxLayout* buttons = new QHBoxLayout();
+    buttons->addStretch(1);
+    buttons->addWidget(resetButton);
+    buttons->addWidget(closeButton);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->addWidget(_text, 1);
+    layout->addLayout(buttons);
+
+    _timer = new QTimer(this);
+    connect(_timer, SIGNAL(timeout()), this, SLOT(refresh()));
+    _timer->start(500);
+    refresh();
+}
+
+void StallHistogramDialog::refresh()
+{
+    std::vector<int> histogram = _watchdog->histogram();
+    int total = 0;
+    int most = 1;
+    for (int count : histogram)
+    {
+        total += count;
+        most = qMax(most, count);
+    }
+
+    QString text = QString("Event loop lateness of %1 pings\n\n").arg(total);
+    for (int i = 0; i < StallWatchdog::BUCKET_COUNT; i++)
+    {
+        QString range = i < StallWatchdog::BUCKET_COUNT - 1
+            ? QString("< %1 ms").arg(StallWatchdog::BUCKET_LIMITS[i])
+            : QString(">= %1 ms").arg(StallWatchdog::BUCKET_LIMITS[i - 1]);
+        // Bars on a log scale, a single stall stays visible next to thousands of pings
+        int bar = histogram[i] ? 1 + static_cast<int>(39.0 * std::log(histogram[i]) / std::log(static_cast<double>(qMax(2, most)))) : 0;
+        text += QString("%1 %2 %3\n").arg(range, 10).arg(histogram[i], 8).arg(QString(bar, '#'));
+    }
+
+    std::vector<StallWatchdog::Stall> stalls = _watchdog->stalls();
+    text += QString("\nStalls of %1 ms or more, newest first\n\n").arg(_watchdog->thresholdMs());
+    for (auto it = stalls.rbegin(); it != stalls.rend(); ++it)
+        text += QString("%1 s  %2 ms  %3\n").arg(it->when / 1000.0, 9, 'f', 1).arg(it->durationMs, 7, 'f', 0).arg(it->scope);
+
+    _text->setPlainText(text);
+}
+
+void StallHistogramDialog::reset()
+{
+    _watchdog->reset();
+    refresh();
+}
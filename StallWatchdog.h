@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include <QDialog>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+
+class QPlainTextEdit;
+class QTimer;
+
+
+// Pings the GUI event loop from its own thread at a fixed rate and records how
+// late every ping is handled. While a ping is overdue the trace scopes open on
+// the GUI thread are sampled, so a stall is reported with the work that caused
+// it, e.g. "SphericalHarmonicsEditor rebuild > ParametricSurface::buildMesh".
+// Without trace scopes, CONFIG+=notrace, stalls are still measured but unnamed.
+class StallWatchdog : public QThread
+{
+    Q_OBJECT
+public:
+    // A ping handled later than the threshold
+    struct Stall
+    {
+        qint64 when;              // Milliseconds since the watchdog started
+        double durationMs;
+        QString scope;            // Open most of the time the GUI was stalled
+    };
+
+    // Upper bounds of the histogram buckets in milliseconds, the last one is open
+    static const int BUCKET_COUNT = 12;
+    static const double BUCKET_LIMITS[BUCKET_COUNT - 1];
+
+    // Must be constructed on the GUI thread
+    StallWatchdog(QObject* parent = nullptr, int intervalMs = 10, int thresholdMs = 50);
+    ~StallWatchdog();
+
+    void stop();
+
+    std::vector<int> histogram() const;
+    // The newest stalls, oldest first
+    std::vector<Stall> stalls() const;
+    int thresholdMs() const { return _thresholdMs; }
+    void reset();
+
+protected:
+    void run() override;
+
+private:
+    // Runs on the GUI thread when the ping sent at the time got through
+    void handlePing(qint64 sent);
+
+    static const int MAX_STALLS = 100;
+
+    int _intervalMs;
+    int _thresholdMs;
+    int _guiThread;               // CpuTrace thread id of the GUI thread
+
+    std::atomic<qint64> _pingSent; // Nanoseconds, -1 while no ping is outstanding
+    QElapsedTimer _clock;
+
+    mutable QMutex _mutex;
+    std::vector<int> _histogram;
+    std::vector<Stall> _stalls;
+    QHash<QString, int> _stallScopes; // Samples of the outstanding ping per open scope
+};
+
+
+// Shows the lateness histogram and the stalls of a watchdog, refreshed while open
+class StallHistogramDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    StallHistogramDialog(StallWatchdog* watchdog, QWidget* parent = nullptr);
+
+private slots:
+    void refresh();
+    void reset();
+
+private:
+    StallWatchdog* _watchdog;
+    QPlainTextEdit* _text;
+    QTimer* _timer;
+};
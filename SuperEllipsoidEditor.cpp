@@ -2,6 +2,7 @@
 #include "ui_SuperEllipsoidEditor.h"
 #include "SuperEllipsoid.h"
 #include "GLView.h"
+#include "CpuTrace.h"
 
 SuperEllipsoidEditor::SuperEllipsoidEditor(SuperEllipsoid* sellipsoid, QWidget *parent)
     :QWidget(parent),
@@ -22,6 +23,7 @@ SuperEllipsoidEditor::~SuperEllipsoidEditor()
 
 void SuperEllipsoidEditor::on_doubleSpinBoxScaleX_valueChanged(double val)
 {
+	TRACE_SCOPE("SuperEllipsoidEditor rebuild");
 	_ellipsoid->_scaleX = val;
 	_ellipsoid->buildMesh(_ellipsoid->getSlices(), _ellipsoid->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -29,6 +31,7 @@ void SuperEllipsoidEditor::on_doubleSpinBoxScaleX_valueChanged(double val)
 
 void SuperEllipsoidEditor::on_doubleSpinBoxScaleY_valueChanged(double val)
 {
+	TRACE_SCOPE("SuperEllipsoidEditor rebuild");
 	_ellipsoid->_scaleY = val;
 	_ellipsoid->buildMesh(_ellipsoid->getSlices(), _ellipsoid->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -36,6 +39,7 @@ void SuperEllipsoidEditor::on_doubleSpinBoxScaleY_valueChanged(double val)
 
 void SuperEllipsoidEditor::on_doubleSpinBoxScaleZ_valueChanged(double val)
 {
+	TRACE_SCOPE("SuperEllipsoidEditor rebuild");
 	_ellipsoid->_scaleZ = val;
 	_ellipsoid->buildMesh(_ellipsoid->getSlices(), _ellipsoid->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -43,6 +47,7 @@ void SuperEllipsoidEditor::on_doubleSpinBoxScaleZ_valueChanged(double val)
 
 void SuperEllipsoidEditor::on_doubleSpinBoxN1_valueChanged(double val)
 {
+	TRACE_SCOPE("SuperEllipsoidEditor rebuild");
 	_ellipsoid->_n1 = val;
 	_ellipsoid->buildMesh(_ellipsoid->getSlices(), _ellipsoid->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -50,6 +55,7 @@ void SuperEllipsoidEditor::on_doubleSpinBoxN1_valueChanged(double val)
 
 void SuperEllipsoidEditor::on_doubleSpinBoxN2_valueChanged(double val)
 {
+	TRACE_SCOPE("SuperEllipsoidEditor rebuild");
 	_ellipsoid->_n2 = val;
 	_ellipsoid->buildMesh(_ellipsoid->getSlices(), _ellipsoid->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -57,6 +63,7 @@ void SuperEllipsoidEditor::on_doubleSpinBoxN2_valueChanged(double val)
 
 void SuperEllipsoidEditor::on_doubleSpinBoxRad_valueChanged(double val)
 {
+	TRACE_SCOPE("SuperEllipsoidEditor rebuild");
 	_ellipsoid->_radius = val;
 	_ellipsoid->buildMesh(_ellipsoid->getSlices(), _ellipsoid->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -1,6 +1,7 @@
 #include "SuperToroidEditor.h"
 #include "SuperToroid.h"
 #include "GLView.h"
+#include "CpuTrace.h"
 
 SuperToroidEditor::SuperToroidEditor(SuperToroid* storoid, QWidget *parent)
 	: QDialog(parent),
@@ -20,6 +21,7 @@ SuperToroidEditor::~SuperToroidEditor()
 
 void SuperToroidEditor::on_doubleSpinBoxN1_valueChanged(double val)
 {
+	TRACE_SCOPE("SuperToroidEditor rebuild");
 	_toroid->_n1 = val;
 	_toroid->buildMesh(_toroid->getSlices(), _toroid->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -27,6 +29,7 @@ void SuperToroidEditor::on_doubleSpinBoxN1_valueChanged(double val)
 
 void SuperToroidEditor::on_doubleSpinBoxN2_valueChanged(double val)
 {
+	TRACE_SCOPE("SuperToroidEditor rebuild");
 	_toroid->_n2 = val;
 	_toroid->buildMesh(_toroid->getSlices(), _toroid->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -34,6 +37,7 @@ void SuperToroidEditor::on_doubleSpinBoxN2_valueChanged(double val)
 
 void SuperToroidEditor::on_doubleSpinBoxOutRad_valueChanged(double val)
 {
+	TRACE_SCOPE("SuperToroidEditor rebuild");
 	_toroid->_outerRadius = val;
 	_toroid->buildMesh(_toroid->getSlices(), _toroid->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -41,6 +45,7 @@ void SuperToroidEditor::on_doubleSpinBoxOutRad_valueChanged(double val)
 
 void SuperToroidEditor::on_doubleSpinBoxInnRad_valueChanged(double val)
 {
+	TRACE_SCOPE("SuperToroidEditor rebuild");
 	_toroid->_innerRadius = val;
 	_toroid->buildMesh(_toroid->getSlices(), _toroid->getStacks());
     dynamic_cast<GLView*>(parent())->updateViewBoundingSphere();
@@ -1,16 +1,34 @@
-
 #include <iostream>
+#include <algorithm>
 
 #include <glm/gtc/matrix_transform.hpp>
-#include <ft2build.h>
-#include FT_FREETYPE_H
 
 #include "TextRenderer.h"
+#include "DrawStatistics.h"
+#include "GlyphCache.h"
+#include "GLDebugLog.h"
+
+// Floats per text vertex: position(2) uv(2) page(1)
+static const int TEXT_VERTEX_FLOATS = 5;
+// Floats per label glyph instance: anchor(3) offset(2) size(2) uv rect(4) color(3) page(1)
+static const int LABEL_INSTANCE_FLOATS = 15;
 
 
-TextRenderer::TextRenderer(QOpenGLShaderProgram* prog, GLuint width, GLuint height) : _prog(prog)
+TextRenderer::TextRenderer(QOpenGLShaderProgram* prog, GLuint width, GLuint height, QOpenGLShaderProgram* labelProg, GlyphCache* cache) :
+	_cache(cache),
+	_ownsCache(cache == nullptr),
+	_font(-1),
+	_fontSize(0),
+	_sdf(false),
+	_vboCapacity(0),
+	_prog(prog),
+	_labelsDirty(false),
+	_labelsGeneration(0),
+	_labelProg(labelProg)
 {
 	initializeOpenGLFunctions();
+	if (_ownsCache)
+		_cache = new GlyphCache();
 	VBO = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
     // Load and configure shader
 	QMatrix4x4 projection;
@@ -20,141 +38,253 @@ TextRenderer::TextRenderer(QOpenGLShaderProgram* prog, GLuint width, GLuint heig
 	else
 		projection.ortho(QRect(0.0f, 0.0f, static_cast<float>(width)*ratio, static_cast<float>(height)));
 	_prog->setUniformValue("projection", projection);
-	_prog->setAttributeValue("text", 0);
+	_prog->setUniformValue("text", 0);
     // Configure VAO/VBO for texture quads
-    //glGenVertexArrays(1, &this->VAO);
 	VAO.create();
-    //glGenBuffers(1, &this->VBO);
 	VBO.create();
-    //glBindVertexArray(this->VAO);
 	VAO.bind();
-    //glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
 	VBO.bind();
-    //glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
+	// The buffer is sized on demand by RenderText
 	VBO.setUsagePattern(QOpenGLBuffer::DynamicDraw);
-	VBO.allocate(NULL, sizeof(GLfloat) * 6 * 4);
-    //glEnableVertexAttribArray(0);
 	_prog->enableAttributeArray(0);
-    //glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), 0);
-	_prog->setAttributeBuffer(0, GL_FLOAT, 0, 4, 4 * sizeof(GLfloat));
-    //glBindBuffer(GL_ARRAY_BUFFER, 0);
+	_prog->setAttributeBuffer(0, GL_FLOAT, 0, 4, TEXT_VERTEX_FLOATS * sizeof(GLfloat));
+	_prog->enableAttributeArray(1);
+	_prog->setAttributeBuffer(1, GL_FLOAT, 4 * sizeof(GLfloat), 1, TEXT_VERTEX_FLOATS * sizeof(GLfloat));
 	VBO.release();
-    //glBindVertexArray(0);
 	VAO.release();
+	GLDebugLog::label(this, GL_VERTEX_ARRAY, VAO.objectId(), "Text VAO");
+	GLDebugLog::label(this, GL_BUFFER, VBO.bufferId(), "Text quads");
+
+	// Configure the instanced label quads, one instance per glyph
+	if (_labelProg)
+	{
+		_labelVBO = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+		_labelVAO.create();
+		_labelVBO.create();
+		_labelVAO.bind();
+		_labelVBO.bind();
+		_labelVBO.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+		const int stride = LABEL_INSTANCE_FLOATS * sizeof(GLfloat);
+		const int sizes[] = { 3, 2, 2, 4, 3, 1 };
+		int offset = 0;
+		for (GLuint loc = 0; loc < 6; loc++)
+		{
+			_labelProg->enableAttributeArray(loc);
+			_labelProg->setAttributeBuffer(loc, GL_FLOAT, offset * sizeof(GLfloat), sizes[loc], stride);
+			glVertexAttribDivisor(loc, 1);
+			offset += sizes[loc];
+		}
+		_labelVBO.release();
+		_labelVAO.release();
+		GLDebugLog::label(this, GL_VERTEX_ARRAY, _labelVAO.objectId(), "Label VAO");
+		GLDebugLog::label(this, GL_BUFFER, _labelVBO.bufferId(), "Label instances");
+	}
+}
+
+TextRenderer::~TextRenderer()
+{
+	if (_ownsCache)
+		delete _cache;
+	GLDebugLog::unlabel(GL_BUFFER, VBO.bufferId());
+	GLDebugLog::unlabel(GL_VERTEX_ARRAY, VAO.objectId());
+	VBO.destroy();
+	VAO.destroy();
+	if (_labelVBO.isCreated())
+	{
+		GLDebugLog::unlabel(GL_BUFFER, _labelVBO.bufferId());
+		_labelVBO.destroy();
+	}
+	if (_labelVAO.isCreated())
+	{
+		GLDebugLog::unlabel(GL_VERTEX_ARRAY, _labelVAO.objectId());
+		_labelVAO.destroy();
+	}
+}
+
+void TextRenderer::Load(std::string font, GLuint fontSize, bool sdf)
+{
+    _font = _cache->addFont(font);
+    if (_font < 0)
+        std::cout << "ERROR::FREETYPE: Too many fonts in the glyph cache, cannot add " << font << std::endl;
+    _fontSize = fontSize;
+    _sdf = sdf;
+    _labelsDirty = true;
+}
+
+GLint TextRenderer::capHeight()
+{
+    const Glyph* h = _cache->glyph(_font, _fontSize, _sdf, U'H');
+    return h ? h->Bearing.y : static_cast<GLint>(_fontSize);
 }
 
-void TextRenderer::Load(std::string font, GLuint fontSize)
+void TextRenderer::RenderText(const std::string& text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color)
 {
-    // First clear the previously loaded Characters
-    this->Characters.clear();
-    // Then initialize and load the FreeType library
-    FT_Library ft;    
-    if (FT_Init_FreeType(&ft)) // All functions return a value different than 0 whenever an error occurred
-        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
-    // Load font as face
-    FT_Face face;
-    if (FT_New_Face(ft, font.c_str(), 0, &face))
-        std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
-    // Set size to load glyphs as
-    FT_Set_Pixel_Sizes(face, 0, fontSize);
-    // Disable byte-alignment restriction
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); 
-    // Then for the first 128 ASCII characters, pre-load/compile their characters and store them
-    for (GLubyte c = 0; c < 128; c++)
+    if (_font < 0 || text.empty())
+        return;
+
+    // Build the quads of the whole string into one vertex array
+    _cache->nextStamp();
+    std::u32string codePoints = GlyphCache::decodeUtf8(text);
+    _vertices.clear();
+    _vertices.reserve(codePoints.size() * 6 * TEXT_VERTEX_FLOATS);
+    const GLint top = capHeight();
+    for (char32_t c : codePoints)
     {
-        // Load character glyph 
-        if (FT_Load_Char(face, c, FT_LOAD_RENDER))
-        {
-            std::cout << "Error in FreeType: Failed to load Glyph" << std::endl;
+        const Glyph* ch = _cache->glyph(_font, _fontSize, _sdf, c);
+        if (!ch)
             continue;
+
+        GLfloat xpos = x + ch->Bearing.x * scale;
+        GLfloat ypos = y + (top - ch->Bearing.y) * scale;
+
+        GLfloat w = ch->Size.x * scale;
+        GLfloat h = ch->Size.y * scale;
+        if (ch->Page >= 0)
+        {
+            const GLfloat page = static_cast<GLfloat>(ch->Page);
+            const GLfloat quad[6][TEXT_VERTEX_FLOATS] = {
+                { xpos,     ypos + h,   ch->UVMin.x, ch->UVMax.y, page },
+                { xpos + w, ypos,       ch->UVMax.x, ch->UVMin.y, page },
+                { xpos,     ypos,       ch->UVMin.x, ch->UVMin.y, page },
+
+                { xpos,     ypos + h,   ch->UVMin.x, ch->UVMax.y, page },
+                { xpos + w, ypos + h,   ch->UVMax.x, ch->UVMax.y, page },
+                { xpos + w, ypos,       ch->UVMax.x, ch->UVMin.y, page }
+            };
+            _vertices.insert(_vertices.end(), &quad[0][0], &quad[0][0] + 6 * TEXT_VERTEX_FLOATS);
         }
-        // Generate texture
-        GLuint texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            face->glyph->bitmap.buffer
-            );
-        // Set texture options
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-       
-        // Now store character for later use
-        Character character = {
-            texture,
-            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-            glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-            static_cast<GLuint>(face->glyph->advance.x)
-        };
-        Characters.insert(std::pair<GLchar, Character>(c, character));
+        // Now advance cursors for next glyph
+        x += (ch->Advance >> 6) * scale; // Bitshift by 6 to get value in pixels (1/64th times 2^6 = 64)
     }
-    glBindTexture(GL_TEXTURE_2D, 0);
-    // Destroy FreeType once we're finished
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
-}
+    if (_vertices.empty())
+        return;
 
-void TextRenderer::RenderText(std::string text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color)
-{
-    // Activate corresponding updateMatrix state	
+    // Activate corresponding render state
 	_prog->bind();
 	_prog->setUniformValue("textColor", QVector3D(color.x, color.y, color.z));
+	_prog->setUniformValue("b_sdf", _sdf);
     glActiveTexture(GL_TEXTURE0);
-    //glBindVertexArray(this->VAO);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, _cache->texture());
 	VAO.bind();
 
 	glDisable(GL_DEPTH_TEST);
 	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-    // Iterate through all characters
-    std::string::const_iterator c;
-    for (c = text.begin(); c != text.end(); c++)
-    {
-        Character ch = Characters[*c];
-
-        GLfloat xpos = x + ch.Bearing.x * scale;
-        GLfloat ypos = y + (this->Characters['H'].Bearing.y - ch.Bearing.y) * scale;
-
-        GLfloat w = ch.Size.x * scale;
-        GLfloat h = ch.Size.y * scale;
-        // Update VBO for each character
-        GLfloat vertices[6][4] = {
-            { xpos,     ypos + h,   0.0, 1.0 },
-            { xpos + w, ypos,       1.0, 0.0 },
-            { xpos,     ypos,       0.0, 0.0 },
-
-            { xpos,     ypos + h,   0.0, 1.0 },
-            { xpos + w, ypos + h,   1.0, 1.0 },
-            { xpos + w, ypos,       1.0, 0.0 }
-        };
-        // Render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        // Update content of VBO memory
-        //glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-		VBO.bind();
-        //glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // Be sure to use glBufferSubData and not glBufferData
-		VBO.write(0, vertices, sizeof(vertices));
-
-        //glBindBuffer(GL_ARRAY_BUFFER, 0);
-		VBO.release();
-		// Render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        // Now advance cursors for next glyph
-        x += (ch.Advance >> 6) * scale; // Bitshift by 6 to get value in pixels (1/64th times 2^6 = 64)
-    }
-    //glBindVertexArray(0);
+	// Upload the string, growing the buffer only when it is too small
+	int bytes = static_cast<int>(_vertices.size() * sizeof(GLfloat));
+	VBO.bind();
+	if (bytes > _vboCapacity)
+	{
+		_vboCapacity = std::max(bytes, 2 * _vboCapacity);
+		VBO.allocate(_vboCapacity);
+	}
+	VBO.write(0, _vertices.data(), bytes);
+	VBO.release();
+
+	// Render all quads at once
+	glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(_vertices.size() / TEXT_VERTEX_FLOATS));
+	DrawStatistics::count(GL_TRIANGLES, static_cast<GLsizei>(_vertices.size() / TEXT_VERTEX_FLOATS));
+
 	VAO.release();
-    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
 
 	_prog->release();
 }
+
+void TextRenderer::AddLabel(const QVector3D& position, const std::string& text, GLfloat pixelHeight, glm::vec3 color)
+{
+	_labels.push_back(Label{ position, text, pixelHeight, color });
+	_labelsDirty = true;
+}
+
+void TextRenderer::ClearLabels()
+{
+	_labels.clear();
+	_labelInstances.clear();
+	_labelsDirty = true;
+}
+
+void TextRenderer::buildLabelInstances()
+{
+	_labelInstances.clear();
+	if (_font < 0 || _fontSize == 0)
+		return;
+	_cache->nextStamp();
+	const GLint top = capHeight();
+	for (const Label& label : _labels)
+	{
+		std::u32string codePoints = GlyphCache::decodeUtf8(label.Text);
+		GLfloat scale = label.PixelHeight / _fontSize;
+		// Center the label horizontally over its anchor
+		GLfloat width = 0.0f;
+		for (char32_t c : codePoints)
+		{
+			if (const Glyph* ch = _cache->glyph(_font, _fontSize, _sdf, c))
+				width += (ch->Advance >> 6) * scale;
+		}
+		GLfloat x = -width / 2.0f;
+		GLfloat y = -top * scale;
+		for (char32_t c : codePoints)
+		{
+			const Glyph* ch = _cache->glyph(_font, _fontSize, _sdf, c);
+			if (!ch)
+				continue;
+			if (ch->Page >= 0)
+			{
+				const GLfloat instance[LABEL_INSTANCE_FLOATS] = {
+					label.Position.x(), label.Position.y(), label.Position.z(),
+					x + ch->Bearing.x * scale, y + (top - ch->Bearing.y) * scale,
+					ch->Size.x * scale, ch->Size.y * scale,
+					ch->UVMin.x, ch->UVMin.y, ch->UVMax.x, ch->UVMax.y,
+					label.Color.x, label.Color.y, label.Color.z,
+					static_cast<GLfloat>(ch->Page)
+				};
+				_labelInstances.insert(_labelInstances.end(), instance, instance + LABEL_INSTANCE_FLOATS);
+			}
+			x += (ch->Advance >> 6) * scale;
+		}
+	}
+	_labelsGeneration = _cache->generation();
+
+	// The instances only change with the labels, upload them once
+	_labelVBO.bind();
+	_labelVBO.allocate(_labelInstances.data(), static_cast<int>(_labelInstances.size() * sizeof(GLfloat)));
+	_labelVBO.release();
+}
+
+void TextRenderer::RenderLabels(const QMatrix4x4& viewProjection, GLuint viewportWidth, GLuint viewportHeight)
+{
+	if (!_labelProg || _labels.empty())
+		return;
+	// Rebuild when the labels change or a page holding their glyphs was evicted
+	if (_labelsDirty || _labelsGeneration != _cache->generation())
+	{
+		buildLabelInstances();
+		_labelsDirty = false;
+	}
+	if (_labelInstances.empty())
+		return;
+
+	_labelProg->bind();
+	_labelProg->setUniformValue("viewProjection", viewProjection);
+	_labelProg->setUniformValue("viewportSize", QVector2D(viewportWidth, viewportHeight));
+	_labelProg->setUniformValue("depthBias", 0.002f);
+	_labelProg->setUniformValue("text", 0);
+	_labelProg->setUniformValue("b_sdf", _sdf);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, _cache->texture());
+
+	// Labels hidden by the model are rejected by the depth test but must not occlude each other
+	glEnable(GL_DEPTH_TEST);
+	glDepthMask(GL_FALSE);
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+	_labelVAO.bind();
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(_labelInstances.size() / LABEL_INSTANCE_FLOATS));
+	DrawStatistics::count(GL_TRIANGLE_STRIP, 4, static_cast<GLsizei>(_labelInstances.size() / LABEL_INSTANCE_FLOATS));
+	_labelVAO.release();
+
+	glDepthMask(GL_TRUE);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	_labelProg->release();
+}
@@ -1,46 +1,81 @@
 #pragma once
 
-#include <map>
+#include <vector>
 #include <glm/glm.hpp>
 
 #include <QtOpenGL>
 #include <QOpenGLFunctions_4_5_Core>
 
+class GlyphCache;
 
-/// Holds all state information relevant to a character as loaded using FreeType
-struct Character {
-    GLuint TextureID;   // ID handle of the glyph texture
-    glm::ivec2 Size;    // Size of glyph
-    glm::ivec2 Bearing; // Offset from baseline to left/top of glyph
-    GLuint Advance;     // Horizontal offset to advance to next glyph
+
+/// A text label anchored at a point in world space
+struct Label {
+    QVector3D Position;  // World space anchor, the label is centered above it
+    std::string Text;
+    GLfloat PixelHeight; // On screen height of the font in pixels
+    glm::vec3 Color;
 };
 
 
-// A renderer class for rendering text displayed by a font loaded using the 
-// FreeType library. A single font is loaded, processed into a list of Character
-// items for later rendering.
+// A renderer class for rendering UTF-8 text displayed by a font loaded using the 
+// FreeType library. Glyphs are rasterized lazily into the pages of a GlyphCache,
+// which can be shared by renderers using different fonts.
+// When loaded as a signed distance field the glyphs stay crisp at any scale.
 class TextRenderer : public QOpenGLFunctions_4_5_Core
 {
 public:
-    // Constructor
-    TextRenderer(QOpenGLShaderProgram* prog, GLuint width, GLuint height);
-    // Pre-compiles a list of characters from the given font
-    void Load(std::string font, GLuint fontSize);
-    // Renders a string of text using the precompiled list of characters
-    void RenderText(std::string text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color = glm::vec3(1.0f));
-
-	void render() 
-	{ 
+    // Constructor, labelProg is only needed for world space labels. Without a
+    // cache the renderer creates its own.
+    TextRenderer(QOpenGLShaderProgram* prog, GLuint width, GLuint height, QOpenGLShaderProgram* labelProg = nullptr, GlyphCache* cache = nullptr);
+    ~TextRenderer();
+    // Selects the font to draw with, optionally as a signed distance field that
+    // scales without reloading. Glyphs are only rasterized when first drawn.
+    void Load(std::string font, GLuint fontSize, bool sdf = false);
+    // Renders a string of UTF-8 text with a single draw call
+    void RenderText(const std::string& text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color = glm::vec3(1.0f));
+
+    // World space billboard labels, all drawn with one instanced draw call
+    void AddLabel(const QVector3D& position, const std::string& text, GLfloat pixelHeight = 16.0f, glm::vec3 color = glm::vec3(1.0f));
+    void ClearLabels();
+    bool HasLabels() const { return !_labels.empty(); }
+    // Draws the labels over the scene, culled against the view volume and the depth buffer
+    void RenderLabels(const QMatrix4x4& viewProjection, GLuint viewportWidth, GLuint viewportHeight);
+
+	void render()
+	{
 		//Dummy implementation
 	}
 private:
 
-	// Holds a list of pre-compiled Characters
-	std::map<GLchar, Character> Characters;
+	// Lays out the labels into per glyph instance data
+	void buildLabelInstances();
+	// Height of the capitals above the baseline, used to align text by its top
+	GLint capHeight();
+
+	// Glyph source
+	GlyphCache* _cache;
+	bool _ownsCache;
+	int _font;
+	GLuint _fontSize;
+	bool _sdf;
+
+	// Vertex staging for a string, reused between calls
+	std::vector<GLfloat> _vertices;
+	int _vboCapacity;
 
 	// Shader Program
 	QOpenGLShaderProgram* _prog;
     // Render state
 	QOpenGLVertexArrayObject VAO;
 	QOpenGLBuffer VBO;
+
+	// World space labels
+	std::vector<Label> _labels;
+	std::vector<GLfloat> _labelInstances;
+	bool _labelsDirty;
+	GLuint _labelsGeneration;
+	QOpenGLShaderProgram* _labelProg;
+	QOpenGLVertexArrayObject _labelVAO;
+	QOpenGLBuffer _labelVBO;
 };
@@ -1,4 +1,8 @@
 #include "TriangleMesh.h"
+#include "CpuTrace.h"
+#include "DrawStatistics.h"
+#include "MemoryStatistics.h"
+#include "GLDebugLog.h"
 #include <algorithm>
 
 void TriangleMesh::initBuffers(
@@ -9,12 +13,28 @@ void TriangleMesh::initBuffers(
 	std::vector<GLfloat> * tangents
 )
 {
+	TRACE_SCOPE("TriangleMesh::initBuffers");
 
 	// Must have data for indices, points, and normals
 	if (indices == nullptr || points == nullptr || normals == nullptr)
 		return;
 
+	// Renderers in other contexts may still be reading the buffers
+	QMutexLocker lock(&_bufferMutex);
+	if (_readFence)
+	{
+		glWaitSync(_readFence, 0, GL_TIMEOUT_IGNORED);
+		glDeleteSync(_readFence);
+		_readFence = 0;
+	}
+
 	nVerts = (GLuint)indices->size();
+	_vertexCount = (GLuint)(points->size() / 3);
+	_generation++;
+	_hasTexCoords = texCoords != nullptr;
+
+	// A rebuild reallocates the same buffers, their handles are held already
+	_buffers.clear();
 
 	_buffers.push_back(_indexBuffer);
 	_indexBuffer.bind();
@@ -47,7 +67,22 @@ void TriangleMesh::initBuffers(
 		_tangentBuf.allocate(tangents->data(), static_cast<int>(tangents->size() * sizeof(GLfloat)));
 	}
 
+	long long bytes = static_cast<long long>(indices->size() * sizeof(GLuint))
+		+ static_cast<long long>((points->size() + normals->size()) * sizeof(GLfloat))
+		+ static_cast<long long>(((texCoords ? texCoords->size() : 0) + (tangents ? tangents->size() : 0)) * sizeof(GLfloat));
+	MemoryStatistics::setAllocation(MemoryStatistics::GPU_BUFFER, this, "Mesh " + _name, bytes, static_cast<int>(_buffers.size()));
+
+	GLDebugLog::label(this, GL_BUFFER, _indexBuffer.bufferId(), _name + " indices");
+	GLDebugLog::label(this, GL_BUFFER, _positionBuffer.bufferId(), _name + " positions");
+	GLDebugLog::label(this, GL_BUFFER, _normalBuffer.bufferId(), _name + " normals");
+	if (texCoords != nullptr)
+		GLDebugLog::label(this, GL_BUFFER, _texCoordBuffer.bufferId(), _name + " texture coordinates");
+	if (tangents != nullptr)
+		GLDebugLog::label(this, GL_BUFFER, _tangentBuf.bufferId(), _name + " tangents");
+
 	_vertexArrayObject.bind();
+	// Generated names become objects at their first bind, only those take a label
+	GLDebugLog::label(this, GL_VERTEX_ARRAY, _vertexArrayObject.objectId(), _name + " VAO");
 		
 	_indexBuffer.bind();
 
@@ -95,10 +130,49 @@ void TriangleMesh::render()
 	_prog->bind();
 	_vertexArrayObject.bind();
 	glDrawElements(GL_TRIANGLES, nVerts, GL_UNSIGNED_INT, 0);
+	DrawStatistics::count(GL_TRIANGLES, nVerts);
 	_vertexArrayObject.release();
 	_prog->release();
 }
 
+void TriangleMesh::setupVertexArray(QOpenGLFunctions_4_5_Core* f)
+{
+	_indexBuffer.bind();
+
+	_positionBuffer.bind();
+	f->glEnableVertexAttribArray(0);  // Vertex position
+	f->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+	_normalBuffer.bind();
+	f->glEnableVertexAttribArray(1);  // Normal
+	f->glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+	if (_hasTexCoords)
+	{
+		_texCoordBuffer.bind();
+		f->glEnableVertexAttribArray(2);  // Tex coord
+		f->glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+	}
+	_positionBuffer.release();
+}
+
+void TriangleMesh::setReadFence(QOpenGLFunctions_4_5_Core* f, GLsync fence)
+{
+	if (_readFence)
+		f->glDeleteSync(_readFence);
+	_readFence = fence;
+}
+
+void TriangleMesh::renderInstanced(GLsizei instances)
+{
+	if (!_vertexArrayObject.isCreated())
+		return;
+	_vertexArrayObject.bind();
+	glDrawElementsInstanced(GL_TRIANGLES, nVerts, GL_UNSIGNED_INT, 0, instances);
+	DrawStatistics::count(GL_TRIANGLES, nVerts, instances);
+	_vertexArrayObject.release();
+}
+
 
 TriangleMesh::~TriangleMesh()
 {
@@ -107,10 +181,17 @@ TriangleMesh::~TriangleMesh()
 
 void TriangleMesh::deleteBuffers()
 {
+	MemoryStatistics::release(this);
+	if (_readFence)
+	{
+		glDeleteSync(_readFence);
+		_readFence = 0;
+	}
 	if (_buffers.size() > 0)
 	{
 		for (QOpenGLBuffer& buff : _buffers)
 		{
+			GLDebugLog::unlabel(GL_BUFFER, buff.bufferId());
 			buff.destroy();
 		}
 			
@@ -119,12 +200,14 @@ void TriangleMesh::deleteBuffers()
 
 	if (_vertexArrayObject.isCreated()) 
 	{
+		GLDebugLog::unlabel(GL_VERTEX_ARRAY, _vertexArrayObject.objectId());
 		_vertexArrayObject.destroy();		
 	}
 }
 
 void TriangleMesh::computeBoundingSphere(std::vector<GLfloat> points)
 {
+	TRACE_SCOPE("TriangleMesh::computeBoundingSphere");
 	/*
 	float minX = 0, maxX = 0, minY = 0, maxY = 0, minZ = 0, maxZ = 0;
 	for (int i = 0; i < points.size(); i += 3)
@@ -159,6 +242,9 @@ void TriangleMesh::computeBoundingSphere(std::vector<GLfloat> points)
 	{
 		aPoints.push_back(QVector3D(points[i], points[i + 1], points[i + 2]));
 	}
+	// The copy of the points and the vectors made of them
+	MemoryStatistics::recordTransient("TriangleMesh::computeBoundingSphere",
+		MemoryStatistics::vectorBytes(points) + MemoryStatistics::vectorBytes(aPoints));
 	QVector3D xmin, xmax, ymin, ymax, zmin, zmax;
 	xmin = ymin = zmin = QVector3D(1,1,1) * INFINITY;
 	xmax = ymax = zmax = QVector3D(1,1,1) * -INFINITY;
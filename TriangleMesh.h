@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <QMutex>
 #include "Drawable.h"
 #include "BoundingSphere.h"
 
@@ -25,10 +26,17 @@ public:
 		_tangentBuf.create();
 
 		_vertexArrayObject.create();
+
+		_generation = 0;
+		_hasTexCoords = false;
+		_vertexCount = 0;
+		_readFence = 0;
 	}
 
     virtual ~TriangleMesh();
     virtual void render();
+	// Draws the mesh instances times, the shader program is bound by the caller
+	virtual void renderInstanced(GLsizei instances);
 	virtual BoundingSphere getBoundingSphere() const { return _boundingSphere; }
 
 	virtual QOpenGLVertexArrayObject& getVAO();
@@ -37,6 +45,22 @@ public:
 		return _name; 
 	}
 
+	// Incremented whenever the buffers are rebuilt
+	unsigned int generation() const { return _generation; }
+	GLuint indexCount() const { return nVerts; }
+	GLuint vertexCount() const { return _vertexCount; }
+	virtual GLenum primitiveType() const { return GL_TRIANGLES; }
+	// Binds the buffers to the vertex array bound in the current context at the
+	// attribute locations of the model shaders. Used by renderers in other contexts
+	// of the same share group, which can share buffers but not vertex arrays.
+	void setupVertexArray(QOpenGLFunctions_4_5_Core* f);
+	// Held by renderers in other contexts while they draw the buffers, and by a
+	// rebuild while it refills them
+	QMutex* bufferLock() { return &_bufferMutex; }
+	// Fence after a draw from another context, a rebuild waits for it before it
+	// refills the buffers. Called with the buffer lock held.
+	void setReadFence(QOpenGLFunctions_4_5_Core* f, GLsync fence);
+
 protected: // methods
 	virtual void initBuffers(
 		std::vector<GLuint> * indices,
@@ -59,6 +83,7 @@ protected:
 	QOpenGLBuffer _tangentBuf;
 
 	GLuint nVerts;     // Number of vertices
+	GLuint _vertexCount;     // Number of points in the buffers
 	QOpenGLVertexArrayObject _vertexArrayObject;        // The Vertex Array Object
 
 	// Vertex buffers
@@ -68,4 +93,10 @@ protected:
 
 	QString _name;
 
+	unsigned int _generation;
+	bool _hasTexCoords;
+
+	QMutex _bufferMutex;
+	GLsync _readFence;
+
 };
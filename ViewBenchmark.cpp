@@ -0,0 +1,393 @@
+#include "ViewBenchmark.h"
+#include "GLView.h"
+#include "DrawStatistics.h"
+#include "ModelCatalogue.h"
+#include "TriangleMesh.h"
+
+#include <QApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const char* FEATURE_SCENARIOS[] = { "multiview", "wireframe", "sections", "textured", "opacity50" };
+
+    // Nearest rank percentile of sorted times
+    double percentile(const std::vector<double>& sorted, double p)
+    {
+        size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+        return sorted[qBound<size_t>(1, rank, sorted.size()) - 1];
+    }
+}
+
+ViewBenchmark::ViewBenchmark() :
+    _scenarios({ "orbit", "multiview", "wireframe", "sections", "textured", "opacity50" }),
+    _featureModel(6),
+    _frames(120),
+    _warmupFrames(10),
+    _width(1280),
+    _height(720),
+    _output("view-benchmark.json"),
+    _threshold(10.0),
+    _view(nullptr)
+{
+}
+
+ViewBenchmark::~ViewBenchmark()
+{
+    delete _view;
+}
+
+void ViewBenchmark::printUsage()
+{
+    cout << "Usage: MatlEditor --benchmark [options]\n"
+         << "  --scenarios <a,b,...>  orbit, multiview, wireframe, sections, textured, opacity50, default all\n"
+         << "  --models <a,b,...>     Models orbited by the orbit scenario, names or numbers, default all\n"
+         << "  --model <name>         Model of the other scenarios, default Teapot\n"
+         << "  --frames <n>           Frames of one turn, default 120\n"
+         << "  --warmup <n>           Frames drawn before the measurement, default 10\n"
+         << "  --size <WxH>           View size, default 1280x720\n"
+         << "  --output <file>        Results as JSON, default view-benchmark.json\n"
+         << "  --baseline <file>      Results of an earlier run to compare with\n"
+         << "  --threshold <percent>  Slowdown of the median or p95 frame time that fails, default 10\n"
+         << "For comparable numbers run under llvmpipe without a display:\n"
+         << "  LIBGL_ALWAYS_SOFTWARE=1 MatlEditor -platform offscreen --benchmark ...\n";
+}
+
+bool ViewBenchmark::parseArguments(const QStringList& arguments)
+{
+    for (int i = arguments.indexOf("--benchmark") + 1; i < arguments.size(); i++)
+    {
+        const QString& option = arguments.at(i);
+        if (option == "--help")
+        {
+            printUsage();
+            return false;
+        }
+        if (i + 1 >= arguments.size())
+        {
+            cout << "Missing value for " << option.toStdString() << endl;
+            return false;
+        }
+        const QString& value = arguments.at(++i);
+
+        if (option == "--scenarios")
+        {
+            _scenarios = value.split(',', Qt::SkipEmptyParts);
+            for (const QString& scenario : _scenarios)
+            {
+                if (scenario != "orbit" && std::find(std::begin(FEATURE_SCENARIOS), std::end(FEATURE_SCENARIOS), scenario) == std::end(FEATURE_SCENARIOS))
+                {
+                    cout << "Unknown scenario " << scenario.toStdString() << endl;
+                    return false;
+                }
+            }
+        }
+        else if (option == "--models" || option == "--model")
+        {
+            std::vector<int> models;
+            for (const QString& name : value.split(',', Qt::SkipEmptyParts))
+            {
+                int model = ModelCatalogue::find(name.trimmed());
+                if (model < 0)
+                {
+                    cout << "Unknown model " << name.toStdString() << endl;
+                    return false;
+                }
+                models.push_back(model + 1);
+            }
+            if (option == "--models")
+                _models = models;
+            else if (models.size() == 1)
+                _featureModel = models.front();
+            else
+            {
+                cout << "--model takes one model" << endl;
+                return false;
+            }
+        }
+        else if (option == "--size")
+        {
+            QStringList size = value.split('x');
+            _width = size.size() == 2 ? size.at(0).toInt() : 0;
+            _height = size.size() == 2 ? size.at(1).toInt() : 0;
+            if (_width <= 0 || _height <= 0)
+            {
+                cout << "Invalid size " << value.toStdString() << endl;
+                return false;
+            }
+        }
+        else if (option == "--frames")
+            _frames = qMax(1, value.toInt());
+        else if (option == "--warmup")
+            _warmupFrames = qMax(0, value.toInt());
+        else if (option == "--output")
+            _output = value;
+        else if (option == "--baseline")
+            _baseline = value;
+        else if (option == "--threshold")
+            _threshold = value.toDouble();
+        else
+        {
+            cout << "Unknown option " << option.toStdString() << endl;
+            printUsage();
+            return false;
+        }
+    }
+    return true;
+}
+
+int ViewBenchmark::run()
+{
+    QJsonObject baseline;
+    if (!_baseline.isEmpty())
+    {
+        QFile file(_baseline);
+        QJsonDocument document = file.open(QIODevice::ReadOnly) ? QJsonDocument::fromJson(file.readAll()) : QJsonDocument();
+        if (!document.isObject())
+        {
+            cout << "Could not read the baseline " << _baseline.toStdString() << endl;
+            return 1;
+        }
+        baseline = document.object();
+    }
+
+    _view = new GLView();
+    _view->setFixedSize(_width, _height);
+    _view->show();
+
+    // The meshes are built by initializeGL on the first frame
+    QElapsedTimer wait;
+    wait.start();
+    while (!_view->isValid() && wait.elapsed() < 10000)
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+    if (!_view->isValid())
+    {
+        cout << "The view did not initialize" << endl;
+        return 1;
+    }
+
+    _view->makeCurrent();
+    QOpenGLFunctions* f = _view->context()->functions();
+    QString renderer = QString::fromLatin1(reinterpret_cast<const char*>(f->glGetString(GL_RENDERER)));
+
+    std::vector<Scenario> scenarios;
+    for (const QString& name : _scenarios)
+    {
+        if (name == "orbit")
+        {
+            std::vector<int> models = _models;
+            if (models.empty())
+            {
+                for (int model = 1; model <= ModelCatalogue::count(); model++)
+                    models.push_back(model);
+            }
+            for (int model : models)
+                scenarios.push_back({ "orbit/" + ModelCatalogue::name(model - 1), model, NONE });
+        }
+        else if (name == "multiview")
+            scenarios.push_back({ name, _featureModel, MULTI_VIEW });
+        else if (name == "wireframe")
+            scenarios.push_back({ name, _featureModel, WIREFRAME });
+        else if (name == "sections")
+            scenarios.push_back({ name, _featureModel, SECTIONS });
+        else if (name == "textured")
+            scenarios.push_back({ name, _featureModel, TEXTURED });
+        else if (name == "opacity50")
+            scenarios.push_back({ name, _featureModel, TRANSLUCENT });
+    }
+
+    QJsonArray results;
+    for (const Scenario& scenario : scenarios)
+        results.append(runScenario(scenario));
+
+    QJsonObject document;
+    document["benchmark"] = "view";
+    document["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    document["renderer"] = renderer;
+    document["size"] = QString("%1x%2").arg(_width).arg(_height);
+    document["frames"] = _frames;
+    document["scenarios"] = results;
+
+    QFile file(_output);
+    if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(document).toJson()) < 0)
+    {
+        cout << "Could not write " << _output.toStdString() << ": " << file.errorString().toStdString() << endl;
+        return 1;
+    }
+    cout << "Wrote " << _output.toStdString() << endl;
+
+    if (!baseline.isEmpty() && !compare(document, baseline))
+        return 2;
+    return 0;
+}
+
+void ViewBenchmark::resetCamera(int model)
+{
+    // Frames are stepped by number, a transition would depend on the clock
+    _view->finishAnimation();
+    _view->_camera->setView(GLCamera::ViewProjection::SE_ISOMETRIC_VIEW);
+    _view->setModelNum(model);
+    _view->finishAnimation();
+    _view->markDirty(GLView::DirtyAll);
+}
+
+void ViewBenchmark::setFeature(Feature feature, bool enabled)
+{
+    switch (feature)
+    {
+    case MULTI_VIEW:
+        _view->setMultiView(enabled);
+        break;
+    case WIREFRAME:
+        _view->_bShaded = !enabled;
+        _view->updateView();
+        break;
+    case SECTIONS:
+        _view->_clipXEnabled = enabled;
+        _view->_clipYEnabled = enabled;
+        _view->_clipZEnabled = enabled;
+        _view->markDirty(GLView::DirtyClipping);
+        break;
+    case TEXTURED:
+        _view->_bHasTexture = enabled;
+        _view->updateView();
+        break;
+    case TRANSLUCENT:
+        _view->_opacity = enabled ? 0.5f : 1.0f;
+        _view->_ambiMat[3] = _view->_opacity;
+        _view->_diffMat[3] = _view->_opacity;
+        _view->_specMat[3] = _view->_opacity;
+        _view->updateView();
+        break;
+    default:
+        break;
+    }
+}
+
+QJsonObject ViewBenchmark::runScenario(const Scenario& scenario)
+{
+    resetCamera(scenario.model);
+    setFeature(scenario.feature, true);
+
+    QOpenGLFunctions* f = _view->context()->functions();
+    GLfloat step = 360.0f / _frames;
+    std::vector<double> times;
+    long long drawCalls = 0;
+    long long triangles = 0;
+    for (int frame = -_warmupFrames; frame < _frames; frame++)
+    {
+        _view->_camera->rotateY(step);
+        _view->markDirty(GLView::DirtyCamera);
+
+        DrawStatistics::reset();
+        QElapsedTimer clock;
+        clock.start();
+        _view->repaint();
+        _view->makeCurrent();
+        f->glFinish();
+        qint64 time = clock.nsecsElapsed();
+
+        if (frame >= 0)
+        {
+            times.push_back(time / 1.0e6);
+            drawCalls += DrawStatistics::drawCalls();
+            triangles += DrawStatistics::triangles();
+        }
+        // Timers and the update the dirty flags queued, outside of the measurement
+        QCoreApplication::processEvents();
+    }
+    setFeature(scenario.feature, false);
+
+    std::vector<double> sorted = times;
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (double time : times)
+        total += time;
+
+    QJsonObject result;
+    result["name"] = scenario.name;
+    result["model"] = ModelCatalogue::name(scenario.model - 1);
+    result["frames"] = static_cast<int>(times.size());
+    result["p50Ms"] = percentile(sorted, 50.0);
+    result["p95Ms"] = percentile(sorted, 95.0);
+    result["p99Ms"] = percentile(sorted, 99.0);
+    result["meanMs"] = total / times.size();
+    result["maxMs"] = sorted.back();
+    result["drawCallsPerFrame"] = static_cast<double>(drawCalls) / times.size();
+    result["trianglesPerFrame"] = static_cast<double>(triangles) / times.size();
+
+    cout << scenario.name.toStdString() << ": p50 " << result["p50Ms"].toDouble()
+         << " ms, p95 " << result["p95Ms"].toDouble()
+         << " ms, p99 " << result["p99Ms"].toDouble()
+         << " ms, " << result["drawCallsPerFrame"].toDouble() << " draws, "
+         << static_cast<long long>(result["trianglesPerFrame"].toDouble()) << " triangles" << endl;
+    return result;
+}
+
+bool ViewBenchmark::compare(const QJsonObject& results, const QJsonObject& baseline) const
+{
+    // Times of other renderers or sizes say nothing, the counts still do
+    bool compareTimes = results["renderer"] == baseline["renderer"] && results["size"] == baseline["size"];
+    if (!compareTimes)
+        cout << "The baseline was measured with " << baseline["renderer"].toString().toStdString()
+             << " at " << baseline["size"].toString().toStdString() << ", only the counts are compared" << endl;
+
+    QHash<QString, QJsonObject> base;
+    for (const QJsonValue& value : baseline["scenarios"].toArray())
+        base.insert(value.toObject()["name"].toString(), value.toObject());
+
+    int regressions = 0;
+    double limit = 1.0 + _threshold / 100.0;
+    for (const QJsonValue& value : results["scenarios"].toArray())
+    {
+        QJsonObject scenario = value.toObject();
+        QString name = scenario["name"].toString();
+        if (!base.contains(name))
+        {
+            cout << name.toStdString() << ": not in the baseline" << endl;
+            continue;
+        }
+        const QJsonObject& before = base[name];
+
+        QStringList problems;
+        if (compareTimes)
+        {
+            for (const char* key : { "p50Ms", "p95Ms" })
+            {
+                double now = scenario[key].toDouble();
+                double then = before[key].toDouble();
+                if (now > then * limit)
+                    problems << QString("%1 %2 ms, was %3 ms (+%4%)").arg(key).arg(now, 0, 'f', 2).arg(then, 0, 'f', 2)
+                                .arg((now / then - 1.0) * 100.0, 0, 'f', 0);
+            }
+        }
+        // The counts are exact, any growth is a change of the drawing
+        for (const char* key : { "drawCallsPerFrame", "trianglesPerFrame" })
+        {
+            double now = scenario[key].toDouble();
+            double then = before[key].toDouble();
+            if (now > then + 0.5)
+                problems << QString("%1 %2, was %3").arg(key).arg(now, 0, 'f', 0).arg(then, 0, 'f', 0);
+        }
+
+        if (!problems.isEmpty())
+        {
+            regressions++;
+            cout << "REGRESSION " << name.toStdString() << ": " << problems.join(", ").toStdString() << endl;
+        }
+    }
+
+    if (regressions)
+        cout << regressions << " scenarios regressed beyond the baseline" << endl;
+    else
+        cout << "No regressions against " << _baseline.toStdString() << endl;
+    return regressions == 0;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+
+class GLView;
+
+
+// Drives GLView through fixed scenarios without any input and measures every
+// frame, started with --benchmark:
+//
+//   MatlEditor -platform offscreen --benchmark --output run.json --baseline base.json
+//
+// A frame is timed from the scene change until the GPU finished drawing it.
+// The results hold the frame time percentiles and the draw calls and triangles
+// per frame of every scenario. With a baseline the run fails when a scenario
+// got slower than the threshold allows or submits more draw calls or triangles.
+class ViewBenchmark
+{
+public:
+    ViewBenchmark();
+    ~ViewBenchmark();
+
+    // Reads the options following --benchmark, false after printing the problem
+    bool parseArguments(const QStringList& arguments);
+    // Runs the scenarios, returns 0, 1 on errors or 2 on regressions
+    int run();
+
+    static void printUsage();
+
+private:
+    enum Feature { NONE, MULTI_VIEW, WIREFRAME, SECTIONS, TEXTURED, TRANSLUCENT };
+
+    struct Scenario
+    {
+        QString name;
+        int model;                // 1 based as in GLView
+        Feature feature;
+    };
+
+    // Applies or removes the feature of a scenario
+    void setFeature(Feature feature, bool enabled);
+    // Shows the model fitted in the isometric view, without the view transition
+    void resetCamera(int model);
+    // One turn about the vertical axis, returns the results of the scenario
+    QJsonObject runScenario(const Scenario& scenario);
+    // Regressions against the baseline, printed, false if there are any
+    bool compare(const QJsonObject& results, const QJsonObject& baseline) const;
+
+    // Options
+    QStringList _scenarios;
+    std::vector<int> _models;     // Orbited one by one, all by default
+    int _featureModel;            // Model of the feature scenarios
+    int _frames;
+    int _warmupFrames;
+    int _width;
+    int _height;
+    QString _output;
+    QString _baseline;
+    double _threshold;            // Percent the frame times may grow
+
+    GLView* _view;
+};
@@ -0,0 +1,620 @@
+#include "GeometryBenchmark.h"
+#include "ModelCatalogue.h"
+#include "ParametricSurface.h"
+#include "Sphere.h"
+#include "Cylinder.h"
+#include "Cone.h"
+#include "Torus.h"
+#include "Teapot.h"
+#include "ObjMesh.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif !defined(Q_OS_LINUX)
+#include <sys/resource.h>
+#endif
+
+using std::cout;
+using std::endl;
+
+namespace
+{
+    // Declares every attribute the meshes bind, so all buffers are set up as in the viewer
+    const char* VERTEX_SHADER =
+        "#version 330\n"
+        "in vec3 vertexPosition;\n"
+        "in vec3 vertexNormal;\n"
+        "in vec2 texCoord2d;\n"
+        "in vec4 tangentCoord;\n"
+        "out vec4 color;\n"
+        "void main()\n"
+        "{\n"
+        "    color = vec4(vertexNormal + tangentCoord.xyz, texCoord2d.x + texCoord2d.y);\n"
+        "    gl_Position = vec4(vertexPosition, 1.0);\n"
+        "}\n";
+    const char* FRAGMENT_SHADER =
+        "#version 330\n"
+        "in vec4 color;\n"
+        "out vec4 fragColor;\n"
+        "void main()\n"
+        "{\n"
+        "    fragColor = color;\n"
+        "}\n";
+
+    typedef GeometryBenchmark::Sample Sample;
+
+    // Runs the work and waits for the GL commands it issued, so buffer uploads count
+    qint64 timed(const std::function<void()>& work)
+    {
+        QElapsedTimer clock;
+        clock.start();
+        work();
+        QOpenGLContext::currentContext()->functions()->glFinish();
+        return clock.nsecsElapsed();
+    }
+
+    // Resets the peak resident memory where the system allows it, true if it did
+    bool resetPeakMemory()
+    {
+#ifdef Q_OS_LINUX
+        QFile clearRefs("/proc/self/clear_refs");
+        return clearRefs.open(QIODevice::WriteOnly) && clearRefs.write("5") == 1;
+#else
+        return false;
+#endif
+    }
+
+    // Peak resident memory in bytes since the last reset or the start, -1 if unknown
+    qint64 peakMemory()
+    {
+#if defined(Q_OS_LINUX)
+        QFile status("/proc/self/status");
+        if (!status.open(QIODevice::ReadOnly))
+            return -1;
+        for (const QByteArray& line : status.readAll().split('\n'))
+        {
+            if (line.startsWith("VmHWM:"))
+                return line.mid(6).trimmed().split(' ').first().toLongLong() * 1024;
+        }
+        return -1;
+#elif defined(Q_OS_WIN)
+        PROCESS_MEMORY_COUNTERS counters;
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return -1;
+        return static_cast<qint64>(counters.PeakWorkingSetSize);
+#else
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return static_cast<qint64>(usage.ru_maxrss);   // Bytes on macOS
+#endif
+    }
+
+    // The catalogue models that are not parametric surfaces but have a resolution
+    bool isPrimitive(const QString& name)
+    {
+        return name == "Sphere" || name == "Cylinder" || name == "Cone" || name == "Torus";
+    }
+
+    TriangleMesh* createPrimitive(const QString& name, QOpenGLShaderProgram* prog, GLuint resolution)
+    {
+        if (name == "Sphere")
+            return new Sphere(prog, 75.0f, resolution, resolution);
+        if (name == "Cylinder")
+            return new Cylinder(prog, 60.0f, 100.0f, resolution, 1);
+        if (name == "Cone")
+            return new Cone(prog, 60.0f, 100.0f, resolution, 1);
+        if (name == "Torus")
+            return new Torus(prog, 50.0f, 25.0f, resolution, resolution);
+        return nullptr;
+    }
+
+    template <typename T>
+    bool parseList(const QString& value, std::vector<T>& list)
+    {
+        list.clear();
+        for (const QString& item : value.split(',', Qt::SkipEmptyParts))
+        {
+            bool valid = false;
+            T number = static_cast<T>(item.trimmed().toLongLong(&valid));
+            if (!valid || number <= 0)
+                return false;
+            list.push_back(number);
+        }
+        return !list.empty();
+    }
+}
+
+// Exposes the protected mesh
+class BoundingSphereProbe : public TriangleMesh
+{
+public:
+    BoundingSphereProbe(QOpenGLShaderProgram* prog) : TriangleMesh(prog, "Bounding Sphere") {}
+    using TriangleMesh::computeBoundingSphere;
+};
+
+// Reaches the loading steps of ObjMesh, which are protected
+class ObjMeshProbe : public ObjMesh
+{
+public:
+    // Loads the file and times only the conversion of its faces to the adjacency format
+    static Sample adjacency(const char* fileName)
+    {
+        ObjMeshData meshData;
+        Aabb bbox;
+        Sample sample = { 0, 0 };
+        if (!meshData.load(fileName, bbox))
+            return sample;
+        meshData.generateNormalsIfNeeded();
+        GlMeshData glMesh;
+        meshData.toGlMesh(glMesh);
+
+        sample.vertices = static_cast<qint64>(glMesh.points.size() / 3);
+        QElapsedTimer clock;
+        clock.start();
+        glMesh.convertFacesToAdjancencyFormat();
+        sample.nanoseconds = clock.nsecsElapsed();
+        return sample;
+    }
+};
+
+GeometryBenchmark::GeometryBenchmark() :
+    _resolutions({ 64, 150, 512, 2048 }),
+    _teapotGrids({ 16, 50, 128, 256 }),
+    _objFaces({ 1000000, 10000000, 50000000 }),
+    // The adjacency search compares every pair of triangles
+    _adjacencyFaces({ 2000, 8000, 32000 }),
+    _repeat(5),
+    _timeLimit(10.0),
+    _objDir(QDir::temp().filePath("MatlEditor-benchmark")),
+    _output("geometry-benchmark.json"),
+    _context(nullptr),
+    _surface(nullptr),
+    _program(nullptr),
+    _peakMemoryPerCase(true)
+{
+}
+
+GeometryBenchmark::~GeometryBenchmark()
+{
+    if (_context && _context->makeCurrent(_surface))
+    {
+        delete _program;
+        _context->doneCurrent();
+    }
+    delete _context;
+    delete _surface;
+}
+
+void GeometryBenchmark::printUsage()
+{
+    cout << "Usage: GeometryBenchmark [options]\n"
+         << "  --output <file>           Results as JSON, default geometry-benchmark.json\n"
+         << "  --filter <a,b,...>        Only the cases whose group/name contains one of these\n"
+         << "  --resolutions <a,b,...>   Slices and stacks of the surfaces, default 64,150,512,2048\n"
+         << "  --teapot-grids <a,b,...>  Grid of the teapot patches, default 16,50,128,256\n"
+         << "  --obj-faces <a,b,...>     Faces of the loaded OBJ files, default 1000000,10000000,50000000\n"
+         << "  --adjacency-faces <a,...> Faces converted to the adjacency format, default 2000,8000,32000\n"
+         << "  --objdir <dir>            Where the generated OBJ files are kept between runs\n"
+         << "  --repeat <n>              Runs per case, default 5\n"
+         << "  --time-limit <s>          No further runs of a case after this many seconds, default 10\n"
+         << "Groups: surface, boundingSphere, teapot, objLoad, adjacency.\n"
+         << "Without a display start with -platform offscreen.\n";
+}
+
+bool GeometryBenchmark::parseArguments(const QStringList& arguments)
+{
+    for (int i = 1; i < arguments.size(); i++)
+    {
+        const QString& option = arguments.at(i);
+        if (option == "--help")
+        {
+            printUsage();
+            return false;
+        }
+        if (i + 1 >= arguments.size())
+        {
+            cout << "Missing value for " << option.toStdString() << endl;
+            return false;
+        }
+        const QString& value = arguments.at(++i);
+
+        bool valid = true;
+        if (option == "--output")
+            _output = value;
+        else if (option == "--filter")
+            _filters = value.split(',', Qt::SkipEmptyParts);
+        else if (option == "--resolutions")
+            valid = parseList(value, _resolutions);
+        else if (option == "--teapot-grids")
+            valid = parseList(value, _teapotGrids);
+        else if (option == "--obj-faces")
+            valid = parseList(value, _objFaces);
+        else if (option == "--adjacency-faces")
+            valid = parseList(value, _adjacencyFaces);
+        else if (option == "--objdir")
+            _objDir = value;
+        else if (option == "--repeat")
+        {
+            _repeat = value.toInt();
+            valid = _repeat > 0;
+        }
+        else if (option == "--time-limit")
+        {
+            _timeLimit = value.toDouble();
+            valid = _timeLimit > 0.0;
+        }
+        else
+        {
+            cout << "Unknown option " << option.toStdString() << endl;
+            printUsage();
+            return false;
+        }
+
+        if (!valid)
+        {
+            cout << "Invalid value " << value.toStdString() << " for " << option.toStdString() << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool GeometryBenchmark::createContext()
+{
+    // Compatibility profile for the quad meshes, as in the viewer
+    QSurfaceFormat format;
+    format.setVersion(4, 5);
+    format.setProfile(QSurfaceFormat::CompatibilityProfile);
+
+    _context = new QOpenGLContext();
+    _context->setFormat(format);
+    if (!_context->create())
+    {
+        cout << "Could not create an OpenGL context" << endl;
+        return false;
+    }
+
+    _surface = new QOffscreenSurface();
+    _surface->setFormat(_context->format());
+    _surface->create();
+    if (!_context->makeCurrent(_surface))
+    {
+        cout << "Could not make the OpenGL context current" << endl;
+        return false;
+    }
+
+    _program = new QOpenGLShaderProgram();
+    if (!_program->addShaderFromSourceCode(QOpenGLShader::Vertex, VERTEX_SHADER) ||
+        !_program->addShaderFromSourceCode(QOpenGLShader::Fragment, FRAGMENT_SHADER) ||
+        !_program->link())
+    {
+        cout << "Could not build the shader program: " << _program->log().toStdString() << endl;
+        return false;
+    }
+    return true;
+}
+
+int GeometryBenchmark::run()
+{
+    if (!createContext())
+        return 1;
+
+    QOpenGLFunctions* f = _context->functions();
+    QString renderer = QString::fromLatin1(reinterpret_cast<const char*>(f->glGetString(GL_RENDERER)));
+    QString version = QString::fromLatin1(reinterpret_cast<const char*>(f->glGetString(GL_VERSION)));
+    cout << "Renderer: " << renderer.toStdString() << '\n';
+    cout << "Version:  " << version.toStdString() << "\n\n";
+
+    benchmarkSurfaces();
+    benchmarkBoundingSphere();
+    benchmarkTeapot();
+    benchmarkObjLoad();
+    benchmarkAdjacency();
+
+    QJsonObject document;
+    document["benchmark"] = "geometry";
+    document["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    document["renderer"] = renderer;
+    document["glVersion"] = version;
+    document["qtVersion"] = QString::fromLatin1(qVersion());
+    document["threads"] = QThread::idealThreadCount();
+    document["peakMemoryPerCase"] = _peakMemoryPerCase;
+    document["results"] = _results;
+
+    QFile file(_output);
+    if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(document).toJson()) < 0)
+    {
+        cout << "Could not write " << _output.toStdString() << ": " << file.errorString().toStdString() << endl;
+        return 1;
+    }
+    cout << "\nWrote " << _results.size() << " results to " << _output.toStdString() << endl;
+    return 0;
+}
+
+bool GeometryBenchmark::matches(const QString& group, const QString& name) const
+{
+    if (_filters.isEmpty())
+        return true;
+    QString id = group + "/" + name;
+    for (const QString& filter : _filters)
+    {
+        if (id.contains(filter, Qt::CaseInsensitive))
+            return true;
+    }
+    return false;
+}
+
+void GeometryBenchmark::measure(const QString& group, const QString& name, int size, const Case& runCase)
+{
+    // The peak covers the runs only, not what earlier cases left behind
+    bool perCase = resetPeakMemory();
+    _peakMemoryPerCase = _peakMemoryPerCase && perCase;
+
+    std::vector<double> times;
+    qint64 vertices = 0;
+    QElapsedTimer total;
+    total.start();
+    while (static_cast<int>(times.size()) < _repeat && (times.empty() || total.elapsed() < _timeLimit * 1000.0))
+    {
+        Sample sample = runCase();
+        vertices = sample.vertices;
+        times.push_back(sample.nanoseconds / 1.0e6);
+    }
+    qint64 peak = peakMemory();
+
+    std::vector<double> sorted = times;
+    std::sort(sorted.begin(), sorted.end());
+    double median = sorted.size() % 2 ? sorted[sorted.size() / 2]
+                                      : (sorted[sorted.size() / 2 - 1] + sorted[sorted.size() / 2]) / 2.0;
+    double throughput = median > 0.0 ? vertices / (median / 1000.0) : 0.0;
+
+    QJsonObject result;
+    result["group"] = group;
+    result["name"] = name;
+    result["size"] = size;
+    result["runs"] = static_cast<int>(times.size());
+    result["medianMs"] = median;
+    result["minMs"] = sorted.front();
+    result["maxMs"] = sorted.back();
+    result["vertices"] = static_cast<double>(vertices);
+    result["verticesPerSecond"] = throughput;
+    result["peakMemoryBytes"] = static_cast<double>(peak);
+    if (!perCase)
+        result["peakMemoryScope"] = "process";
+    _results.append(result);
+
+    cout << group.toStdString() << " " << name.toStdString() << " " << size << ": "
+         << median << " ms, " << throughput / 1.0e6 << " M vertices/s, "
+         << peak / (1024 * 1024) << " MB peak" << endl;
+}
+
+void GeometryBenchmark::benchmarkSurfaces()
+{
+    for (int model = 0; model < ModelCatalogue::count(); model++)
+    {
+        QString name = ModelCatalogue::name(model);
+        // The teapot has a patch grid instead, see benchmarkTeapot
+        if (name == "Teapot" || !matches("surface", name))
+            continue;
+
+        // Nothing to resolve on a cube
+        if (name == "Cube")
+        {
+            measure("surface", name, 0, [&]() {
+                std::unique_ptr<TriangleMesh> mesh;
+                Sample sample;
+                sample.nanoseconds = timed([&]() { mesh.reset(ModelCatalogue::create(model, _program)); });
+                sample.vertices = mesh->vertexCount();
+                return sample;
+            });
+            continue;
+        }
+
+        for (int resolution : _resolutions)
+        {
+            GLuint slices = static_cast<GLuint>(resolution);
+            if (isPrimitive(name))
+            {
+                measure("surface", name, resolution, [&]() {
+                    std::unique_ptr<TriangleMesh> mesh;
+                    Sample sample;
+                    sample.nanoseconds = timed([&]() { mesh.reset(createPrimitive(name, _program, slices)); });
+                    sample.vertices = mesh->vertexCount();
+                    return sample;
+                });
+                continue;
+            }
+
+            // Built at the catalogue resolution outside of the timing, then rebuilt
+            // as the editors do
+            std::unique_ptr<TriangleMesh> mesh(ModelCatalogue::create(model, _program));
+            ParametricSurface* surface = dynamic_cast<ParametricSurface*>(mesh.get());
+            if (!surface)
+            {
+                cout << "No resolution for " << name.toStdString() << ", skipped" << endl;
+                break;
+            }
+            measure("surface", name, resolution, [&]() {
+                Sample sample;
+                sample.nanoseconds = timed([&]() { surface->buildMesh(slices, slices); });
+                sample.vertices = surface->vertexCount();
+                return sample;
+            });
+        }
+    }
+}
+
+void GeometryBenchmark::benchmarkBoundingSphere()
+{
+    if (!matches("boundingSphere", "computeBoundingSphere"))
+        return;
+
+    BoundingSphereProbe probe(_program);
+    for (int resolution : _resolutions)
+    {
+        // A noisy cloud, so the second pass of Ritter's algorithm has work to do
+        std::mt19937 random(resolution);
+        std::normal_distribution<GLfloat> coordinate(0.0f, 50.0f);
+        std::vector<GLfloat> points(static_cast<size_t>(resolution) * resolution * 3);
+        for (GLfloat& value : points)
+            value = coordinate(random);
+
+        measure("boundingSphere", "computeBoundingSphere", resolution, [&]() {
+            Sample sample;
+            sample.nanoseconds = timed([&]() { probe.computeBoundingSphere(points); });
+            sample.vertices = static_cast<qint64>(points.size() / 3);
+            return sample;
+        });
+    }
+}
+
+void GeometryBenchmark::benchmarkTeapot()
+{
+    if (!matches("teapot", "generatePatches"))
+        return;
+
+    glm::mat4 lidTransform = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 15.0f, 25.0f));
+    for (int grid : _teapotGrids)
+    {
+        measure("teapot", "generatePatches", grid, [&]() {
+            std::unique_ptr<Teapot> teapot;
+            Sample sample;
+            sample.nanoseconds = timed([&]() { teapot.reset(new Teapot(_program, 35.0f, grid, lidTransform)); });
+            sample.vertices = teapot->vertexCount();
+            return sample;
+        });
+    }
+}
+
+void GeometryBenchmark::benchmarkObjLoad()
+{
+    if (!matches("objLoad", "ObjMesh::load"))
+        return;
+
+    for (qint64 faces : _objFaces)
+    {
+        QString fileName = objFile(faces);
+        if (fileName.isEmpty())
+            continue;
+        QByteArray path = QFile::encodeName(fileName);
+        measure("objLoad", "ObjMesh::load", static_cast<int>(faces), [&]() {
+            std::unique_ptr<ObjMesh> mesh;
+            Sample sample;
+            sample.nanoseconds = timed([&]() { mesh = ObjMesh::load(_program, path.constData()); });
+            sample.vertices = mesh ? mesh->vertexCount() : 0;
+            return sample;
+        });
+    }
+}
+
+void GeometryBenchmark::benchmarkAdjacency()
+{
+    if (!matches("adjacency", "convertFacesToAdjancencyFormat"))
+        return;
+
+    for (qint64 faces : _adjacencyFaces)
+    {
+        QString fileName = objFile(faces);
+        if (fileName.isEmpty())
+            continue;
+        QByteArray path = QFile::encodeName(fileName);
+        measure("adjacency", "convertFacesToAdjancencyFormat", static_cast<int>(faces), [&]() {
+            return ObjMeshProbe::adjacency(path.constData());
+        });
+    }
+}
+
+QString GeometryBenchmark::objFile(qint64 faces)
+{
+    QString fileName = QDir(_objDir).filePath(QString("grid_%1.obj").arg(faces));
+    if (QFile::exists(fileName))
+        return fileName;
+
+    QDir().mkpath(_objDir);
+    QFile file(fileName + ".part");
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        cout << "Could not write " << file.fileName().toStdString() << ": " << file.errorString().toStdString() << endl;
+        return QString();
+    }
+    cout << "Generating " << fileName.toStdString() << endl;
+
+    // A wavy grid of quads split in two triangles each, without normals so the
+    // loader generates them
+    qint64 n = static_cast<qint64>(std::ceil(std::sqrt(faces / 2.0)));
+    QByteArray buffer;
+    buffer.reserve(4 << 20);
+    char line[128];
+    bool written = true;
+    auto flush = [&](bool force) {
+        if (force || buffer.size() > (4 << 20) - 128)
+        {
+            written = written && file.write(buffer) == buffer.size();
+            buffer.clear();
+        }
+    };
+
+    for (qint64 j = 0; j <= n; j++)
+    {
+        for (qint64 i = 0; i <= n; i++)
+        {
+            double x = 100.0 * i / n - 50.0;
+            double y = 100.0 * j / n - 50.0;
+            double z = 5.0 * std::sin(x * 0.2) * std::cos(y * 0.2);
+            buffer.append(line, snprintf(line, sizeof(line), "v %.5f %.5f %.5f\n", x, y, z));
+            flush(false);
+        }
+    }
+    for (qint64 j = 0; j <= n; j++)
+    {
+        for (qint64 i = 0; i <= n; i++)
+        {
+            buffer.append(line, snprintf(line, sizeof(line), "vt %.5f %.5f\n", double(i) / n, double(j) / n));
+            flush(false);
+        }
+    }
+    qint64 facesWritten = 0;
+    for (qint64 j = 0; j < n && facesWritten < faces; j++)
+    {
+        for (qint64 i = 0; i < n && facesWritten < faces; i++)
+        {
+            // OBJ indices start at 1
+            qint64 a = j * (n + 1) + i + 1, b = a + 1, c = a + n + 1, d = c + 1;
+            buffer.append(line, snprintf(line, sizeof(line), "f %lld/%lld %lld/%lld %lld/%lld\n", a, a, b, b, d, d));
+            if (++facesWritten < faces)
+            {
+                buffer.append(line, snprintf(line, sizeof(line), "f %lld/%lld %lld/%lld %lld/%lld\n", a, a, d, d, c, c));
+                ++facesWritten;
+            }
+            flush(false);
+        }
+    }
+    flush(true);
+    file.close();
+
+    if (!written || !file.rename(fileName))
+    {
+        cout << "Could not write " << fileName.toStdString() << endl;
+        file.remove();
+        return QString();
+    }
+    return fileName;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <QString>
+#include <QStringList>
+#include <QJsonArray>
+#include <QOffscreenSurface>
+#include <QtOpenGL>
+
+
+// Times the geometry code without a window and writes the results as JSON,
+// so the numbers of two builds can be compared in review:
+//
+//   GeometryBenchmark --output before.json
+//   GeometryBenchmark --output after.json --filter surface
+//
+// Every case reports the median of its runs, the throughput in vertices per
+// second and the peak resident memory while it ran. The meshes are built in
+// an offscreen context, so their buffer uploads are part of the times.
+class GeometryBenchmark
+{
+public:
+    GeometryBenchmark();
+    ~GeometryBenchmark();
+
+    // Reads the options, false after printing the problem
+    bool parseArguments(const QStringList& arguments);
+    // Runs the cases, returns the exit code of the process
+    int run();
+
+    static void printUsage();
+
+    // One timed run of a case
+    struct Sample
+    {
+        qint64 vertices;          // Produced by the run
+        qint64 nanoseconds;
+    };
+
+private:
+    typedef std::function<Sample()> Case;
+
+    bool createContext();
+    // Runs the case up to the repeat count or the time limit and records the result
+    void measure(const QString& group, const QString& name, int size, const Case& runCase);
+    bool matches(const QString& group, const QString& name) const;
+
+    void benchmarkSurfaces();
+    void benchmarkBoundingSphere();
+    void benchmarkTeapot();
+    void benchmarkObjLoad();
+    void benchmarkAdjacency();
+
+    // A triangulated grid with the number of faces, generated once per size
+    QString objFile(qint64 faces);
+
+    // Options
+    std::vector<int> _resolutions;
+    std::vector<int> _teapotGrids;
+    std::vector<qint64> _objFaces;
+    std::vector<qint64> _adjacencyFaces;
+    int _repeat;
+    double _timeLimit;            // Seconds, no more runs start after it
+    QStringList _filters;
+    QString _objDir;
+    QString _output;
+
+    QOpenGLContext* _context;
+    QOffscreenSurface* _surface;
+    QOpenGLShaderProgram* _program;
+    QJsonArray _results;
+    bool _peakMemoryPerCase;      // Every case so far measured its own peak
+};
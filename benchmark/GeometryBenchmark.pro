@@ -0,0 +1,75 @@
+######################################################################
+# Geometry micro-benchmarks without a window, see GeometryBenchmark.h
+######################################################################
+
+TEMPLATE = app
+TARGET = GeometryBenchmark
+INCLUDEPATH += . ..
+
+win32 {
+INCLUDEPATH += D:\software\libs\glm
+LIBS += -lpsapi
+}
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+QT += core gui widgets opengl
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# The CPU trace scopes stay compiled out, they would be part of the times
+
+HEADERS += GeometryBenchmark.h
+SOURCES += GeometryBenchmark.cpp \
+main.cpp
+
+# The geometry of the viewer
+HEADERS += ../GLDebugLog.h
+SOURCES += \
+../AppleSurface.cpp \
+../BentHorns.cpp \
+../BoundingSphere.cpp \
+../BowTie.cpp \
+../BoySurface.cpp \
+../BreatherSurface.cpp \
+../Cone.cpp \
+../ConeShell.cpp \
+../Crescent.cpp \
+../Cube.cpp \
+../Cylinder.cpp \
+../DoubleCone.cpp \
+../DrawStatistics.cpp \
+../Figure8KleinBottle.cpp \
+../Folium.cpp \
+../GLDebugLog.cpp \
+../GraysKlein.cpp \
+../Horn.cpp \
+../KleinBottle.cpp \
+../LimpetTorus.cpp \
+../MemoryStatistics.cpp \
+../ModelCatalogue.cpp \
+../ObjMesh.cpp \
+../ParametricSurface.cpp \
+../Periwinkle.cpp \
+../Point.cpp \
+../QuadMesh.cpp \
+../SaddleTorus.cpp \
+../Sphere.cpp \
+../SphericalHarmonic.cpp \
+../SpindleShell.cpp \
+../Spring.cpp \
+../SteinerSurface.cpp \
+../SuperEllipsoid.cpp \
+../SuperToroid.cpp \
+../Teapot.cpp \
+../TopShell.cpp \
+../Torus.cpp \
+../TriangleMesh.cpp \
+../TriaxialHexatorus.cpp \
+../TriaxialTritorus.cpp \
+../TurretShell.cpp \
+../TwistedPseudoSphere.cpp \
+../TwistedTriaxial.cpp \
+../VerrillMinimal.cpp \
+../WrinkledPeriwinkle.cpp
@@ -0,0 +1,12 @@
+#include <QGuiApplication>
+#include "GeometryBenchmark.h"
+
+
+int main(int argc, char** argv)
+{
+    QGuiApplication app(argc, argv);
+    GeometryBenchmark benchmark;
+    if (!benchmark.parseArguments(app.arguments()))
+        return 1;
+    return benchmark.run();
+}
@@ -1,12 +1,68 @@
 #include <QApplication>
 #include "MainWindow.h"
+#include "BatchRenderer.h"
+#include "RenderDaemon.h"
+#include "FrameRecorder.h"
+#include "ViewBenchmark.h"
+#include "SessionRecorder.h"
+#include "CpuTrace.h"
+
+#include <cstring>
 
 
 int main(int argc, char** argv)
 {   
+    // Catalogue images and animations without any window, see BatchRenderer, RenderDaemon and
+    // FrameRecorder, the scripted view benchmark, see ViewBenchmark, and the replay of
+    // recorded sessions, see SessionReplay
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--batch") == 0)
+        {
+            QGuiApplication app(argc, argv);
+            BatchRenderer batch;
+            if (!batch.parseArguments(app.arguments()))
+                return 1;
+            return batch.run();
+        }
+        if (strcmp(argv[i], "--daemon") == 0)
+        {
+            QGuiApplication app(argc, argv);
+            RenderDaemon daemon;
+            if (!daemon.parseArguments(app.arguments()) || !daemon.start())
+                return 1;
+            return app.exec();
+        }
+        if (strcmp(argv[i], "--record") == 0)
+        {
+            QGuiApplication app(argc, argv);
+            FrameRecorder recorder;
+            if (!recorder.parseArguments(app.arguments()))
+                return 1;
+            return recorder.run();
+        }
+        if (strcmp(argv[i], "--benchmark") == 0)
+        {
+            QApplication app(argc, argv);
+            ViewBenchmark benchmark;
+            if (!benchmark.parseArguments(app.arguments()))
+                return 1;
+            return benchmark.run();
+        }
+        if (strcmp(argv[i], "--replay") == 0)
+        {
+            QApplication app(argc, argv);
+            SessionReplay replay;
+            if (!replay.parseArguments(app.arguments()))
+                return 1;
+            return replay.run();
+        }
+    }
+
     QApplication::setDesktopSettingsAware(true);
 
     QApplication app(argc, argv);
+    TRACE_THREAD_NAME("GUI");
 
 	MainWindow* mw = new MainWindow();
     mw->show();
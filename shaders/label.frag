@@ -0,0 +1,20 @@
+#version 450 core
+in vec3 TexCoords;
+in vec3 LabelColor;
+out vec4 color;
+
+uniform sampler2DArray text;
+uniform bool b_sdf;
+
+void main()
+{
+    float coverage = texture(text, TexCoords).r;
+    if (b_sdf)
+    {
+        float width = fwidth(coverage);
+        coverage = smoothstep(0.5 - width, 0.5 + width, coverage);
+    }
+    if (coverage < 0.01)
+        discard;
+    color = vec4(LabelColor, coverage);
+}
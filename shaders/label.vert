@@ -0,0 +1,37 @@
+#version 450 core
+// One instance per glyph, expanded into a screen aligned quad
+layout (location = 0) in vec3 anchor;  // world space position of the label
+layout (location = 1) in vec2 offset;  // pixels from the anchor to the top left of the glyph
+layout (location = 2) in vec2 size;    // glyph size in pixels
+layout (location = 3) in vec4 uvRect;  // atlas rectangle, min.xy and max.xy
+layout (location = 4) in vec3 color;
+layout (location = 5) in float page;   // atlas page holding the glyph
+
+out vec3 TexCoords;
+out vec3 LabelColor;
+
+uniform mat4 viewProjection;
+uniform vec2 viewportSize;
+uniform float depthBias;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    TexCoords = vec3(mix(uvRect.xy, uvRect.zw, corner), page);
+    LabelColor = color;
+
+    vec4 clip = viewProjection * vec4(anchor, 1.0);
+    // Cull glyphs whose anchor is outside the view volume
+    if (clip.w <= 0.0 || any(greaterThan(abs(clip.xyz), vec3(clip.w))))
+    {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+
+    // Offset in pixels at the depth of the anchor, pulled slightly towards the eye
+    // so labels on the surface are not rejected by the depth test
+    vec2 pixel = offset + corner * size;
+    clip.xy += vec2(pixel.x, -pixel.y) * 2.0 / viewportSize * clip.w;
+    clip.z -= depthBias * clip.w;
+    gl_Position = clip;
+}
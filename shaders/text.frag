@@ -1,12 +1,20 @@
 #version 450 core
-in vec2 TexCoords;
+in vec3 TexCoords;
 out vec4 color;
 
-uniform sampler2D text;
+uniform sampler2DArray text;
 uniform vec3 textColor;
+uniform bool b_sdf;
 
 void main()
 {    
-    vec4 sampled = vec4(1.0, 1.0, 1.0, texture(text, TexCoords).r);
+    float coverage = texture(text, TexCoords).r;
+    if (b_sdf)
+    {
+        // Distance field, 0.5 is the outline, antialias over one screen pixel
+        float width = fwidth(coverage);
+        coverage = smoothstep(0.5 - width, 0.5 + width, coverage);
+    }
+    vec4 sampled = vec4(1.0, 1.0, 1.0, coverage);
     color = vec4(textColor, 1.0) * sampled;
-}  
+}
@@ -0,0 +1,46 @@
+#version 450
+// Writing gl_ViewportIndex from the vertex shader, GL_QUADS can not go through a geometry shader
+#extension GL_ARB_shader_viewport_layer_array : enable
+#extension GL_NV_viewport_array2 : enable
+#extension GL_AMD_vertex_shader_viewport_index : enable
+
+layout(location = 0) in vec3 vertexPosition;
+layout(location = 1) in vec3 vertexNormal;
+layout(location = 2) in vec2 texCoord2d;
+
+// One instance per view, drawn into the viewport of the same index
+struct View
+{
+    mat4 modelViewMatrix;
+    mat4 projectionMatrix;
+    mat4 normalMatrix;
+    vec4 clipPlaneX;
+    vec4 clipPlaneY;
+    vec4 clipPlaneZ;
+};
+
+layout(std140, binding = 0) uniform Views
+{
+    View views[4];
+};
+
+out vec3 v_normal;
+out vec3 v_position;
+out vec2 v_texCoord2d;
+
+void main()
+{
+    View view = views[gl_InstanceID];
+    vec4 eyePosition = view.modelViewMatrix * vec4(vertexPosition, 1);
+
+    v_normal     = normalize(mat3(view.normalMatrix) * vertexNormal);
+    v_position   = vec3(eyePosition);
+    v_texCoord2d = texCoord2d;
+
+    gl_Position = view.projectionMatrix * eyePosition;
+    gl_ViewportIndex = gl_InstanceID;
+
+    gl_ClipDistance[0] = dot(view.clipPlaneX, eyePosition);
+    gl_ClipDistance[1] = dot(view.clipPlaneY, eyePosition);
+    gl_ClipDistance[2] = dot(view.clipPlaneZ, eyePosition);
+}
@@ -0,0 +1,12 @@
+#version 400 core
+
+uniform sampler2D frame;
+uniform vec2 uv_scale; // Part of the frame texture holding the reduced resolution image
+in vec2 v_uv;
+
+out vec4 frag_color;
+void main()
+{
+    vec2 halfTexel = 0.5 / vec2(textureSize(frame, 0));
+    frag_color = vec4(texture(frame, min(v_uv * uv_scale, uv_scale - halfTexel)).rgb, 1.0);
+}